@@ -1,8 +1,5 @@
 #include "app.h"
 
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
-
 #include <algorithm>
 #include <array>
 #include <cmath>
@@ -24,8 +21,9 @@
 #include <slang-rhi/shader-cursor.h>
 
 #include <llc/buffer.h>
+#include <llc/bundle.h>
 #include <llc/image.h>
-#include <llc/math.h>
+#include <llc/image_async.h>
 
 namespace llc {
 
@@ -85,9 +83,9 @@ using Slang::ComPtr;
 constexpr char k_shader_module_name[] = "brdf_2d";
 constexpr u32 k_channel_count = 7;
 constexpr u32 k_render_channel_count = 3;
-constexpr u32 k_group_size_1d = 256;
-constexpr u32 k_group_size_2d = 16;
 constexpr App::InputParams k_eval_params{0.2f, -0.2f, 0.6f, 0.0f, 0.0f, 1.0f};
+// upper bound on replays per submission, so long runs still return to the host
+constexpr u32 k_max_replay_batch = 256;
 
 struct Dimensions final {
     u32 full_width = 0;
@@ -115,16 +113,6 @@ struct TrainingBuffers final {
     ComPtr<rhi::IBuffer> render_optimized;
 };
 
-struct LoadedRgbImage final {
-    i32 width = 0;
-    i32 height = 0;
-    std::vector<u8> pixels;
-
-    const u8 *pixel(i32 x, i32 y) const noexcept {
-        return pixels.data() + (static_cast<usize>(y) * width + x) * 3;
-    }
-};
-
 std::string read_text_file(const std::filesystem::path &path) {
     std::ifstream stream(path, std::ios::binary);
     if (!stream) {
@@ -178,55 +166,64 @@ std::filesystem::path example_root() {
     return std::filesystem::path("examples") / "brdf_2d_minimization";
 }
 
-LoadedRgbImage load_rgb_image(const std::filesystem::path &path) {
-    i32 width = 0;
-    i32 height = 0;
-    i32 channels = 0;
-    stbi_uc *data = stbi_load(path.string().c_str(), &width, &height, &channels, 3);
-    if (!data) {
-        throw std::runtime_error(fmt::format("Failed to load image: {}", path.string()));
+/// Loads the images at `paths` as RGBA8Unorm at once, each read and decoded concurrently.
+std::vector<Image> load_rgba_images(std::span<const std::filesystem::path> paths) {
+    EventLoop loop;
+    std::vector<Task<Image, Error>> tasks;
+    tasks.reserve(paths.size());
+    for (const auto &path : paths) {
+        tasks.push_back(load_image_async(path, rhi::Format::RGBA8Unorm, loop));
+        loop.schedule(tasks.back());
+    }
+    loop.run();
+
+    std::vector<Image> images;
+    images.reserve(paths.size());
+    for (usize i = 0; i < paths.size(); ++i) {
+        auto result = tasks[i].result();
+        if (!result.has_value()) {
+            throw std::runtime_error(
+                fmt::format("Failed to load image: {} ({})", paths[i].string(), result.error().message()));
+        }
+        images.push_back(std::move(*result));
     }
-
-    LoadedRgbImage image;
-    image.width = width;
-    image.height = height;
-    image.pixels.assign(data, data + static_cast<usize>(width) * height * 3);
-    stbi_image_free(data);
-    return image;
+    return images;
 }
 
-f32 image_channel_bgr_to_rgb(const LoadedRgbImage &image, i32 x, i32 y, u32 rgb_channel) {
-    const u8 *pixel = image.pixel(x, y);
-    return static_cast<f32>(pixel[rgb_channel]) / 255.0f;
+f32 image_channel_bgr_to_rgb(const Image &image, u32 x, u32 y, u32 rgb_channel) {
+    return static_cast<f32>(std::to_integer<u8>(image.row_data(y)[x * 4 + rgb_channel])) / 255.0f;
 }
 
 std::vector<f32> make_full_brdf(const std::filesystem::path &root, const App::Config &config, const Dimensions &dims) {
     const auto resource_dir = root / "resources";
-    auto diffuse = load_rgb_image(resource_dir / "diffuse.jpg");
-    auto normal = load_rgb_image(resource_dir / "normal.jpg");
-    auto roughness = load_rgb_image(resource_dir / "roughness.jpg");
-
-    const i32 crop_x = static_cast<i32>(config.crop_x);
-    const i32 crop_y = static_cast<i32>(config.crop_y);
-    if (diffuse.width < crop_x + static_cast<i32>(dims.full_width) ||
-        diffuse.height < crop_y + static_cast<i32>(dims.full_height) ||
-        normal.width < crop_x + static_cast<i32>(dims.full_width) ||
-        normal.height < crop_y + static_cast<i32>(dims.full_height) ||
-        roughness.width < crop_x + static_cast<i32>(dims.full_width) ||
-        roughness.height < crop_y + static_cast<i32>(dims.full_height)) {
-        throw std::runtime_error(fmt::format(
-            "Input resources are smaller than the expected {}x{} crop at ({}, {}).",
-            dims.full_width,
-            dims.full_height,
-            config.crop_x,
-            config.crop_y));
+    const std::array paths{
+        resource_dir / "diffuse.jpg",
+        resource_dir / "normal.jpg",
+        resource_dir / "roughness.jpg",
+    };
+    const auto images = load_rgba_images(paths);
+    const auto &diffuse = images[0];
+    const auto &normal = images[1];
+    const auto &roughness = images[2];
+
+    const u32 crop_right = config.crop_x + dims.full_width;
+    const u32 crop_bottom = config.crop_y + dims.full_height;
+    for (const auto &image : images) {
+        if (image.width < crop_right || image.height < crop_bottom) {
+            throw std::runtime_error(fmt::format(
+                "Input resources are smaller than the expected {}x{} crop at ({}, {}).",
+                dims.full_width,
+                dims.full_height,
+                config.crop_x,
+                config.crop_y));
+        }
     }
 
     std::vector<f32> brdf(static_cast<usize>(dims.full_width) * dims.full_height * k_channel_count);
     for (u32 y = 0; y < dims.full_height; ++y) {
         for (u32 x = 0; x < dims.full_width; ++x) {
-            const i32 sx = crop_x + static_cast<i32>(x);
-            const i32 sy = crop_y + static_cast<i32>(y);
+            const u32 sx = config.crop_x + x;
+            const u32 sy = config.crop_y + y;
             const usize offset = (static_cast<usize>(y) * dims.full_width + x) * k_channel_count;
             brdf[offset + 0] = image_channel_bgr_to_rgb(diffuse, sx, sy, 0);
             brdf[offset + 1] = image_channel_bgr_to_rgb(diffuse, sx, sy, 1);
@@ -325,60 +322,43 @@ SlangResult bind_u32_uniform(rhi::ShaderCursor cursor, const char *name, u32 val
     return cursor[name].setData(value);
 }
 
-SlangResult bind_f32_uniform(rhi::ShaderCursor cursor, const char *name, f32 value) {
-    return cursor[name].setData(value);
-}
-
 SlangResult bind_input_params(rhi::ShaderCursor cursor, const App::InputParams &value) {
     return cursor["inputParams"].setData(value);
 }
 
-SlangResult dispatch_gradient(App &app, TrainingBuffers &buffers, const Dimensions &dims, const App::InputParams &params) {
-    auto queue = app.context_.queue();
-    auto encoder = queue->createCommandEncoder();
-    auto *pass = encoder->beginComputePass();
-    {
-        auto root_object = pass->bindPipeline(app.gradient_kernel_.pipeline_.get());
-        rhi::ShaderCursor entry_cursor(root_object->getEntryPoint(0));
-        SLANG_RETURN_ON_FAIL(bind_pointer_uniform(entry_cursor, "fullBrdf", buffers.full_brdf->getDeviceAddress()));
-        SLANG_RETURN_ON_FAIL(bind_pointer_uniform(entry_cursor, "halfBrdf", buffers.half_brdf->getDeviceAddress()));
-        SLANG_RETURN_ON_FAIL(bind_pointer_uniform(entry_cursor, "gradients", buffers.gradients->getDeviceAddress()));
-        SLANG_RETURN_ON_FAIL(bind_u32_uniform(entry_cursor, "parameterCount", dims.parameter_count));
-        SLANG_RETURN_ON_FAIL(bind_u32_uniform(entry_cursor, "fullWidth", dims.full_width));
-        SLANG_RETURN_ON_FAIL(bind_u32_uniform(entry_cursor, "fullHeight", dims.full_height));
-        SLANG_RETURN_ON_FAIL(bind_u32_uniform(entry_cursor, "halfWidth", dims.half_width));
-        SLANG_RETURN_ON_FAIL(bind_u32_uniform(entry_cursor, "halfHeight", dims.half_height));
-        SLANG_RETURN_ON_FAIL(bind_input_params(entry_cursor, params));
-        pass->dispatchCompute(dims.parameter_count, 1, 1);
-    }
-    pass->end();
-
-    ComPtr<rhi::ICommandBuffer> command_buffer;
-    SLANG_RETURN_ON_FAIL(encoder->finish(command_buffer.writeRef()));
-    queue->submit(command_buffer.get());
-    return SLANG_OK;
-}
-
-SlangResult dispatch_adam(App &app, TrainingBuffers &buffers, const Dimensions &dims) {
-    auto queue = app.context_.queue();
-    auto encoder = queue->createCommandEncoder();
-    auto *pass = encoder->beginComputePass();
-    {
-        auto root_object = pass->bindPipeline(app.adam_kernel_.pipeline_.get());
-        rhi::ShaderCursor entry_cursor(root_object->getEntryPoint(0));
-        SLANG_RETURN_ON_FAIL(bind_pointer_uniform(entry_cursor, "states", buffers.adam_state->getDeviceAddress()));
-        SLANG_RETURN_ON_FAIL(bind_pointer_uniform(entry_cursor, "params", buffers.half_brdf->getDeviceAddress()));
-        SLANG_RETURN_ON_FAIL(bind_pointer_uniform(entry_cursor, "gradients", buffers.gradients->getDeviceAddress()));
-        SLANG_RETURN_ON_FAIL(bind_u32_uniform(entry_cursor, "parameterCount", dims.parameter_count));
-        SLANG_RETURN_ON_FAIL(bind_f32_uniform(entry_cursor, "learningRate", app.config_.learning_rate));
-        pass->dispatchCompute(divide_and_round_up(dims.parameter_count, k_group_size_1d), 1, 1);
-    }
-    pass->end();
-
-    ComPtr<rhi::ICommandBuffer> command_buffer;
-    SLANG_RETURN_ON_FAIL(encoder->finish(command_buffer.writeRef()));
-    queue->submit(command_buffer.get());
-    return SLANG_OK;
+/// Records one training iteration; returns the slot of the per-iteration light/view parameters.
+std::optional<BundleSlot<App::InputParams>>
+record_training_step(App &app, CommandBundle &bundle, TrainingBuffers &buffers, const Dimensions &dims) {
+    bundle.clear_buffer(buffers.gradients.get());
+
+    // computeGradient runs one group per parameter
+    auto gradient = bundle.dispatch(
+        app.gradient_kernel_,
+        {dims.parameter_count * app.gradient_kernel_.thread_group_size_.x, 1, 1});
+    if (!gradient) return std::nullopt;
+    if (SLANG_FAILED(gradient.set("fullBrdf", buffers.full_brdf->getDeviceAddress())) ||
+        SLANG_FAILED(gradient.set("halfBrdf", buffers.half_brdf->getDeviceAddress())) ||
+        SLANG_FAILED(gradient.set("gradients", buffers.gradients->getDeviceAddress())) ||
+        SLANG_FAILED(gradient.set("parameterCount", dims.parameter_count)) ||
+        SLANG_FAILED(gradient.set("fullWidth", dims.full_width)) ||
+        SLANG_FAILED(gradient.set("fullHeight", dims.full_height)) ||
+        SLANG_FAILED(gradient.set("halfWidth", dims.half_width)) ||
+        SLANG_FAILED(gradient.set("halfHeight", dims.half_height))) {
+        return std::nullopt;
+    }
+    auto params_slot = gradient.slot("inputParams", App::InputParams{});
+    if (!params_slot) return std::nullopt;
+
+    auto adam = bundle.dispatch(app.adam_kernel_, {dims.parameter_count, 1, 1});
+    if (!adam) return std::nullopt;
+    if (SLANG_FAILED(adam.set("states", buffers.adam_state->getDeviceAddress())) ||
+        SLANG_FAILED(adam.set("params", buffers.half_brdf->getDeviceAddress())) ||
+        SLANG_FAILED(adam.set("gradients", buffers.gradients->getDeviceAddress())) ||
+        SLANG_FAILED(adam.set("parameterCount", dims.parameter_count)) ||
+        SLANG_FAILED(adam.set("learningRate", app.config_.learning_rate))) {
+        return std::nullopt;
+    }
+    return params_slot;
 }
 
 SlangResult dispatch_render(
@@ -391,23 +371,19 @@ SlangResult dispatch_render(
     const App::InputParams &params) {
     auto queue = app.context_.queue();
     auto encoder = queue->createCommandEncoder();
-    auto *pass = encoder->beginComputePass();
-    {
-        auto root_object = pass->bindPipeline(app.render_kernel_.pipeline_.get());
-        rhi::ShaderCursor entry_cursor(root_object->getEntryPoint(0));
-        SLANG_RETURN_ON_FAIL(bind_pointer_uniform(entry_cursor, "brdf", brdf->getDeviceAddress()));
-        SLANG_RETURN_ON_FAIL(bind_pointer_uniform(entry_cursor, "output", output->getDeviceAddress()));
-        SLANG_RETURN_ON_FAIL(bind_u32_uniform(entry_cursor, "outputWidth", dims.full_width));
-        SLANG_RETURN_ON_FAIL(bind_u32_uniform(entry_cursor, "outputHeight", dims.full_height));
-        SLANG_RETURN_ON_FAIL(bind_u32_uniform(entry_cursor, "brdfWidth", brdf_width));
-        SLANG_RETURN_ON_FAIL(bind_u32_uniform(entry_cursor, "brdfHeight", brdf_height));
-        SLANG_RETURN_ON_FAIL(bind_input_params(entry_cursor, params));
-        pass->dispatchCompute(
-            divide_and_round_up(dims.full_width, k_group_size_2d),
-            divide_and_round_up(dims.full_height, k_group_size_2d),
-            1);
-    }
-    pass->end();
+    SLANG_RETURN_ON_FAIL(app.render_kernel_.dispatch(
+        encoder.get(),
+        {dims.full_width, dims.full_height, 1},
+        [&](rhi::IShaderObject *root_object) {
+            rhi::ShaderCursor entry_cursor(root_object->getEntryPoint(0));
+            SLANG_RETURN_ON_FAIL(bind_pointer_uniform(entry_cursor, "brdf", brdf->getDeviceAddress()));
+            SLANG_RETURN_ON_FAIL(bind_pointer_uniform(entry_cursor, "output", output->getDeviceAddress()));
+            SLANG_RETURN_ON_FAIL(bind_u32_uniform(entry_cursor, "outputWidth", dims.full_width));
+            SLANG_RETURN_ON_FAIL(bind_u32_uniform(entry_cursor, "outputHeight", dims.full_height));
+            SLANG_RETURN_ON_FAIL(bind_u32_uniform(entry_cursor, "brdfWidth", brdf_width));
+            SLANG_RETURN_ON_FAIL(bind_u32_uniform(entry_cursor, "brdfHeight", brdf_height));
+            return bind_input_params(entry_cursor, params);
+        }));
 
     ComPtr<rhi::ICommandBuffer> command_buffer;
     SLANG_RETURN_ON_FAIL(encoder->finish(command_buffer.writeRef()));
@@ -613,23 +589,34 @@ i32 App::run(i32 argc, const char *argv[]) {
         return -1;
     }
 
+    CommandBundle training_step(context_);
+    const auto params_slot = record_training_step(*this, training_step, buffers, dims);
+    if (!params_slot) {
+        fmt::println("Failed to record the training step.");
+        return -1;
+    }
+
     std::mt19937 rng(config_.random_seed);
     auto queue = context_.queue();
-    for (u32 iteration = 0; iteration < config_.iteration_count; ++iteration) {
-        clear_buffer(context_, buffers.gradients.get());
-        const auto params = random_training_params(rng);
-        if (SLANG_FAILED(dispatch_gradient(*this, buffers, dims, params))) {
-            fmt::println("Failed to dispatch computeGradient.");
-            return -1;
-        }
-        if (SLANG_FAILED(dispatch_adam(*this, buffers, dims))) {
-            fmt::println("Failed to dispatch adamStep.");
+    for (u32 iteration = 0; iteration < config_.iteration_count;) {
+        // replay up to the next report, or a bounded batch, in a single submission
+        const u32 remaining = config_.iteration_count - iteration;
+        const u32 until_report = config_.report_interval != 0
+                                     ? config_.report_interval - iteration % config_.report_interval
+                                     : remaining;
+        const u32 batch_count = std::min({until_report, remaining, k_max_replay_batch});
+        const auto result = training_step.replay(batch_count, [&](u32) {
+            training_step.set(*params_slot, random_training_params(rng));
+        });
+        if (SLANG_FAILED(result)) {
+            fmt::println("Failed to submit the training step.");
             return -1;
         }
+        iteration += batch_count;
 
-        if (config_.report_interval != 0 && ((iteration + 1) % config_.report_interval == 0)) {
+        if (config_.report_interval != 0 && iteration % config_.report_interval == 0) {
             queue->waitOnHost();
-            fmt::println("Iteration {}", iteration + 1);
+            fmt::println("Iteration {}", iteration);
         }
     }
 
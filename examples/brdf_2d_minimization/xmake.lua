@@ -1,9 +1,8 @@
 add_requires("daw_json_link")
-add_requires("stb")
 
 target("brdf_2d_minimization")
     set_kind("binary")
     add_files("*.cpp")
     add_files("shaders/**.slang")
-    add_packages("fmt", "slang-rhi", "daw_json_link", "stb")
+    add_packages("fmt", "slang-rhi", "daw_json_link")
     add_deps("llc")
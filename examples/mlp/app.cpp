@@ -1,5 +1,6 @@
 #include "app.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cstring>
@@ -14,11 +15,11 @@
 
 #include <fmt/core.h>
 #include <fmt/format.h>
-#include <slang-rhi/shader-cursor.h>
 
 #include <daw/json/daw_json_link.h>
 
 #include <llc/buffer.h>
+#include <llc/bundle.h>
 #include <llc/math.h>
 
 namespace llc {
@@ -61,6 +62,8 @@ using Slang::ComPtr;
 constexpr std::array<u32, 3> k_layer_sizes = {4, 16, 4};
 constexpr u32 k_layer_count = static_cast<u32>(k_layer_sizes.size() - 1);
 constexpr char k_kernel_module_name[] = "kernels";
+// upper bound on replays per submission, so long runs still return to the host
+constexpr u32 k_max_replay_batch = 256;
 
 struct InputSample final {
     f32 x;
@@ -324,52 +327,30 @@ TrainingBuffers create_training_buffers(
     return buffers;
 }
 
-SlangResult bind_pointer_uniform(
-    rhi::ShaderCursor cursor,
-    const char *name,
-    u64 device_address) {
-    return cursor[name].setData(device_address);
-}
-
-SlangResult bind_scalar_uniform(
-    rhi::ShaderCursor cursor,
-    const char *name,
-    u32 value) {
-    return cursor[name].setData(value);
-}
-
-SlangResult dispatch_learn_gradient(
+/// Records one training iteration: clear the loss and training gradients, back-propagate,
+/// convert the gradients to row-major and take an Adam step.
+SlangResult record_training_step(
     App &app,
-    rhi::IBuffer *network_constants,
-    rhi::IBuffer *loss_buffer,
-    rhi::IBuffer *input_buffer,
-    u32 sample_count) {
-
-    auto queue = app.context_.queue();
-    auto encoder = queue->createCommandEncoder();
-    auto pass = encoder->beginComputePass();
-    {
-        auto root_object = pass->bindPipeline(app.learn_grad_kernel_.pipeline_.get());
-        rhi::ShaderCursor entry_cursor(root_object->getEntryPoint(0));
-
-        SLANG_RETURN_ON_FAIL(bind_pointer_uniform(entry_cursor, "network", network_constants->getDeviceAddress()));
-        SLANG_RETURN_ON_FAIL(bind_pointer_uniform(entry_cursor, "lossBuffer", loss_buffer->getDeviceAddress()));
-        SLANG_RETURN_ON_FAIL(bind_pointer_uniform(entry_cursor, "inputs", input_buffer->getDeviceAddress()));
-        SLANG_RETURN_ON_FAIL(bind_scalar_uniform(entry_cursor, "count", sample_count));
-
-        pass->dispatchCompute(divide_and_round_up(sample_count, 256u), 1, 1);
-    }
-    pass->end();
+    CommandBundle &bundle,
+    const TrainingBuffers &buffers,
+    u32 sample_count,
+    u32 gradient_count) {
 
-    ComPtr<rhi::ICommandBuffer> command_buffer;
-    SLANG_RETURN_ON_FAIL(encoder->finish(command_buffer.writeRef()));
-    queue->submit(command_buffer.get());
-    return SLANG_OK;
-}
+    auto *network_params_buffer = buffers.network_params.get();
+    bundle.clear_buffer(buffers.loss.get());
+    bundle.clear_buffer(
+        network_params_buffer,
+        rhi::BufferRange{
+            app.network_gradient_training_offset_,
+            app.network_params_buffer_size_ - app.network_gradient_training_offset_,
+        });
 
-SlangResult convert_weight_gradients(
-    App &app,
-    rhi::IBuffer *network_params_buffer) {
+    auto learn_gradient = bundle.dispatch(app.learn_grad_kernel_, {sample_count, 1, 1});
+    if (!learn_gradient) return SLANG_FAIL;
+    SLANG_RETURN_ON_FAIL(learn_gradient.set("network", buffers.network_constants->getDeviceAddress()));
+    SLANG_RETURN_ON_FAIL(learn_gradient.set("lossBuffer", buffers.loss->getDeviceAddress()));
+    SLANG_RETURN_ON_FAIL(learn_gradient.set("inputs", buffers.input_samples->getDeviceAddress()));
+    SLANG_RETURN_ON_FAIL(learn_gradient.set("count", sample_count));
 
     std::vector<rhi::CooperativeVectorMatrixDesc> src_descs;
     std::vector<rhi::CooperativeVectorMatrixDesc> dst_descs;
@@ -400,50 +381,24 @@ SlangResult convert_weight_gradients(
         });
     }
 
-    auto queue = app.context_.queue();
-    auto encoder = queue->createCommandEncoder();
-    encoder->convertCooperativeVectorMatrix(
-        network_params_buffer,
-        dst_descs.data(),
-        network_params_buffer,
-        src_descs.data(),
-        static_cast<u32>(src_descs.size()));
-
-    ComPtr<rhi::ICommandBuffer> command_buffer;
-    SLANG_RETURN_ON_FAIL(encoder->finish(command_buffer.writeRef()));
-    queue->submit(command_buffer.get());
-    return SLANG_OK;
-}
-
-SlangResult dispatch_adjust_parameters(
-    App &app,
-    rhi::IBuffer *adam_state,
-    rhi::IBuffer *network_params,
-    u32 gradient_count) {
-
-    auto queue = app.context_.queue();
-    auto encoder = queue->createCommandEncoder();
-    auto pass = encoder->beginComputePass();
-    {
-        auto root_object = pass->bindPipeline(app.adjust_parameters_kernel_.pipeline_.get());
-        rhi::ShaderCursor entry_cursor(root_object->getEntryPoint(0));
-
-        SLANG_RETURN_ON_FAIL(bind_pointer_uniform(entry_cursor, "states", adam_state->getDeviceAddress()));
-        SLANG_RETURN_ON_FAIL(bind_pointer_uniform(entry_cursor, "params", network_params->getDeviceAddress()));
-        SLANG_RETURN_ON_FAIL(bind_pointer_uniform(
-            entry_cursor,
-            "gradients",
-            network_params->getDeviceAddress() + app.network_gradient_offset_));
-        SLANG_RETURN_ON_FAIL(bind_scalar_uniform(entry_cursor, "count", gradient_count));
-
-        pass->dispatchCompute(divide_and_round_up(gradient_count, 256u), 1, 1);
-    }
-    pass->end();
-
-    ComPtr<rhi::ICommandBuffer> command_buffer;
-    SLANG_RETURN_ON_FAIL(encoder->finish(command_buffer.writeRef()));
-    queue->submit(command_buffer.get());
-    return SLANG_OK;
+    bundle.encode_with([network_params_buffer, src_descs = std::move(src_descs), dst_descs = std::move(dst_descs)](
+                           rhi::ICommandEncoder *encoder) {
+        encoder->convertCooperativeVectorMatrix(
+            network_params_buffer,
+            dst_descs.data(),
+            network_params_buffer,
+            src_descs.data(),
+            static_cast<u32>(src_descs.size()));
+    });
+
+    auto adjust_parameters = bundle.dispatch(app.adjust_parameters_kernel_, {gradient_count, 1, 1});
+    if (!adjust_parameters) return SLANG_FAIL;
+    SLANG_RETURN_ON_FAIL(adjust_parameters.set("states", buffers.adam_state->getDeviceAddress()));
+    SLANG_RETURN_ON_FAIL(adjust_parameters.set("params", network_params_buffer->getDeviceAddress()));
+    SLANG_RETURN_ON_FAIL(adjust_parameters.set(
+        "gradients",
+        network_params_buffer->getDeviceAddress() + app.network_gradient_offset_));
+    return adjust_parameters.set("count", gradient_count);
 }
 
 std::optional<f32> read_loss_value(Context &context, rhi::IBuffer *loss_buffer) {
@@ -538,49 +493,39 @@ i32 App::run(i32 argc, const char *argv[]) {
     const u32 gradient_count =
         static_cast<u32>((network_gradient_training_offset_ - network_gradient_offset_) / sizeof(f16));
 
-    auto queue = context_.queue();
-    for (u32 iteration = 0; iteration < config_.iteration_count; ++iteration) {
-        llc::clear_buffer(context_, buffers.loss.get());
-        llc::clear_buffer(
-            context_,
-            buffers.network_params.get(),
-            rhi::BufferRange{
-                network_gradient_training_offset_,
-                network_params_buffer_size_ - network_gradient_training_offset_,
-            });
-
-        if (SLANG_FAILED(dispatch_learn_gradient(
-                *this,
-                buffers.network_constants.get(),
-                buffers.loss.get(),
-                buffers.input_samples.get(),
-                static_cast<u32>(input_samples.size())))) {
-            fmt::println("Failed to dispatch `learnGradient`.");
-            return -1;
-        }
-
-        if (SLANG_FAILED(convert_weight_gradients(*this, buffers.network_params.get()))) {
-            fmt::println("Failed to convert cooperative vector gradients.");
-            return -1;
-        }
+    CommandBundle training_step(context_);
+    if (SLANG_FAILED(record_training_step(
+            *this,
+            training_step,
+            buffers,
+            static_cast<u32>(input_samples.size()),
+            gradient_count))) {
+        fmt::println("Failed to record the training step.");
+        return -1;
+    }
 
-        if (SLANG_FAILED(dispatch_adjust_parameters(
-                *this,
-                buffers.adam_state.get(),
-                buffers.network_params.get(),
-                gradient_count))) {
-            fmt::println("Failed to dispatch `adjustParameters`.");
+    auto queue = context_.queue();
+    for (u32 iteration = 0; iteration < config_.iteration_count;) {
+        // replay up to the next report, or a bounded batch, in a single submission
+        const u32 remaining = config_.iteration_count - iteration;
+        const u32 until_report = config_.report_interval != 0
+                                     ? config_.report_interval - iteration % config_.report_interval
+                                     : remaining;
+        const u32 batch_count = std::min({until_report, remaining, k_max_replay_batch});
+        if (SLANG_FAILED(training_step.replay(batch_count))) {
+            fmt::println("Failed to submit the training step.");
             return -1;
         }
+        iteration += batch_count;
 
-        if (config_.report_interval != 0 && ((iteration + 1) % config_.report_interval == 0)) {
+        if (config_.report_interval != 0 && iteration % config_.report_interval == 0) {
             queue->waitOnHost();
             const auto loss = read_loss_value(context_, buffers.loss.get());
             if (!loss) {
                 fmt::println("Failed to read back loss buffer.");
                 return -1;
             }
-            fmt::println("Loss after {} iterations: {}", iteration + 1, *loss);
+            fmt::println("Loss after {} iterations: {}", iteration, *loss);
         }
     }
 
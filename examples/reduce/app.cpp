@@ -1,6 +1,9 @@
 #include "app.h"
 
+#include <chrono>
 #include <iterator>
+#include <span>
+#include <utility>
 #include <vector>
 
 #include <fmt/core.h>
@@ -8,10 +11,12 @@
 #include <slang-rhi/shader-cursor.h>
 #include <cxxopts.hpp>
 
+#include <llc/context_group.h>
 #include <llc/kernel.h>
 #include <llc/buffer.h>
 #include <llc/math.h>
 #include <llc/pp/reduce.h>
+#include <llc/pp/reduce_group.h>
 #include <llc/timer.h>
 
 namespace llc {
@@ -30,7 +35,8 @@ constexpr u32 calc_reduce_times(u32 length, u32 group_size) noexcept {
 i32 App::run(i32 argc, const char *argv[]) {
     cxxopts::Options options("reduce", "Reduce an array of floats using GPU compute shader");
     options.add_options()                                                                                     //
-        ("backend", "RHI backend to use [dx|vk|auto]", cxxopts::value<std::string>()->default_value("auto")); //
+        ("backend", "RHI backend to use [dx|vk|cpu|auto]", cxxopts::value<std::string>()->default_value("auto")) //
+        ("devices", "Also reduce on a group of this many devices", cxxopts::value<u32>()->default_value("0"));    //
 
     options.parse_positional({"backend"});
     auto result = options.parse(argc, argv);
@@ -46,6 +52,8 @@ i32 App::run(i32 argc, const char *argv[]) {
     } else if (backend_name == "dx") {
         device_desc.slang.targetProfile = "sm_6_6";
         device_desc.deviceType = rhi::DeviceType::D3D12;
+    } else if (backend_name == "cpu") {
+        device_desc.deviceType = rhi::DeviceType::CPU;
     } else {
         fmt::println("Unsupported backend: {}", backend_name);
         return -1;
@@ -86,7 +94,9 @@ i32 App::run(i32 argc, const char *argv[]) {
             return -1;
         }
 
-        const u32 thread_group_size = strcmp(module_name, "naive") == 0 ? 256 : 512;
+        // wave threads add two elements each before reducing across the group
+        const u32 items_per_thread = strcmp(module_name, "naive") == 0 ? 1 : 2;
+        const u32 elements_per_group = kernel.thread_group_size_.x * items_per_thread;
         const usize buffer_byte_size = sizeof(f32) * element_count;
 
         auto device_buffer = create_structured_buffer<f32>(
@@ -107,7 +117,7 @@ i32 App::run(i32 argc, const char *argv[]) {
             return -1;
         }
 
-        const auto reduce_times = calc_reduce_times(element_count, thread_group_size);
+        const auto reduce_times = calc_reduce_times(element_count, elements_per_group);
         auto gpu_timer = GpuTimer::create(context_, reduce_times);
 
         if (!gpu_timer) {
@@ -119,24 +129,20 @@ i32 App::run(i32 argc, const char *argv[]) {
                                          gpu_timer->scope(encoder.get(), fmt::format("reduce pass {:02}", i)) :
                                          GpuTimer::Scope{};
 
-            auto *pass = encoder->beginComputePass();
-            {
-                auto root_shader = pass->bindPipeline(kernel.pipeline_.get());
-                auto root_cursor = rhi::ShaderCursor(root_shader);
+            const u32 group_count = divide_and_round_up(l, elements_per_group);
+            const u32 input_byte_size = sizeof(f32) * l;
+            const u32 output_byte_size = sizeof(f32) * group_count;
+            const u32 thread_count = divide_and_round_up(l, items_per_thread);
+            l = group_count;
 
+            SLANG_RETURN_ON_FAIL(kernel.dispatch(encoder.get(), {thread_count, 1, 1}, [&](rhi::IShaderObject *root) {
+                auto root_cursor = rhi::ShaderCursor(root);
                 const auto bind_buffer = [&](const char *name, rhi::BufferRange range) {
                     return root_cursor[name].setBinding(rhi::Binding(device_buffer.get(), range));
                 };
-                const u32 group_count = divide_and_round_up(l, thread_group_size);
-                const u32 input_byte_size = sizeof(f32) * l;
-                const u32 output_byte_size = sizeof(f32) * group_count;
-                l = group_count;
-
                 SLANG_RETURN_ON_FAIL(bind_buffer("source", {0, input_byte_size}));
-                SLANG_RETURN_ON_FAIL(bind_buffer("result", {0, output_byte_size}));
-                pass->dispatchCompute(group_count, 1, 1);
-            }
-            pass->end();
+                return bind_buffer("result", {0, output_byte_size});
+            }));
         }
 
         ComPtr<rhi::ICommandBuffer> command_buffer;
@@ -184,7 +190,8 @@ i32 App::run(i32 argc, const char *argv[]) {
             return -1;
         }
 
-        constexpr u32 thread_group_size = 512;
+        constexpr u32 items_per_thread = 2;
+        const u32 elements_per_group = kernel.thread_group_size_.x * items_per_thread;
 
         auto buffer_a = create_structured_buffer<f32>(
             context_,
@@ -210,29 +217,24 @@ i32 App::run(i32 argc, const char *argv[]) {
             return -1;
         }
 
-        const auto reduce_times = calc_reduce_times(element_count, thread_group_size);
+        const auto reduce_times = calc_reduce_times(element_count, elements_per_group);
 
         rhi::IBuffer *src_buf = buffer_a.get();
         rhi::IBuffer *dst_buf = buffer_b.get();
 
         for (u32 i = 0, l = element_count; i < reduce_times; i++) {
-            auto *pass = encoder->beginComputePass();
-            {
-                auto root_shader = pass->bindPipeline(kernel.pipeline_.get());
-                auto root_cursor = rhi::ShaderCursor(root_shader);
-
-                const u32 group_count = divide_and_round_up(l, thread_group_size);
-                const u32 input_byte_size = sizeof(f32) * l;
-                const u32 output_byte_size = sizeof(f32) * group_count;
-                l = group_count;
-
+            const u32 group_count = divide_and_round_up(l, elements_per_group);
+            const u32 input_byte_size = sizeof(f32) * l;
+            const u32 output_byte_size = sizeof(f32) * group_count;
+            const u32 thread_count = divide_and_round_up(l, items_per_thread);
+            l = group_count;
+
+            SLANG_RETURN_ON_FAIL(kernel.dispatch(encoder.get(), {thread_count, 1, 1}, [&](rhi::IShaderObject *root) {
+                auto root_cursor = rhi::ShaderCursor(root);
                 SLANG_RETURN_ON_FAIL(
                     root_cursor["source"].setBinding(rhi::Binding(src_buf, rhi::BufferRange{0, input_byte_size})));
-                SLANG_RETURN_ON_FAIL(
-                    root_cursor["result"].setBinding(rhi::Binding(dst_buf, rhi::BufferRange{0, output_byte_size})));
-                pass->dispatchCompute(group_count, 1, 1);
-            }
-            pass->end();
+                return root_cursor["result"].setBinding(rhi::Binding(dst_buf, rhi::BufferRange{0, output_byte_size}));
+            }));
 
             std::swap(src_buf, dst_buf);
         }
@@ -300,6 +302,46 @@ i32 App::run(i32 argc, const char *argv[]) {
         fmt::println("llc::pp abs error: {}", std::abs(static_cast<f64>(llc_reduce_result) - cpu_result));
     }
 
+    const u32 device_count = result["devices"].as<u32>();
+    if (device_count > 0) {
+        fmt::println("===============================");
+        auto group = ContextGroup::create(ContextDesc{.device = device_desc}, device_count);
+        if (!group) {
+            fmt::println("Failed to create {} devices.", device_count);
+            return -1;
+        }
+
+        // upload every part, so the devices and not the host threads do the work
+        constexpr pp::ReduceDispatch k_on_device{.device_min_count_host_resident = 0};
+        constexpr u32 k_repeat_count = 5;
+        const std::span<const f32> source(init_data);
+        const auto time_reduce = [&](auto &&reduce_fn) {
+            (void) reduce_fn(); // compiles the pipelines, and seeds the group's throughput estimates
+            const auto start = std::chrono::steady_clock::now();
+            f32 sum = 0.0f;
+            for (u32 i = 0; i < k_repeat_count; ++i) sum = reduce_fn();
+            const std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+            return std::pair{sum, elapsed.count() / k_repeat_count};
+        };
+
+        const auto [single_sum, single_seconds] =
+            time_reduce([&]() { return pp::reduce_sum<f32>((*group)[0], source, k_on_device); });
+        const auto [group_sum, group_seconds] =
+            time_reduce([&]() { return pp::reduce_sum<f32>(*group, source, k_on_device); });
+
+        fmt::println("1 device: {:.3f} ms, result {}", single_seconds * 1e3, single_sum);
+        fmt::println(
+            "{} devices: {:.3f} ms, result {}, speedup {:.2f}x, {} shared shaders",
+            device_count,
+            group_seconds * 1e3,
+            group_sum,
+            single_seconds / group_seconds,
+            group->shared_shader_count());
+        for (usize i = 0; i < group->size(); ++i) {
+            fmt::println("    device {}: {:.2f} GB/s", i, group->bytes_per_second(i) * 1e-9);
+        }
+    }
+
     return 0;
 }
 
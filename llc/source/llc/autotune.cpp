@@ -0,0 +1,88 @@
+#include "autotune.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace llc {
+
+namespace {
+
+constexpr std::string_view k_profile_header = "# llc tuning profile v1";
+
+} // namespace
+
+std::optional<LaunchConfig> TuningProfile::find(std::string_view key) {
+    std::scoped_lock lock(mutex);
+    for (const auto &entry : entries) {
+        if (entry.key == key) return entry.config;
+    }
+    return std::nullopt;
+}
+
+void TuningProfile::set(std::string_view key, const LaunchConfig &config) {
+    std::scoped_lock lock(mutex);
+    for (auto &entry : entries) {
+        if (entry.key == key) {
+            entry.config = config;
+            return;
+        }
+    }
+    entries.push_back({std::string(key), config});
+}
+
+bool TuningProfile::load(const std::filesystem::path &path) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    // one entry per line: "<group_size_x> <group_size_y> <items_per_thread> <key>",
+    // the key goes last since adapter names may contain spaces
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line.front() == '#') continue;
+
+        std::istringstream stream(line);
+        LaunchConfig config{};
+        if (!(stream >> config.group_size_x >> config.group_size_y >> config.items_per_thread)) continue;
+
+        std::string key;
+        std::getline(stream >> std::ws, key);
+        if (key.empty() || config.thread_count() == 0 || config.items_per_thread == 0) continue;
+        set(key, config);
+    }
+    return true;
+}
+
+bool TuningProfile::save(const std::filesystem::path &path) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) return false;
+
+    std::scoped_lock lock(mutex);
+    file << k_profile_header << '\n';
+    for (const auto &entry : entries) {
+        file << entry.config.group_size_x << ' ' << entry.config.group_size_y << ' '
+             << entry.config.items_per_thread << ' ' << entry.key << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+std::string tuning_key(const Context &context, std::string_view kernel, std::string_view type) {
+    const auto &info = context.device()->getInfo();
+    std::string key;
+    key.append(kernel).append("/").append(type);
+    key.append("/").append(info.apiName ? info.apiName : "unknown");
+    key.append("/").append(info.adapterName ? info.adapterName : "unknown");
+    return key;
+}
+
+bool fits_device_limits(const Context &context, const LaunchConfig &config) noexcept {
+    if (config.thread_count() == 0 || config.items_per_thread == 0) return false;
+
+    // a zero limit means the backend does not report it
+    const auto &limits = context.device()->getInfo().limits;
+    const auto within = [](u32 value, u32 limit) { return limit == 0 || value <= limit; };
+    return within(config.thread_count(), limits.maxComputeThreadsPerGroup) &&
+           within(config.group_size_x, limits.maxComputeThreadGroupSize[0]) &&
+           within(config.group_size_y, limits.maxComputeThreadGroupSize[1]);
+}
+
+} // namespace llc
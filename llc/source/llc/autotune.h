@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <slang-com-ptr.h>
+#include <slang-rhi.h>
+
+#include <llc/context.h>
+#include <llc/timer.h>
+#include <llc/types.hpp>
+
+#include <llc/utils/small_vector.h>
+
+namespace llc {
+
+/// Launch parameters a kernel is specialized with at link time.
+struct LaunchConfig final {
+    u32 group_size_x = 0;
+    u32 group_size_y = 1;
+    u32 items_per_thread = 1;
+
+    [[nodiscard]] u32 thread_count() const noexcept { return group_size_x * group_size_y; }
+    bool operator==(const LaunchConfig &) const = default;
+};
+
+struct TunedLaunch final {
+    std::string key;
+    LaunchConfig config;
+};
+
+/// Fastest launch configurations found so far, keyed by `tuning_key()`.
+/// Every Context owns one, see `ContextDesc::tuning_profile` and `tuning_profile(Context &)`.
+struct TuningProfile final {
+    std::mutex mutex;
+    std::vector<TunedLaunch> entries;
+
+    [[nodiscard]] std::optional<LaunchConfig> find(std::string_view key);
+    void set(std::string_view key, const LaunchConfig &config);
+
+    /// Merges the entries of a profile written by `save`; entries read later win.
+    /// Returns false if the file cannot be read, malformed lines are skipped.
+    bool load(const std::filesystem::path &path);
+    bool save(const std::filesystem::path &path);
+};
+
+/// "<kernel>/<type>/<backend>/<adapter>", so a profile can be shared between machines and backends.
+std::string tuning_key(const Context &context, std::string_view kernel, std::string_view type);
+
+/// Whether the device can launch groups of this shape.
+bool fits_device_limits(const Context &context, const LaunchConfig &config) noexcept;
+
+struct TuneOptions final {
+    /// Untimed runs per candidate, which also build its pipeline.
+    u32 warmup_count = 2;
+    /// Timed runs per candidate; the median is compared.
+    u32 repeat_count = 8;
+};
+
+/// Times `encode_fn(config, encoder)` for every candidate the device can launch, stores the
+/// fastest under `key` in the context's profile and returns it. Returns nullopt if the device has
+/// no timestamp queries or no candidate could be encoded.
+template <typename EncodeFn>
+std::optional<LaunchConfig> autotune_launch(
+    Context &context,
+    std::string_view key,
+    std::span<const LaunchConfig> candidates,
+    EncodeFn encode_fn,
+    const TuneOptions &options = {}) {
+
+    if (options.repeat_count == 0) return std::nullopt;
+    auto timer = GpuTimer::create(context, options.repeat_count);
+    if (!timer) return std::nullopt;
+
+    auto *queue = context.queue();
+    std::optional<LaunchConfig> best;
+    f64 best_seconds = std::numeric_limits<f64>::infinity();
+    SmallVector<f64, 16> durations;
+
+    for (const auto &candidate : candidates) {
+        if (!fits_device_limits(context, candidate)) continue;
+
+        timer->reset();
+        auto encoder = queue->createCommandEncoder();
+        bool encoded = true;
+        for (u32 i = 0; encoded && i < options.warmup_count; ++i) {
+            encoded = SLANG_SUCCEEDED(encode_fn(candidate, encoder.get()));
+        }
+        for (u32 i = 0; encoded && i < options.repeat_count; ++i) {
+            auto scope = timer->scope(encoder.get());
+            encoded = SLANG_SUCCEEDED(encode_fn(candidate, encoder.get()));
+        }
+        auto command_buffer = encoder->finish();
+        if (!encoded) continue;
+
+        queue->submit(command_buffer);
+        queue->waitOnHost();
+        if (!timer->resolve()) continue;
+
+        const auto pair_durations = timer->pair_durations();
+        durations.assign(pair_durations);
+        if (durations.empty()) continue;
+        auto middle = durations.begin() + static_cast<std::ptrdiff_t>(durations.size() / 2);
+        std::nth_element(durations.begin(), middle, durations.end());
+        if (*middle < best_seconds) {
+            best_seconds = *middle;
+            best = candidate;
+        }
+    }
+
+    if (best) tuning_profile(context).set(key, *best);
+    return best;
+}
+
+} // namespace llc
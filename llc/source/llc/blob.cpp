@@ -2,6 +2,7 @@
 
 #include <filesystem>
 #include <fstream>
+#include <system_error>
 
 #include <llc/scalar_types.hpp>
 #include <llc/utils/config.h>
@@ -24,6 +25,56 @@ SLANG_NO_THROW SlangResult SLANG_MCALL FileBlob::queryInterface(
     return SLANG_E_NO_INTERFACE;
 }
 
+SLANG_NO_THROW SlangResult SLANG_MCALL ViewBlob::queryInterface(
+    SlangUUID const &guid,
+    void **out_object) {
+
+    if (!out_object)
+        return SLANG_E_INVALID_ARG;
+
+    if (guid == ISlangBlob::getTypeGuid() || guid == ISlangUnknown::getTypeGuid()) {
+        addRef();
+        *out_object = static_cast<ISlangBlob *>(this);
+        return SLANG_OK;
+    }
+    *out_object = nullptr;
+    return SLANG_E_NO_INTERFACE;
+}
+
+SLANG_NO_THROW SlangResult SLANG_MCALL MappedBlob::queryInterface(
+    SlangUUID const &guid,
+    void **out_object) {
+
+    if (!out_object)
+        return SLANG_E_INVALID_ARG;
+
+    if (guid == ISlangBlob::getTypeGuid() || guid == ISlangUnknown::getTypeGuid()) {
+        addRef();
+        *out_object = static_cast<ISlangBlob *>(this);
+        return SLANG_OK;
+    }
+    *out_object = nullptr;
+    return SLANG_E_NO_INTERFACE;
+}
+
+Slang::ComPtr<MappedBlob> MappedBlob::load(std::filesystem::path const &path, MapAccess access) {
+    auto file = MappedFile::open(path, access);
+    if (!file) return nullptr;
+    return Slang::ComPtr<MappedBlob>(new MappedBlob(std::move(*file)));
+}
+
+Slang::ComPtr<slang::IBlob> load_file_blob(std::filesystem::path const &path, MapAccess access, usize map_threshold) {
+    std::error_code error_code;
+    const auto file_size = std::filesystem::file_size(path, error_code);
+    if (error_code) return nullptr;
+
+    if (static_cast<usize>(file_size) >= map_threshold) {
+        if (auto blob = MappedBlob::load(path, access)) return Slang::ComPtr<slang::IBlob>(blob.get());
+    }
+    auto blob = FileBlob::load(path);
+    return Slang::ComPtr<slang::IBlob>(blob.get());
+}
+
 Slang::ComPtr<FileBlob> FileBlob::load(std::filesystem::path const &path) {
     if (!std::filesystem::exists(path)) {
         return nullptr;
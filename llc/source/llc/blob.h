@@ -5,10 +5,12 @@
 #include <cstring>
 #include <atomic>
 #include <memory>
+#include <utility>
 #include <filesystem>
 #include <fmt/base.h>
 
 #include <llc/types.hpp>
+#include <llc/utils/mapped_file.h>
 
 namespace llc {
 
@@ -66,6 +68,86 @@ struct FileBlob final : slang::IBlob {
     static Slang::ComPtr<FileBlob> load(std::filesystem::path const &path);
 };
 
+// non-owning blob over memory that outlives it, e.g. IR embedded in the binary
+struct ViewBlob final : slang::IBlob {
+    ViewBlob(const ViewBlob &) = delete;
+    ViewBlob &operator=(const ViewBlob &) = delete;
+
+    explicit ViewBlob(std::span<const byte> data) noexcept : data_(data) {}
+
+    // ISlangUnknown
+    SLANG_NO_THROW SlangResult SLANG_MCALL queryInterface(
+        SlangUUID const &guid,
+        void **out_object) override;
+
+    // IUnknown
+    SLANG_NO_THROW u32 SLANG_MCALL addRef() override { return ++ref_count_; }
+    SLANG_NO_THROW u32 SLANG_MCALL release() override {
+        auto new_count = --ref_count_;
+        if (new_count == 0) {
+            delete this;
+        }
+        return new_count;
+    }
+
+    // IBlob
+    SLANG_NO_THROW const void *SLANG_MCALL getBufferPointer() override {
+        return data_.data();
+    }
+    SLANG_NO_THROW usize SLANG_MCALL getBufferSize() override {
+        return data_.size();
+    }
+
+    std::atomic<u32> ref_count_{0};
+    std::span<const byte> data_;
+};
+
+// blob backed by a read-only file mapping, pages are only loaded when touched
+struct MappedBlob final : slang::IBlob {
+    MappedBlob(const MappedBlob &) = delete;
+    MappedBlob &operator=(const MappedBlob &) = delete;
+
+    explicit MappedBlob(MappedFile &&file) noexcept : file_(std::move(file)) {}
+
+    // ISlangUnknown
+    SLANG_NO_THROW SlangResult SLANG_MCALL queryInterface(
+        SlangUUID const &guid,
+        void **out_object) override;
+
+    // IUnknown
+    SLANG_NO_THROW u32 SLANG_MCALL addRef() override { return ++ref_count_; }
+    SLANG_NO_THROW u32 SLANG_MCALL release() override {
+        auto new_count = --ref_count_;
+        if (new_count == 0) {
+            delete this;
+        }
+        return new_count;
+    }
+
+    // IBlob
+    SLANG_NO_THROW const void *SLANG_MCALL getBufferPointer() override {
+        return file_.data();
+    }
+    SLANG_NO_THROW usize SLANG_MCALL getBufferSize() override {
+        return file_.size();
+    }
+
+    [[nodiscard]] const MappedFile &file() const noexcept { return file_; }
+
+    std::atomic<u32> ref_count_{0};
+    MappedFile file_;
+
+    // map a file
+    static Slang::ComPtr<MappedBlob> load(std::filesystem::path const &path, MapAccess access = MapAccess::SEQUENTIAL);
+};
+
+/// Loads a file as a blob: files of at least `map_threshold` bytes are mapped (MappedBlob), smaller
+/// ones are read into memory (FileBlob), where a mapping would cost more than the copy.
+Slang::ComPtr<slang::IBlob> load_file_blob(
+    std::filesystem::path const &path,
+    MapAccess access = MapAccess::SEQUENTIAL,
+    usize map_threshold = usize{1} << 16);
+
 inline void diagnose_if_needed(slang::IBlob *diagnostics) {
     if (diagnostics != nullptr) {
         fmt::print("{}", (const char *) diagnostics->getBufferPointer());
@@ -1,8 +1,24 @@
 #include "buffer.h"
 #include <llc/scalar_types.hpp>
+#include <llc/memory_tracker.h>
 
 namespace llc {
 
+namespace {
+
+MemoryCategory buffer_category(rhi::MemoryType memory_type) noexcept {
+    switch (memory_type) {
+        case rhi::MemoryType::Upload:
+            return MemoryCategory::STAGING;
+        case rhi::MemoryType::ReadBack:
+            return MemoryCategory::READBACK;
+        default:
+            return MemoryCategory::BUFFER;
+    }
+}
+
+} // namespace
+
 Slang::ComPtr<rhi::IBuffer> create_structured_buffer(
     Context &context,
     u64 byte_size,
@@ -20,7 +36,7 @@ Slang::ComPtr<rhi::IBuffer> create_structured_buffer(
         .defaultState = rc_state,
     };
 
-    return context.device()->createBuffer(buffer_desc, init_data);
+    return create_tracked_buffer(context, buffer_desc, init_data, buffer_category(memory_type));
 }
 
 Slang::ComPtr<rhi::IBuffer> create_buffer(
@@ -38,7 +54,18 @@ Slang::ComPtr<rhi::IBuffer> create_buffer(
         .defaultState = rc_state,
     };
 
-    return context.device()->createBuffer(buffer_desc, init_data);
+    return create_tracked_buffer(context, buffer_desc, init_data, buffer_category(memory_type));
+}
+
+Slang::ComPtr<rhi::IBuffer> create_scratch_buffer(Context &context, u64 byte_size, rhi::BufferUsage usage) {
+    rhi::BufferDesc buffer_desc{
+        .size = byte_size,
+        .memoryType = rhi::MemoryType::DeviceLocal,
+        .usage = usage,
+        .defaultState = rhi::ResourceState::UnorderedAccess,
+    };
+
+    return create_tracked_buffer(context, buffer_desc, nullptr, MemoryCategory::SCRATCH);
 }
 
 void clear_buffer(Context &context,
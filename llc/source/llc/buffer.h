@@ -80,6 +80,19 @@ ReadbackView<T> read_buffer(
     return ReadbackView<T>{blob};
 }
 
+/// Reads `dst.size()` elements at byte `offset` of `buffer` straight into `dst`, which may be
+/// page-locked or otherwise caller-owned memory; unlike `read_buffer` no blob is allocated.
+template <llc::standard_layout T>
+SlangResult read_buffer_into(
+    Context &context,
+    rhi::IBuffer *buffer,
+    rhi::Offset offset,
+    std::span<T> dst) {
+
+    if (dst.empty()) return SLANG_OK;
+    return context.device()->readBuffer(buffer, offset, dst.size_bytes(), dst.data());
+}
+
 Slang::ComPtr<rhi::IBuffer> create_buffer(
     Context &context,
     u64 byte_size,
@@ -120,6 +133,9 @@ Slang::ComPtr<rhi::IBuffer> create_buffer(
         rc_state);
 }
 
+/// Device-local buffer for intermediate results, accounted as MemoryCategory::SCRATCH.
+Slang::ComPtr<rhi::IBuffer> create_scratch_buffer(Context &context, u64 byte_size, rhi::BufferUsage usage);
+
 /// clear buffer to all zeros, slang-rhi does not support clear with values currently
 void clear_buffer(Context &context,
                   rhi::IBuffer *buffer,
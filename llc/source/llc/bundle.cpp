@@ -0,0 +1,150 @@
+#include "bundle.h"
+
+#include <slang-rhi/shader-cursor.h>
+
+namespace llc {
+
+namespace {
+
+/// Entry point parameters shadow globals of the same name, like they do in Slang.
+template <typename Scope>
+bool resolve_parameter(rhi::IShaderObject *root, const char *path, Scope &scope, rhi::ShaderOffset &offset) {
+    if (root->getEntryPointCount() > 0) {
+        const auto field = rhi::ShaderCursor(root->getEntryPoint(0)).getPath(path);
+        if (field.isValid()) {
+            scope = Scope::ENTRY_POINT;
+            offset = field.m_offset;
+            return true;
+        }
+    }
+
+    const auto field = rhi::ShaderCursor(root).getPath(path);
+    if (!field.isValid()) return false;
+    scope = Scope::GLOBAL;
+    offset = field.m_offset;
+    return true;
+}
+
+} // namespace
+
+u32 BundleDispatch::last_write_index() const noexcept {
+    return static_cast<u32>(bundle_->dispatches_[dispatch_index_].writes.size() - 1);
+}
+
+SlangResult BundleDispatch::set_data(const char *path, const void *data, usize size) {
+    if (!bundle_) return SLANG_E_INVALID_HANDLE;
+
+    CommandBundle::UniformWrite write{};
+    if (!resolve_parameter(root_.get(), path, write.scope, write.offset)) return SLANG_E_INVALID_ARG;
+
+    auto &bytes = bundle_->data_;
+    write.data_offset = static_cast<u32>(bytes.size());
+    write.size = static_cast<u32>(size);
+    const auto *first = static_cast<const byte *>(data);
+    bytes.insert(bytes.end(), first, first + size);
+
+    bundle_->dispatches_[dispatch_index_].writes.push_back(write);
+    return SLANG_OK;
+}
+
+SlangResult BundleDispatch::set_binding(const char *path, const rhi::Binding &binding) {
+    if (!bundle_) return SLANG_E_INVALID_HANDLE;
+
+    CommandBundle::BindingWrite write{};
+    if (!resolve_parameter(root_.get(), path, write.scope, write.offset)) return SLANG_E_INVALID_ARG;
+    write.binding = binding;
+
+    bundle_->dispatches_[dispatch_index_].bindings.push_back(std::move(write));
+    return SLANG_OK;
+}
+
+BundleDispatch CommandBundle::dispatch(const Kernel &kernel, const u32x3 &threads) {
+    if (!kernel) return {};
+
+    const auto group_count = kernel.group_count(threads);
+    if (!kernel.fits_dispatch_limits(group_count)) return {};
+
+    // a standalone root object has the same layout as the one bindPipeline returns,
+    // so offsets resolved against it are valid on replay
+    Slang::ComPtr<rhi::IShaderObject> root;
+    if (SLANG_FAILED(context_->device()->createRootShaderObject(kernel.program_.get(), root.writeRef()))) return {};
+
+    const auto dispatch_index = static_cast<u32>(dispatches_.size());
+    dispatches_.push_back({kernel.pipeline_, group_count, {}, {}});
+    commands_.push_back({CommandType::DISPATCH, dispatch_index});
+    return BundleDispatch(this, dispatch_index, std::move(root));
+}
+
+void CommandBundle::copy_buffer(rhi::IBuffer *dst, u64 dst_offset, rhi::IBuffer *src, u64 src_offset, u64 size) {
+    commands_.push_back({CommandType::COPY_BUFFER, static_cast<u32>(copies_.size())});
+    copies_.push_back({Slang::ComPtr<rhi::IBuffer>(dst), dst_offset, Slang::ComPtr<rhi::IBuffer>(src), src_offset, size});
+}
+
+void CommandBundle::clear_buffer(rhi::IBuffer *buffer, rhi::BufferRange range) {
+    commands_.push_back({CommandType::CLEAR_BUFFER, static_cast<u32>(clears_.size())});
+    clears_.push_back({Slang::ComPtr<rhi::IBuffer>(buffer), range});
+}
+
+void CommandBundle::encode_with(Function<void(rhi::ICommandEncoder *)> encode_fn) {
+    commands_.push_back({CommandType::CUSTOM, static_cast<u32>(customs_.size())});
+    customs_.push_back(std::move(encode_fn));
+}
+
+SlangResult CommandBundle::encode(rhi::ICommandEncoder *encoder) {
+    rhi::IComputePassEncoder *pass = nullptr;
+    const auto end_pass = [&]() {
+        if (pass) pass->end();
+        pass = nullptr;
+    };
+
+    SlangResult result = SLANG_OK;
+    for (const auto &command : commands_) {
+        if (command.type != CommandType::DISPATCH) end_pass();
+
+        switch (command.type) {
+            case CommandType::DISPATCH: {
+                const auto &dispatch = dispatches_[command.index];
+                if (!pass) pass = encoder->beginComputePass();
+
+                auto *root = pass->bindPipeline(dispatch.pipeline.get());
+                auto *entry_point = root->getEntryPointCount() > 0 ? root->getEntryPoint(0) : nullptr;
+                const auto object = [&](ParameterScope scope) {
+                    return scope == ParameterScope::ENTRY_POINT ? entry_point : root;
+                };
+
+                for (const auto &write : dispatch.writes) {
+                    result = object(write.scope)->setData(write.offset, data_.data() + write.data_offset, write.size);
+                    if (SLANG_FAILED(result)) break;
+                }
+                for (const auto &binding : dispatch.bindings) {
+                    if (SLANG_FAILED(result)) break;
+                    result = object(binding.scope)->setBinding(binding.offset, binding.binding);
+                }
+                if (SLANG_FAILED(result)) break;
+
+                pass->dispatchCompute(dispatch.group_count.x, dispatch.group_count.y, dispatch.group_count.z);
+                break;
+            }
+            case CommandType::COPY_BUFFER: {
+                const auto &copy = copies_[command.index];
+                encoder->copyBuffer(copy.dst.get(), copy.dst_offset, copy.src.get(), copy.src_offset, copy.size);
+                break;
+            }
+            case CommandType::CLEAR_BUFFER: {
+                const auto &clear = clears_[command.index];
+                encoder->clearBuffer(clear.buffer.get(), clear.range);
+                break;
+            }
+            case CommandType::CUSTOM:
+                customs_[command.index](encoder);
+                break;
+        }
+
+        if (SLANG_FAILED(result)) break;
+    }
+
+    end_pass();
+    return result;
+}
+
+} // namespace llc
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#include <slang-com-ptr.h>
+#include <slang-rhi.h>
+
+#include <llc/context.h>
+#include <llc/kernel.h>
+#include <llc/types.hpp>
+
+#include <llc/utils/functional.h>
+#include <llc/utils/small_vector.h>
+
+namespace llc {
+
+/// A parameter of a recorded dispatch whose value may change between replays.
+template <typename T>
+struct BundleSlot final {
+    u32 dispatch_index = 0;
+    u32 write_index = 0;
+};
+
+struct CommandBundle;
+
+/// Records the parameters of one dispatch in a `CommandBundle`. Parameter paths are resolved here,
+/// once, against the entry point first and the global scope second.
+struct BundleDispatch final {
+    explicit operator bool() const noexcept { return bundle_ != nullptr; }
+
+    SlangResult set_data(const char *path, const void *data, usize size);
+    SlangResult set_binding(const char *path, const rhi::Binding &binding);
+
+    template <typename T>
+    SlangResult set(const char *path, const T &value) {
+        return set_data(path, &value, sizeof(T));
+    }
+
+    /// Like `set`, but the value can be changed with `CommandBundle::set` before each replay.
+    template <typename T>
+    std::optional<BundleSlot<T>> slot(const char *path, const T &initial_value) {
+        if (SLANG_FAILED(set_data(path, &initial_value, sizeof(T)))) return std::nullopt;
+        return BundleSlot<T>{dispatch_index_, last_write_index()};
+    }
+
+private:
+    friend struct CommandBundle;
+
+    BundleDispatch() = default;
+    BundleDispatch(CommandBundle *bundle, u32 dispatch_index, Slang::ComPtr<rhi::IShaderObject> root)
+        : bundle_(bundle), dispatch_index_(dispatch_index), root_(std::move(root)) {}
+
+    [[nodiscard]] u32 last_write_index() const noexcept;
+
+    CommandBundle *bundle_ = nullptr;
+    u32 dispatch_index_ = 0;
+    Slang::ComPtr<rhi::IShaderObject> root_;
+};
+
+/// A sequence of dispatches and copies recorded once and replayed many times.
+///
+/// slang-rhi has no reusable command buffers, so a bundle keeps a compact command list with every
+/// pipeline, group count and parameter offset resolved at record time; replaying it only writes
+/// the parameter bytes and bindings and never touches reflection. Consecutive dispatches share a
+/// compute pass. The bundle must not be moved while a `BundleDispatch` of it is in use.
+struct CommandBundle final {
+    explicit CommandBundle(Context &context) : context_(&context) {}
+
+    /// Appends a dispatch of `kernel` running one thread per element of `threads`. Returns an
+    /// empty recorder if the dispatch does not fit the device limits, bundles do not split them.
+    BundleDispatch dispatch(const Kernel &kernel, const u32x3 &threads);
+
+    void copy_buffer(rhi::IBuffer *dst, u64 dst_offset, rhi::IBuffer *src, u64 src_offset, u64 size);
+    void clear_buffer(rhi::IBuffer *buffer, rhi::BufferRange range = rhi::kEntireBuffer);
+    /// Appends work the bundle has no command for, e.g. cooperative vector conversions.
+    void encode_with(Function<void(rhi::ICommandEncoder *)> encode_fn);
+
+    template <typename T>
+    void set(const BundleSlot<T> &slot, const T &value) noexcept {
+        const auto &write = dispatches_[slot.dispatch_index].writes[slot.write_index];
+        std::memcpy(data_.data() + write.data_offset, &value, sizeof(T));
+    }
+
+    /// Encodes the bundle once with the current slot values.
+    SlangResult encode(rhi::ICommandEncoder *encoder);
+
+    /// Encodes the bundle `count` times into one command buffer and submits it, calling
+    /// `update_fn(iteration)` before each copy so it can `set` the slots.
+    template <typename UpdateFn>
+    SlangResult replay(u32 count, UpdateFn &&update_fn) {
+        auto *queue = context_->queue();
+        auto encoder = queue->createCommandEncoder();
+        for (u32 i = 0; i < count; ++i) {
+            update_fn(i);
+            SLANG_RETURN_ON_FAIL(encode(encoder.get()));
+        }
+        Slang::ComPtr<rhi::ICommandBuffer> command_buffer;
+        SLANG_RETURN_ON_FAIL(encoder->finish(command_buffer.writeRef()));
+        return queue->submit(command_buffer.get());
+    }
+
+    SlangResult replay(u32 count = 1) {
+        return replay(count, [](u32) {});
+    }
+
+    [[nodiscard]] usize command_count() const noexcept { return commands_.size(); }
+
+private:
+    friend struct BundleDispatch;
+
+    enum class CommandType : u8 {
+        DISPATCH,
+        COPY_BUFFER,
+        CLEAR_BUFFER,
+        CUSTOM,
+    };
+
+    enum class ParameterScope : u8 {
+        GLOBAL,
+        ENTRY_POINT,
+    };
+
+    struct Command final {
+        CommandType type;
+        /// into the vector of that command type
+        u32 index;
+    };
+
+    struct UniformWrite final {
+        ParameterScope scope;
+        rhi::ShaderOffset offset;
+        u32 data_offset;
+        u32 size;
+    };
+
+    struct BindingWrite final {
+        ParameterScope scope;
+        rhi::ShaderOffset offset;
+        rhi::Binding binding;
+    };
+
+    struct DispatchCommand final {
+        Slang::ComPtr<rhi::IComputePipeline> pipeline;
+        u32x3 group_count;
+        SmallVector<UniformWrite, 8> writes;
+        SmallVector<BindingWrite, 4> bindings;
+    };
+
+    struct CopyBufferCommand final {
+        Slang::ComPtr<rhi::IBuffer> dst;
+        u64 dst_offset;
+        Slang::ComPtr<rhi::IBuffer> src;
+        u64 src_offset;
+        u64 size;
+    };
+
+    struct ClearBufferCommand final {
+        Slang::ComPtr<rhi::IBuffer> buffer;
+        rhi::BufferRange range;
+    };
+
+    Context *context_;
+    std::vector<Command> commands_;
+    std::vector<DispatchCommand> dispatches_;
+    std::vector<CopyBufferCommand> copies_;
+    std::vector<ClearBufferCommand> clears_;
+    std::vector<Function<void(rhi::ICommandEncoder *)>> customs_;
+    /// uniform bytes of every dispatch, written into the shader objects on replay
+    std::vector<byte> data_;
+};
+
+} // namespace llc
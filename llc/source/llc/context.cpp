@@ -2,6 +2,11 @@
 
 #include <utility>
 
+#include <llc/autotune.h>
+#include <llc/memory_tracker.h>
+#include <llc/mip_generator.h>
+#include <llc/view_cache.h>
+#include <llc/utils/module_registry.h>
 #include <llc/utils/pipeline_cache.h>
 
 namespace llc {
@@ -15,13 +20,26 @@ std::optional<Context> Context::create(const ContextDesc &desc) {
 
     context.slang_session_ = context.device_->getSlangSession();
     context.pipeline_cache_ = std::make_unique<PipelineCache>();
+    context.module_registry_ = std::make_unique<ModuleRegistry>();
+    context.tuning_profile_ = std::make_unique<TuningProfile>();
+    if (!desc.tuning_profile.empty()) (void) context.tuning_profile_->load(desc.tuning_profile);
+    context.memory_tracker_ = std::make_unique<MemoryTracker>();
+    context.memory_tracker_->enabled = desc.track_memory || desc.memory_budget != 0;
+    context.memory_tracker_->budget = desc.memory_budget;
+    context.mip_generator_ = std::make_unique<MipGenerator>(*context.memory_tracker_);
+    context.view_cache_ = std::make_unique<ViewCache>(*context.memory_tracker_);
     return context;
 }
 
 Context::Context(Context &&other) noexcept
     : device_(std::move(other.device_)),
       slang_session_(std::move(other.slang_session_)),
-      pipeline_cache_(std::move(other.pipeline_cache_)) {}
+      pipeline_cache_(std::move(other.pipeline_cache_)),
+      module_registry_(std::move(other.module_registry_)),
+      tuning_profile_(std::move(other.tuning_profile_)),
+      memory_tracker_(std::move(other.memory_tracker_)),
+      mip_generator_(std::move(other.mip_generator_)),
+      view_cache_(std::move(other.view_cache_)) {}
 
 Context &Context::operator=(Context &&other) noexcept {
     if (this != &other) {
@@ -29,6 +47,11 @@ Context &Context::operator=(Context &&other) noexcept {
         device_ = std::move(other.device_);
         slang_session_ = std::move(other.slang_session_);
         pipeline_cache_ = std::move(other.pipeline_cache_);
+        module_registry_ = std::move(other.module_registry_);
+        tuning_profile_ = std::move(other.tuning_profile_);
+        memory_tracker_ = std::move(other.memory_tracker_);
+        mip_generator_ = std::move(other.mip_generator_);
+        view_cache_ = std::move(other.view_cache_);
     }
     return *this;
 }
@@ -43,6 +66,13 @@ rhi::ICommandQueue *Context::queue() const noexcept {
 
 void Context::reset() noexcept {
     pipeline_cache_.reset();
+    module_registry_.reset();
+    tuning_profile_.reset();
+    // cached views and buffers are tracked resources too
+    mip_generator_.reset();
+    view_cache_.reset();
+    // the tracker holds references to resources, drop them before the device
+    memory_tracker_.reset();
     slang_session_ = nullptr;
     device_ = nullptr;
 }
@@ -55,4 +85,24 @@ const PipelineCache &pipeline_cache(const Context &context) noexcept {
     return *context.pipeline_cache_;
 }
 
+ModuleRegistry &module_registry(Context &context) noexcept {
+    return *context.module_registry_;
+}
+
+TuningProfile &tuning_profile(Context &context) noexcept {
+    return *context.tuning_profile_;
+}
+
+MemoryTracker &memory_tracker(Context &context) noexcept {
+    return *context.memory_tracker_;
+}
+
+MipGenerator &mip_generator(Context &context) noexcept {
+    return *context.mip_generator_;
+}
+
+ViewCache &view_cache(Context &context) noexcept {
+    return *context.view_cache_;
+}
+
 } // namespace llc
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <filesystem>
 #include <memory>
 #include <optional>
 
@@ -7,12 +8,28 @@
 #include <slang-rhi.h>
 #include <slang.h>
 
+#include <llc/scalar_types.hpp>
+
 namespace llc {
 
 struct PipelineCache;
+struct ModuleRegistry;
+struct TuningProfile;
+struct MemoryTracker;
+struct MipGenerator;
+struct ViewCache;
 
 struct ContextDesc final {
     rhi::DeviceDesc device;
+    /// Launch configurations tuned in earlier runs (see autotune.h); a missing file is not an error.
+    std::filesystem::path tuning_profile;
+    /// Account device memory allocated through llc, see memory_tracker.h. The tracker references
+    /// every tracked resource, so one the caller drops is destroyed only at the next tracked
+    /// allocation whose sweep reaches it, wait of llc for the queue, `memory_snapshot` or
+    /// `collect_memory`.
+    bool track_memory = false;
+    /// Tracked allocations fail beyond this many bytes, 0 for no limit; implies `track_memory`.
+    u64 memory_budget = 0;
 };
 
 struct Context final {
@@ -35,12 +52,27 @@ private:
     Slang::ComPtr<rhi::IDevice> device_;
     Slang::ComPtr<slang::ISession> slang_session_;
     std::unique_ptr<PipelineCache> pipeline_cache_;
+    std::unique_ptr<ModuleRegistry> module_registry_;
+    std::unique_ptr<TuningProfile> tuning_profile_;
+    std::unique_ptr<MemoryTracker> memory_tracker_;
+    std::unique_ptr<MipGenerator> mip_generator_;
+    std::unique_ptr<ViewCache> view_cache_;
 
     friend PipelineCache &pipeline_cache(Context &context) noexcept;
     friend const PipelineCache &pipeline_cache(const Context &context) noexcept;
+    friend ModuleRegistry &module_registry(Context &context) noexcept;
+    friend TuningProfile &tuning_profile(Context &context) noexcept;
+    friend MemoryTracker &memory_tracker(Context &context) noexcept;
+    friend MipGenerator &mip_generator(Context &context) noexcept;
+    friend ViewCache &view_cache(Context &context) noexcept;
 };
 
 PipelineCache &pipeline_cache(Context &context) noexcept;
 const PipelineCache &pipeline_cache(const Context &context) noexcept;
+ModuleRegistry &module_registry(Context &context) noexcept;
+TuningProfile &tuning_profile(Context &context) noexcept;
+MemoryTracker &memory_tracker(Context &context) noexcept;
+MipGenerator &mip_generator(Context &context) noexcept;
+ViewCache &view_cache(Context &context) noexcept;
 
 } // namespace llc
@@ -0,0 +1,190 @@
+#include "context_group.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <llc/blob.h>
+
+namespace llc {
+
+/// In-memory persistent cache handed to several devices; slang-rhi calls it from any thread.
+struct SharedPersistentCache final : rhi::IPersistentCache {
+    SharedPersistentCache() = default;
+    SharedPersistentCache(const SharedPersistentCache &) = delete;
+    SharedPersistentCache &operator=(const SharedPersistentCache &) = delete;
+
+    // ISlangUnknown
+    SLANG_NO_THROW SlangResult SLANG_MCALL queryInterface(SlangUUID const &guid, void **out_object) override {
+        if (!out_object) return SLANG_E_INVALID_ARG;
+        if (guid == rhi::IPersistentCache::getTypeGuid() || guid == ISlangUnknown::getTypeGuid()) {
+            addRef();
+            *out_object = static_cast<rhi::IPersistentCache *>(this);
+            return SLANG_OK;
+        }
+        *out_object = nullptr;
+        return SLANG_E_NO_INTERFACE;
+    }
+
+    SLANG_NO_THROW u32 SLANG_MCALL addRef() override { return ++ref_count_; }
+    SLANG_NO_THROW u32 SLANG_MCALL release() override {
+        auto new_count = --ref_count_;
+        if (new_count == 0) {
+            delete this;
+        }
+        return new_count;
+    }
+
+    // IPersistentCache
+    SLANG_NO_THROW SlangResult SLANG_MCALL writeCache(ISlangBlob *key, ISlangBlob *data) override {
+        const std::span<const byte> bytes(static_cast<const byte *>(data->getBufferPointer()), data->getBufferSize());
+        Slang::ComPtr<ISlangBlob> copy(new FileBlob(bytes));
+        std::scoped_lock lock(mutex_);
+        entries_.insert_or_assign(key_string(key), std::move(copy));
+        return SLANG_OK;
+    }
+
+    SLANG_NO_THROW SlangResult SLANG_MCALL queryCache(ISlangBlob *key, ISlangBlob **out_data) override {
+        std::scoped_lock lock(mutex_);
+        const auto it = entries_.find(key_string(key));
+        if (it == entries_.end()) {
+            *out_data = nullptr;
+            return SLANG_E_NOT_FOUND;
+        }
+        *out_data = Slang::ComPtr<ISlangBlob>(it->second).detach();
+        return SLANG_OK;
+    }
+
+    [[nodiscard]] usize size() const {
+        std::scoped_lock lock(mutex_);
+        return entries_.size();
+    }
+
+private:
+    static std::string key_string(ISlangBlob *key) {
+        return {static_cast<const char *>(key->getBufferPointer()), key->getBufferSize()};
+    }
+
+    std::atomic<u32> ref_count_{0};
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Slang::ComPtr<ISlangBlob>> entries_;
+};
+
+namespace {
+
+/// Devices created from descriptions that pick the same type and adapter run the same driver.
+bool same_adapter(const rhi::DeviceDesc &a, const rhi::DeviceDesc &b) noexcept {
+    if (a.deviceType != b.deviceType) return false;
+    if (!a.adapterLUID || !b.adapterLUID) return a.adapterLUID == b.adapterLUID;
+    return std::memcmp(a.adapterLUID, b.adapterLUID, sizeof(rhi::AdapterLUID)) == 0;
+}
+
+f64 smooth(f64 average, f64 sample, f64 weight) noexcept {
+    return average > 0.0 ? average + (sample - average) * weight : sample;
+}
+
+} // namespace
+
+ContextGroup::ContextGroup() noexcept = default;
+ContextGroup::ContextGroup(ContextGroup &&) noexcept = default;
+ContextGroup::~ContextGroup() = default;
+
+ContextGroup &ContextGroup::operator=(ContextGroup &&other) noexcept {
+    if (this != &other) {
+        // release the current devices before the caches they point to
+        contexts_ = std::move(other.contexts_);
+        rates_ = std::move(other.rates_);
+        shader_cache_ = std::move(other.shader_cache_);
+        pipeline_caches_ = std::move(other.pipeline_caches_);
+        smoothing_ = other.smoothing_;
+    }
+    return *this;
+}
+
+std::optional<ContextGroup> ContextGroup::create(const ContextGroupDesc &desc) {
+    if (desc.contexts.empty()) return std::nullopt;
+
+    ContextGroup group;
+    group.smoothing_ = desc.smoothing;
+    if (desc.share_caches) group.shader_cache_ = Slang::ComPtr<SharedPersistentCache>(new SharedPersistentCache());
+
+    // index into `pipeline_caches_` of the first context on each adapter
+    SmallVector<usize, 8> pipeline_cache_index(desc.contexts.size());
+    group.contexts_.reserve(desc.contexts.size());
+    for (usize i = 0; i < desc.contexts.size(); ++i) {
+        auto context_desc = desc.contexts[i];
+        auto &device_desc = context_desc.device;
+        if (desc.share_caches) {
+            if (!device_desc.persistentShaderCache) device_desc.persistentShaderCache = group.shader_cache_.get();
+
+            usize cache_index = group.pipeline_caches_.size();
+            for (usize j = 0; j < i; ++j) {
+                if (same_adapter(desc.contexts[j].device, desc.contexts[i].device)) {
+                    cache_index = pipeline_cache_index[j];
+                    break;
+                }
+            }
+            if (cache_index == group.pipeline_caches_.size()) {
+                group.pipeline_caches_.push_back(Slang::ComPtr<SharedPersistentCache>(new SharedPersistentCache()));
+            }
+            pipeline_cache_index[i] = cache_index;
+            if (!device_desc.persistentPipelineCache) {
+                device_desc.persistentPipelineCache = group.pipeline_caches_[cache_index].get();
+            }
+        }
+
+        auto context = Context::create(context_desc);
+        if (!context) return std::nullopt;
+        group.contexts_.push_back(std::move(*context));
+    }
+    group.rates_.assign(group.contexts_.size(), 0.0);
+    return group;
+}
+
+std::optional<ContextGroup> ContextGroup::create(const ContextDesc &desc, u32 count) {
+    return create(ContextGroupDesc{.contexts = std::vector<ContextDesc>(count, desc)});
+}
+
+SmallVector<IndexRange, 8> partition(usize count, std::span<const f64> rates, usize alignment) {
+    const usize part_count = rates.size();
+    const bool measured = std::ranges::all_of(rates, [](f64 rate) { return rate > 0.0; });
+    const auto weight = [&](usize index) { return measured ? rates[index] : 1.0; };
+
+    f64 total = 0.0;
+    for (usize i = 0; i < part_count; ++i) total += weight(i);
+
+    alignment = std::max<usize>(alignment, 1);
+    SmallVector<IndexRange, 8> ranges(part_count);
+    usize begin = 0;
+    f64 cumulative = 0.0;
+    for (usize i = 0; i < part_count; ++i) {
+        cumulative += weight(i);
+        usize end = count;
+        if (i + 1 < part_count) {
+            const auto share = static_cast<usize>(static_cast<f64>(count) * (cumulative / total));
+            end = std::clamp(share / alignment * alignment, begin, count);
+        }
+        ranges[i] = {begin, end};
+        begin = end;
+    }
+    return ranges;
+}
+
+void ContextGroup::record(usize index, usize bytes, f64 seconds) noexcept {
+    if (bytes == 0 || seconds <= 0.0) return;
+    rates_[index] = smooth(rates_[index], static_cast<f64>(bytes) / seconds, smoothing_);
+}
+
+void ContextGroup::reset_rates() noexcept {
+    std::ranges::fill(rates_, 0.0);
+}
+
+usize ContextGroup::shared_shader_count() const {
+    return shader_cache_ ? shader_cache_->size() : 0;
+}
+
+} // namespace llc
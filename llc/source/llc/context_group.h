@@ -0,0 +1,91 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <slang-com-ptr.h>
+#include <slang-rhi.h>
+
+#include <llc/context.h>
+#include <llc/types.hpp>
+#include <llc/utils/small_vector.h>
+
+namespace llc {
+
+struct SharedPersistentCache;
+
+/// Half-open index range [begin, end).
+struct IndexRange final {
+    usize begin = 0;
+    usize end = 0;
+
+    [[nodiscard]] usize size() const noexcept { return end - begin; }
+    [[nodiscard]] bool empty() const noexcept { return begin == end; }
+    bool operator==(const IndexRange &) const = default;
+};
+
+/// Splits [0, count) into one contiguous range per entry of `rates`, in proportion to the rates once
+/// every one of them is positive, equally before that. Range boundaries are multiples of `alignment`;
+/// entries whose share rounds to nothing get an empty range, the last one takes the remainder.
+[[nodiscard]] SmallVector<IndexRange, 8> partition(usize count, std::span<const f64> rates, usize alignment = 1);
+
+struct ContextGroupDesc final {
+    /// One context per entry, created in order.
+    std::vector<ContextDesc> contexts;
+    /// Compiled shaders are shared by every device of the group, driver pipeline caches by devices of
+    /// the same type on the same adapter. Caches set in a `DeviceDesc` are left alone.
+    bool share_caches = true;
+    /// Weight of the newest measurement in the moving average of each device's throughput.
+    f64 smoothing = 0.25;
+};
+
+/// Several devices used side by side, e.g. all adapters of a host or a few CPU devices in CI.
+///
+/// Every context is independent and may be used from its own thread. Work is split with
+/// `partition`, in proportion to the throughput `record` measured so far, equally before that.
+struct ContextGroup final {
+    static std::optional<ContextGroup> create(const ContextGroupDesc &desc);
+    /// `count` contexts created from the same description.
+    static std::optional<ContextGroup> create(const ContextDesc &desc, u32 count);
+
+    ContextGroup(ContextGroup &&) noexcept;
+    ContextGroup &operator=(ContextGroup &&) noexcept;
+    ContextGroup(const ContextGroup &) = delete;
+    ContextGroup &operator=(const ContextGroup &) = delete;
+    ~ContextGroup();
+
+    [[nodiscard]] usize size() const noexcept { return contexts_.size(); }
+    [[nodiscard]] Context &operator[](usize index) noexcept { return contexts_[index]; }
+    [[nodiscard]] std::span<Context> contexts() noexcept { return contexts_; }
+    Context *begin() noexcept { return contexts_.data(); }
+    Context *end() noexcept { return contexts_.data() + contexts_.size(); }
+
+    /// Splits [0, count) into one contiguous range per context. Range boundaries are multiples of
+    /// `alignment`; contexts whose share rounds to nothing get an empty range.
+    [[nodiscard]] SmallVector<IndexRange, 8> partition(usize count, usize alignment = 1) const {
+        return llc::partition(count, rates_, alignment);
+    }
+
+    /// Feeds the time context `index` took for `bytes` of work into its throughput average.
+    void record(usize index, usize bytes, f64 seconds) noexcept;
+    /// Smoothed throughput of a context, zero until it has been measured.
+    [[nodiscard]] f64 bytes_per_second(usize index) const noexcept { return rates_[index]; }
+    /// Forgets the measured throughputs, `partition` splits equally again.
+    void reset_rates() noexcept;
+
+    /// Entries in the shader cache shared by the group, 0 if caches are not shared.
+    [[nodiscard]] usize shared_shader_count() const;
+
+private:
+    ContextGroup() noexcept;
+
+    // declared before the contexts so that the devices are destroyed first
+    Slang::ComPtr<SharedPersistentCache> shader_cache_;
+    SmallVector<Slang::ComPtr<SharedPersistentCache>, 4> pipeline_caches_;
+    std::vector<Context> contexts_;
+    std::vector<f64> rates_;
+    f64 smoothing_ = 0.25;
+};
+
+} // namespace llc
@@ -1,7 +1,16 @@
 #include "f16.h"
 
 #include <bit>
+#include <cassert>
 #include <llc/scalar_types.hpp>
+#include <llc/utils/config.h>
+
+#if LLC_SIMD_AVX2 || LLC_SIMD_F16C
+#include <immintrin.h>
+#endif
+#if LLC_SIMD_NEON
+#include <arm_neon.h>
+#endif
 
 namespace llc {
 
@@ -62,8 +71,72 @@ f32 f16_bits_to_float(storage_type bits) noexcept {
     return std::bit_cast<f32>(value_bits);
 }
 
+#if LLC_SIMD_AVX2
+/// `float_to_f16_bits` of 8 lanes, every branch computed and selected. The hardware conversion
+/// (F16C) rounds ties to even and flushes differently, so it is not used in this direction.
+__m128i float_to_f16_bits(__m256 value) noexcept {
+    const auto one = _mm256_set1_epi32(1);
+    const auto bits = _mm256_castps_si256(value);
+    const auto sign = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(0x8000));
+    const auto mantissa = _mm256_and_si256(_mm256_srli_epi32(bits, 12), _mm256_set1_epi32(0x07ff));
+    const auto exponent = _mm256_and_si256(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(0xff));
+
+    auto normal = _mm256_or_si256(
+        _mm256_slli_epi32(_mm256_sub_epi32(exponent, _mm256_set1_epi32(112)), 10),
+        _mm256_srli_epi32(mantissa, 1));
+    normal = _mm256_add_epi32(normal, _mm256_and_si256(mantissa, one));
+
+    // shift counts of other lanes go out of range, which shifts in zeros
+    const auto implicit = _mm256_or_si256(mantissa, _mm256_set1_epi32(0x0800));
+    auto subnormal = _mm256_srlv_epi32(implicit, _mm256_sub_epi32(_mm256_set1_epi32(114), exponent));
+    subnormal = _mm256_add_epi32(
+        subnormal,
+        _mm256_and_si256(_mm256_srlv_epi32(implicit, _mm256_sub_epi32(_mm256_set1_epi32(113), exponent)), one));
+
+    const auto is_nan = _mm256_andnot_si256(
+        _mm256_cmpeq_epi32(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_setzero_si256()),
+        _mm256_cmpeq_epi32(exponent, _mm256_set1_epi32(255)));
+    const auto overflow = _mm256_or_si256(_mm256_set1_epi32(0x7c00), _mm256_and_si256(is_nan, one));
+
+    auto result = _mm256_blendv_epi8(normal, subnormal, _mm256_cmpgt_epi32(_mm256_set1_epi32(113), exponent));
+    result = _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(103), exponent), result);
+    result = _mm256_blendv_epi8(result, overflow, _mm256_cmpgt_epi32(exponent, _mm256_set1_epi32(142)));
+    result = _mm256_or_si256(result, sign);
+    return _mm_packus_epi32(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1));
+}
+#endif
+
 } // namespace
 
+void convert_f32_to_f16(std::span<const f32> source, std::span<f16> destination) noexcept {
+    assert(destination.size() >= source.size());
+    usize i = 0;
+#if LLC_SIMD_AVX2
+    for (; i + 8 <= source.size(); i += 8) {
+        const auto half = float_to_f16_bits(_mm256_loadu_ps(source.data() + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(destination.data() + i), half);
+    }
+#endif
+    for (; i < source.size(); ++i) destination[i] = f16(source[i]);
+}
+
+void convert_f16_to_f32(std::span<const f16> source, std::span<f32> destination) noexcept {
+    assert(destination.size() >= source.size());
+    usize i = 0;
+#if LLC_SIMD_F16C
+    for (; i + 8 <= source.size(); i += 8) {
+        const auto half = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source.data() + i));
+        _mm256_storeu_ps(destination.data() + i, _mm256_cvtph_ps(half));
+    }
+#elif LLC_SIMD_NEON
+    for (; i + 4 <= source.size(); i += 4) {
+        const auto half = vreinterpret_f16_u16(vld1_u16(reinterpret_cast<const u16 *>(source.data() + i)));
+        vst1q_f32(destination.data() + i, vcvt_f32_f16(half));
+    }
+#endif
+    for (; i < source.size(); ++i) destination[i] = static_cast<f32>(source[i]);
+}
+
 f16::f16(f32 value) noexcept : bits_(float_to_f16_bits(value)) {}
 
 f16::operator f32() const noexcept {
@@ -2,6 +2,7 @@
 
 #include <compare>
 #include <limits>
+#include <span>
 
 #include <llc/scalar_types.hpp>
 
@@ -68,6 +69,13 @@ private:
 
 static_assert(sizeof(f16) == 2);
 
+/// `f16(source[i])` for every element, bit for bit; AVX2 builds convert 8 at a time.
+/// `destination` holds at least `source.size()` elements.
+void convert_f32_to_f16(std::span<const f32> source, std::span<f16> destination) noexcept;
+/// `f32(source[i])` for every element; F16C and NEON builds convert in hardware, which is exact.
+/// `destination` holds at least `source.size()` elements.
+void convert_f16_to_f32(std::span<const f16> source, std::span<f32> destination) noexcept;
+
 } // namespace llc
 
 namespace std {
@@ -1,12 +1,29 @@
 #include "image.h"
 
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include <stb_image_write.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
+#include <climits>
 #include <cstring>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
 #include <llc/scalar_types.hpp>
+#include <llc/utils/config.h>
+#include <llc/utils/parallel.h>
+
+#if LLC_SIMD_AVX2
+#include <immintrin.h>
+#endif
+#if LLC_SIMD_NEON
+#include <arm_neon.h>
+#endif
 
 namespace llc {
 
@@ -32,6 +49,15 @@ f32 unorm8_to_float(u8 value) noexcept {
     return static_cast<f32>(value) / 255.0f;
 }
 
+u16 float_to_unorm16(f32 value) noexcept {
+    value = std::clamp(value, 0.0f, 1.0f);
+    return static_cast<u16>(value * 65535.0f + 0.5f);
+}
+
+f32 unorm16_to_float(u16 value) noexcept {
+    return static_cast<f32>(value) / 65535.0f;
+}
+
 bool is_rgba8_format(rhi::Format format) noexcept {
     return format == rhi::Format::RGBA8Unorm || format == rhi::Format::RGBA8UnormSrgb;
 }
@@ -44,30 +70,438 @@ f32 sanitize_scalar(f32 value) noexcept {
     return is_finite(value) ? value : 0.0f;
 }
 
-void load_rgba_from_rgba8(const byte *src, rhi::Format format, f32 rgba[4]) noexcept {
-    rgba[0] = unorm8_to_float(static_cast<u8>(src[0]));
-    rgba[1] = unorm8_to_float(static_cast<u8>(src[1]));
-    rgba[2] = unorm8_to_float(static_cast<u8>(src[2]));
-    rgba[3] = unorm8_to_float(static_cast<u8>(src[3]));
-    if (format == rhi::Format::RGBA8UnormSrgb) {
-        rgba[0] = srgb_to_linear(rgba[0]);
-        rgba[1] = srgb_to_linear(rgba[1]);
-        rgba[2] = srgb_to_linear(rgba[2]);
+/// Pixels a conversion thread takes at least.
+constexpr usize k_min_pixels_per_thread = usize{1} << 16;
+
+/// `linear_to_srgb` on [0.0031308, 1] as a rational function of sqrt(value), least-squares fitted;
+/// within 0.1 of the exact result in 8-bit steps.
+constexpr f32 k_srgb_num0 = -0.0422757638f;
+constexpr f32 k_srgb_num1 = 1.42989144f;
+constexpr f32 k_srgb_num2 = 3.91965252f;
+constexpr f32 k_srgb_den1 = 4.00096252f;
+constexpr f32 k_srgb_den2 = 0.306886193f;
+
+/// The exact scalar conversions the fast paths must reproduce.
+u8 srgb8_to_unorm8_exact(u8 value) noexcept {
+    return float_to_unorm8(sanitize_scalar(srgb_to_linear(unorm8_to_float(value))));
+}
+
+u8 unorm8_to_srgb8_exact(u8 value) noexcept {
+    return float_to_unorm8(linear_to_srgb(sanitize_scalar(unorm8_to_float(value))));
+}
+
+u8 linear_to_srgb8_exact(f32 value) noexcept {
+    return float_to_unorm8(linear_to_srgb(sanitize_scalar(value)));
+}
+
+/// Every 8-bit conversion tabulated from the exact scalar functions, so looking one up gives the
+/// same bits. 8-bit alpha round-trips through float unchanged and needs no table.
+struct ConversionTables final {
+    std::array<f32, 256> unorm8_to_f32;
+    std::array<f32, 256> srgb8_to_f32;
+    std::array<u8, 256> srgb8_to_unorm8;
+    std::array<u8, 256> unorm8_to_srgb8;
+    /// [k]: smallest value `linear_to_srgb8_exact` maps to k or above, [0] = 0 and [256] = +inf
+    std::array<f32, 257> srgb8_thresholds;
+};
+
+ConversionTables build_conversion_tables() noexcept {
+    ConversionTables tables{};
+    for (u32 i = 0; i < 256; ++i) {
+        const auto value = static_cast<u8>(i);
+        tables.unorm8_to_f32[i] = unorm8_to_float(value);
+        tables.srgb8_to_f32[i] = srgb_to_linear(unorm8_to_float(value));
+        tables.srgb8_to_unorm8[i] = srgb8_to_unorm8_exact(value);
+        tables.unorm8_to_srgb8[i] = unorm8_to_srgb8_exact(value);
+    }
+
+    // non-negative floats order like their bits, so each threshold is a bisection over [0, 1]
+    tables.srgb8_thresholds[0] = 0.0f;
+    for (u32 k = 1; k < 256; ++k) {
+        u32 low = 0;
+        u32 high = std::bit_cast<u32>(1.0f);
+        while (low < high) {
+            const u32 mid = low + (high - low) / 2;
+            if (linear_to_srgb8_exact(std::bit_cast<f32>(mid)) >= k) {
+                high = mid;
+            } else {
+                low = mid + 1;
+            }
+        }
+        tables.srgb8_thresholds[k] = std::bit_cast<f32>(low);
+    }
+    tables.srgb8_thresholds[256] = std::numeric_limits<f32>::infinity();
+    return tables;
+}
+
+const ConversionTables &conversion_tables() noexcept {
+    static const ConversionTables tables = build_conversion_tables();
+    return tables;
+}
+
+/// `linear_to_srgb8_exact` without `std::pow`: the rational approximation lands within one step
+/// of the result, one comparison against each neighbouring threshold settles it.
+u8 linear_to_srgb8(const ConversionTables &tables, f32 value) noexcept {
+    value = std::clamp(sanitize_scalar(value), 0.0f, 1.0f);
+    const f32 root = std::sqrt(value);
+    const f32 approx = value <= 0.0031308f
+                           ? value * 12.92f
+                           : ((k_srgb_num2 * root + k_srgb_num1) * root + k_srgb_num0) /
+                                 ((k_srgb_den2 * root + k_srgb_den1) * root + 1.0f);
+    const i32 guess = std::clamp(static_cast<i32>(approx * 255.0f + 0.5f), 0, 255);
+    const auto &thresholds = tables.srgb8_thresholds;
+    return static_cast<u8>(
+        guess + (value >= thresholds[guess + 1] ? 1 : 0) - (value < thresholds[guess] ? 1 : 0));
+}
+
+/// `float_to_unorm8(sanitize_scalar(src[i]))` for `count` floats.
+void quantize_unorm8(const f32 *src, u8 *dst, usize count) noexcept {
+    usize i = 0;
+#if LLC_SIMD_AVX2
+    const auto zero = _mm256_setzero_ps();
+    const auto one = _mm256_set1_ps(1.0f);
+    const auto scale = _mm256_set1_ps(255.0f);
+    const auto half = _mm256_set1_ps(0.5f);
+    for (; i + 8 <= count; i += 8) {
+        auto value = _mm256_loadu_ps(src + i);
+        // x - x is zero for finite x only
+        value = _mm256_and_ps(value, _mm256_cmp_ps(_mm256_sub_ps(value, value), zero, _CMP_EQ_OQ));
+        value = _mm256_min_ps(_mm256_max_ps(value, zero), one);
+        const auto code = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(value, scale), half));
+        const auto words = _mm_packus_epi32(_mm256_castsi256_si128(code), _mm256_extracti128_si256(code, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(words, words));
     }
+#elif LLC_SIMD_NEON
+    const auto zero = vdupq_n_f32(0.0f);
+    const auto one = vdupq_n_f32(1.0f);
+    const auto scale = vdupq_n_f32(255.0f);
+    const auto half = vdupq_n_f32(0.5f);
+    const auto quantize = [&](float32x4_t value) {
+        const auto finite = vceqq_f32(vsubq_f32(value, value), zero);
+        value = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(value), finite));
+        value = vminq_f32(vmaxq_f32(value, zero), one);
+        return vmovn_u32(vcvtq_u32_f32(vaddq_f32(vmulq_f32(value, scale), half)));
+    };
+    for (; i + 8 <= count; i += 8) {
+        const auto words = vcombine_u16(quantize(vld1q_f32(src + i)), quantize(vld1q_f32(src + i + 4)));
+        vst1_u8(dst + i, vmovn_u16(words));
+    }
+#endif
+    for (; i < count; ++i) dst[i] = float_to_unorm8(sanitize_scalar(src[i]));
 }
 
-void store_rgba8_from_linear_rgba(byte *dst, rhi::Format format, const f32 rgba[4]) noexcept {
-    const f32 alpha = sanitize_scalar(rgba[3]);
-    if (format == rhi::Format::RGBA8UnormSrgb) {
-        dst[0] = static_cast<byte>(float_to_unorm8(linear_to_srgb(sanitize_scalar(rgba[0]))));
-        dst[1] = static_cast<byte>(float_to_unorm8(linear_to_srgb(sanitize_scalar(rgba[1]))));
-        dst[2] = static_cast<byte>(float_to_unorm8(linear_to_srgb(sanitize_scalar(rgba[2]))));
+/// RGBA32F to RGBA8 sRGB for `count` pixels: colour through `linear_to_srgb8`, alpha linear.
+void encode_srgb8_rgba(const ConversionTables &tables, const f32 *src, u8 *dst, usize count) noexcept {
+    usize i = 0;
+#if LLC_SIMD_AVX2
+    const auto zero = _mm256_setzero_ps();
+    const auto one = _mm256_set1_ps(1.0f);
+    const auto scale = _mm256_set1_ps(255.0f);
+    const auto half = _mm256_set1_ps(0.5f);
+    const auto alpha = _mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1);
+    const auto *thresholds = tables.srgb8_thresholds.data();
+    for (; i + 2 <= count; i += 2) {
+        auto value = _mm256_loadu_ps(src + i * 4);
+        value = _mm256_and_ps(value, _mm256_cmp_ps(_mm256_sub_ps(value, value), zero, _CMP_EQ_OQ));
+        value = _mm256_min_ps(_mm256_max_ps(value, zero), one);
+
+        const auto root = _mm256_sqrt_ps(value);
+        const auto numerator = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(k_srgb_num2), root), _mm256_set1_ps(k_srgb_num1)), root),
+            _mm256_set1_ps(k_srgb_num0));
+        const auto denominator = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(k_srgb_den2), root), _mm256_set1_ps(k_srgb_den1)), root),
+            one);
+        const auto approx = _mm256_blendv_ps(
+            _mm256_div_ps(numerator, denominator),
+            _mm256_mul_ps(value, _mm256_set1_ps(12.92f)),
+            _mm256_cmp_ps(value, _mm256_set1_ps(0.0031308f), _CMP_LE_OQ));
+        auto guess = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(approx, scale), half));
+        guess = _mm256_min_epi32(_mm256_max_epi32(guess, _mm256_setzero_si256()), _mm256_set1_epi32(255));
+        const auto below = _mm256_i32gather_ps(thresholds, guess, 4);
+        const auto above = _mm256_i32gather_ps(thresholds + 1, guess, 4);
+        // comparison masks are -1 where true
+        auto code = _mm256_sub_epi32(guess, _mm256_castps_si256(_mm256_cmp_ps(value, above, _CMP_GE_OQ)));
+        code = _mm256_add_epi32(code, _mm256_castps_si256(_mm256_cmp_ps(value, below, _CMP_LT_OQ)));
+
+        const auto linear = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(value, scale), half));
+        code = _mm256_blendv_epi8(code, linear, alpha);
+        const auto words = _mm_packus_epi32(_mm256_castsi256_si128(code), _mm256_extracti128_si256(code, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + i * 4), _mm_packus_epi16(words, words));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i * 4 + 0] = linear_to_srgb8(tables, src[i * 4 + 0]);
+        dst[i * 4 + 1] = linear_to_srgb8(tables, src[i * 4 + 1]);
+        dst[i * 4 + 2] = linear_to_srgb8(tables, src[i * 4 + 2]);
+        dst[i * 4 + 3] = float_to_unorm8(sanitize_scalar(src[i * 4 + 3]));
+    }
+}
+
+/// Converts one row of `width` pixels; rows of different threads never overlap.
+using RowConverter = void (*)(
+    const ConversionTables &tables,
+    const byte *src,
+    byte *dst,
+    u32 width,
+    bool src_srgb,
+    bool dst_srgb) noexcept;
+
+void convert_row_rgba8_to_rgba8(const ConversionTables &tables, const byte *src, byte *dst, u32 width, bool src_srgb, bool) noexcept {
+    const auto &table = src_srgb ? tables.srgb8_to_unorm8 : tables.unorm8_to_srgb8;
+    const auto *in = reinterpret_cast<const u8 *>(src);
+    auto *out = reinterpret_cast<u8 *>(dst);
+    for (usize x = 0; x < width; ++x) {
+        out[x * 4 + 0] = table[in[x * 4 + 0]];
+        out[x * 4 + 1] = table[in[x * 4 + 1]];
+        out[x * 4 + 2] = table[in[x * 4 + 2]];
+        out[x * 4 + 3] = in[x * 4 + 3];
+    }
+}
+
+void convert_row_rgba8_to_rgba32f(const ConversionTables &tables, const byte *src, byte *dst, u32 width, bool src_srgb, bool) noexcept {
+    const auto &color = src_srgb ? tables.srgb8_to_f32 : tables.unorm8_to_f32;
+    const auto *in = reinterpret_cast<const u8 *>(src);
+    auto *out = reinterpret_cast<f32 *>(dst);
+    for (usize x = 0; x < width; ++x) {
+        out[x * 4 + 0] = color[in[x * 4 + 0]];
+        out[x * 4 + 1] = color[in[x * 4 + 1]];
+        out[x * 4 + 2] = color[in[x * 4 + 2]];
+        out[x * 4 + 3] = tables.unorm8_to_f32[in[x * 4 + 3]];
+    }
+}
+
+void convert_row_rgba32f_to_rgba8(const ConversionTables &tables, const byte *src, byte *dst, u32 width, bool, bool dst_srgb) noexcept {
+    const auto *in = reinterpret_cast<const f32 *>(src);
+    auto *out = reinterpret_cast<u8 *>(dst);
+    if (dst_srgb) {
+        encode_srgb8_rgba(tables, in, out, width);
     } else {
-        dst[0] = static_cast<byte>(float_to_unorm8(sanitize_scalar(rgba[0])));
-        dst[1] = static_cast<byte>(float_to_unorm8(sanitize_scalar(rgba[1])));
-        dst[2] = static_cast<byte>(float_to_unorm8(sanitize_scalar(rgba[2])));
+        quantize_unorm8(in, out, static_cast<usize>(width) * 4);
     }
-    dst[3] = static_cast<byte>(float_to_unorm8(alpha));
+}
+
+void convert_row_r8_to_r32f(const ConversionTables &tables, const byte *src, byte *dst, u32 width, bool, bool) noexcept {
+    const auto *in = reinterpret_cast<const u8 *>(src);
+    auto *out = reinterpret_cast<f32 *>(dst);
+    for (usize x = 0; x < width; ++x) out[x] = tables.unorm8_to_f32[in[x]];
+}
+
+void convert_row_r32f_to_r8(const ConversionTables &, const byte *src, byte *dst, u32 width, bool, bool) noexcept {
+    quantize_unorm8(reinterpret_cast<const f32 *>(src), reinterpret_cast<u8 *>(dst), width);
+}
+
+void convert_row_r32f_to_rgba8(const ConversionTables &tables, const byte *src, byte *dst, u32 width, bool, bool dst_srgb) noexcept {
+    const auto *in = reinterpret_cast<const f32 *>(src);
+    auto *out = reinterpret_cast<u8 *>(dst);
+    for (usize x = 0; x < width; ++x) {
+        const u8 value = dst_srgb ? linear_to_srgb8(tables, in[x]) : float_to_unorm8(sanitize_scalar(in[x]));
+        out[x * 4 + 0] = value;
+        out[x * 4 + 1] = value;
+        out[x * 4 + 2] = value;
+        out[x * 4 + 3] = 255;
+    }
+}
+
+void convert_row_r32f_to_rgba32f(const ConversionTables &, const byte *src, byte *dst, u32 width, bool, bool) noexcept {
+    const auto *in = reinterpret_cast<const f32 *>(src);
+    auto *out = reinterpret_cast<f32 *>(dst);
+    for (usize x = 0; x < width; ++x) {
+        const f32 value = sanitize_scalar(in[x]);
+        out[x * 4 + 0] = value;
+        out[x * 4 + 1] = value;
+        out[x * 4 + 2] = value;
+        out[x * 4 + 3] = 1.0f;
+    }
+}
+
+/// Row converter from `src` to `dst`, nullptr if the pair is not supported.
+RowConverter row_converter(rhi::Format src, rhi::Format dst) noexcept {
+    const bool src_rgba8 = is_rgba8_format(src);
+    const bool dst_rgba8 = is_rgba8_format(dst);
+    if (src_rgba8 && dst_rgba8) return convert_row_rgba8_to_rgba8;
+    if (src_rgba8 && dst == rhi::Format::RGBA32Float) return convert_row_rgba8_to_rgba32f;
+    if (src == rhi::Format::RGBA32Float && dst_rgba8) return convert_row_rgba32f_to_rgba8;
+    if (src == rhi::Format::R8Unorm && dst == rhi::Format::R32Float) return convert_row_r8_to_r32f;
+    if (src == rhi::Format::R32Float && dst == rhi::Format::R8Unorm) return convert_row_r32f_to_r8;
+    if (src == rhi::Format::R32Float && dst_rgba8) return convert_row_r32f_to_rgba8;
+    if (src == rhi::Format::R32Float && dst == rhi::Format::RGBA32Float) return convert_row_r32f_to_rgba32f;
+    return nullptr;
+}
+
+/// How a format stores its channels, for conversions without a row converter of their own.
+enum class ChannelEncoding : u8 {
+    UNORM8,
+    SRGB8,
+    UNORM16,
+    FLOAT16,
+    FLOAT32,
+};
+
+struct PixelLayout final {
+    ChannelEncoding encoding;
+    u32 channel_count;
+};
+
+std::optional<PixelLayout> pixel_layout(rhi::Format format) noexcept {
+    switch (format) {
+        case rhi::Format::R8Unorm:
+            return PixelLayout{ChannelEncoding::UNORM8, 1};
+        case rhi::Format::RG8Unorm:
+            return PixelLayout{ChannelEncoding::UNORM8, 2};
+        case rhi::Format::RGBA8Unorm:
+            return PixelLayout{ChannelEncoding::UNORM8, 4};
+        case rhi::Format::RGBA8UnormSrgb:
+            return PixelLayout{ChannelEncoding::SRGB8, 4};
+        case rhi::Format::R16Unorm:
+            return PixelLayout{ChannelEncoding::UNORM16, 1};
+        case rhi::Format::RG16Unorm:
+            return PixelLayout{ChannelEncoding::UNORM16, 2};
+        case rhi::Format::RGBA16Unorm:
+            return PixelLayout{ChannelEncoding::UNORM16, 4};
+        case rhi::Format::R16Float:
+            return PixelLayout{ChannelEncoding::FLOAT16, 1};
+        case rhi::Format::RG16Float:
+            return PixelLayout{ChannelEncoding::FLOAT16, 2};
+        case rhi::Format::RGBA16Float:
+            return PixelLayout{ChannelEncoding::FLOAT16, 4};
+        case rhi::Format::R32Float:
+            return PixelLayout{ChannelEncoding::FLOAT32, 1};
+        case rhi::Format::RG32Float:
+            return PixelLayout{ChannelEncoding::FLOAT32, 2};
+        case rhi::Format::RGBA32Float:
+            return PixelLayout{ChannelEncoding::FLOAT32, 4};
+        default:
+            return std::nullopt;
+    }
+}
+
+/// Decodes `count` channels to f32. Float channels keep non-finite values, sRGB decodes colour only.
+void decode_channels(const ConversionTables &tables, PixelLayout layout, const byte *src, f32 *dst, usize count) noexcept {
+    switch (layout.encoding) {
+        case ChannelEncoding::UNORM8: {
+            const auto *in = reinterpret_cast<const u8 *>(src);
+            for (usize i = 0; i < count; ++i) dst[i] = tables.unorm8_to_f32[in[i]];
+            break;
+        }
+        case ChannelEncoding::SRGB8: {
+            const auto *in = reinterpret_cast<const u8 *>(src);
+            for (usize i = 0; i < count; ++i) {
+                dst[i] = i % 4 == 3 ? tables.unorm8_to_f32[in[i]] : tables.srgb8_to_f32[in[i]];
+            }
+            break;
+        }
+        case ChannelEncoding::UNORM16: {
+            const auto *in = reinterpret_cast<const u16 *>(src);
+            for (usize i = 0; i < count; ++i) dst[i] = unorm16_to_float(in[i]);
+            break;
+        }
+        case ChannelEncoding::FLOAT16:
+            convert_f16_to_f32(std::span<const f16>(reinterpret_cast<const f16 *>(src), count), std::span<f32>(dst, count));
+            break;
+        case ChannelEncoding::FLOAT32:
+            std::memcpy(dst, src, count * sizeof(f32));
+            break;
+    }
+}
+
+/// Encodes `count` f32 channels. Normalized channels are clamped and take 0 for non-finite values.
+void encode_channels(const ConversionTables &tables, PixelLayout layout, const f32 *src, byte *dst, usize count) noexcept {
+    switch (layout.encoding) {
+        case ChannelEncoding::UNORM8:
+            quantize_unorm8(src, reinterpret_cast<u8 *>(dst), count);
+            break;
+        case ChannelEncoding::SRGB8:
+            encode_srgb8_rgba(tables, src, reinterpret_cast<u8 *>(dst), count / 4);
+            break;
+        case ChannelEncoding::UNORM16: {
+            auto *out = reinterpret_cast<u16 *>(dst);
+            for (usize i = 0; i < count; ++i) out[i] = float_to_unorm16(sanitize_scalar(src[i]));
+            break;
+        }
+        case ChannelEncoding::FLOAT16:
+            convert_f32_to_f16(std::span<const f32>(src, count), std::span<f16>(reinterpret_cast<f16 *>(dst), count));
+            break;
+        case ChannelEncoding::FLOAT32:
+            std::memcpy(dst, src, count * sizeof(f32));
+            break;
+    }
+}
+
+/// Whether `convert_row_through_f32` converts `src` to `dst`: the same channels, or one channel
+/// replicated to RGB with opaque alpha.
+bool converts_through_f32(PixelLayout src, PixelLayout dst) noexcept {
+    return src.channel_count == dst.channel_count || (src.channel_count == 1 && dst.channel_count == 4);
+}
+
+/// Converts one row of `width` pixels by way of `scratch`, room for `width` RGBA f32 pixels.
+void convert_row_through_f32(
+    const ConversionTables &tables,
+    PixelLayout src_layout,
+    PixelLayout dst_layout,
+    const byte *src,
+    byte *dst,
+    u32 width,
+    f32 *scratch) noexcept {
+
+    const usize src_count = static_cast<usize>(width) * src_layout.channel_count;
+    const bool replicate = src_layout.channel_count != dst_layout.channel_count;
+    if (!replicate && dst_layout.encoding == ChannelEncoding::FLOAT32) {
+        decode_channels(tables, src_layout, src, reinterpret_cast<f32 *>(dst), src_count);
+        return;
+    }
+
+    decode_channels(tables, src_layout, src, scratch, src_count);
+    if (replicate) {
+        // back to front, so every value is read before its pixel overwrites it
+        for (usize x = width; x-- > 0;) {
+            const f32 value = scratch[x];
+            scratch[x * 4 + 0] = value;
+            scratch[x * 4 + 1] = value;
+            scratch[x * 4 + 2] = value;
+            scratch[x * 4 + 3] = 1.0f;
+        }
+    }
+    encode_channels(tables, dst_layout, scratch, dst, static_cast<usize>(width) * dst_layout.channel_count);
+}
+
+/// Whether `convert_rows` converts pixels of `src` to `dst`.
+bool converts(rhi::Format src, rhi::Format dst) noexcept {
+    if (src == dst) return bytes_per_pixel(src) > 0;
+    if (row_converter(src, dst)) return true;
+    const auto src_layout = pixel_layout(src);
+    const auto dst_layout = pixel_layout(dst);
+    return src_layout && dst_layout && converts_through_f32(*src_layout, *dst_layout);
+}
+
+/// Fills `dst` from rows of `src_format` `src_pitch` bytes apart, on all hardware threads for large
+/// images; rows of the same format are copied. `converts(src_format, dst.format)` must hold.
+void convert_rows(const byte *src, usize src_pitch, rhi::Format src_format, Image &dst) {
+    const auto convert_row = row_converter(src_format, dst.format);
+    const auto src_layout = pixel_layout(src_format);
+    const auto dst_layout = pixel_layout(dst.format);
+    const bool copy = src_format == dst.format;
+    const bool through_f32 = !copy && !convert_row;
+    const usize row_size = static_cast<usize>(dst.width) * bytes_per_pixel(dst.format);
+
+    const auto &tables = conversion_tables();
+    const bool src_srgb = src_format == rhi::Format::RGBA8UnormSrgb;
+    const bool dst_srgb = dst.format == rhi::Format::RGBA8UnormSrgb;
+    const usize min_rows = std::max<usize>(1, k_min_pixels_per_thread / dst.width);
+    parallel_for_chunks(dst.height, parallel_chunk_count(dst.height, min_rows), [&](usize begin, usize end, u32) {
+        std::vector<f32> scratch(through_f32 ? static_cast<usize>(dst.width) * 4 : 0);
+        for (usize y = begin; y < end; ++y) {
+            const auto *src_row = src + y * src_pitch;
+            auto *dst_row = dst.row_data(static_cast<u32>(y));
+            if (copy) {
+                std::memcpy(dst_row, src_row, row_size);
+            } else if (through_f32) {
+                convert_row_through_f32(tables, *src_layout, *dst_layout, src_row, dst_row, dst.width, scratch.data());
+            } else {
+                convert_row(tables, src_row, dst_row, dst.width, src_srgb, dst_srgb);
+            }
+        }
+    });
 }
 
 } // namespace
@@ -84,6 +518,15 @@ usize bytes_per_pixel(rhi::Format format) noexcept {
         case rhi::Format::RGBA8Unorm:
         case rhi::Format::RGBA8UnormSrgb:
             return 4;
+        case rhi::Format::R16Float:
+        case rhi::Format::R16Unorm:
+            return 2;
+        case rhi::Format::RG16Float:
+        case rhi::Format::RG16Unorm:
+            return 4;
+        case rhi::Format::RGBA16Float:
+        case rhi::Format::RGBA16Unorm:
+            return 8;
         case rhi::Format::R32Float:
             return 4;
         case rhi::Format::RG32Float:
@@ -103,24 +546,7 @@ Image convert_image(const Image &image, rhi::Format format) {
         return clone;
     }
 
-    const bool src_rgba8 = is_rgba8_format(image.format);
-    const bool dst_rgba8 = is_rgba8_format(format);
-    const bool src_r8 = image.format == rhi::Format::R8Unorm;
-    const bool dst_r8 = format == rhi::Format::R8Unorm;
-    const bool src_r32f = image.format == rhi::Format::R32Float;
-    const bool dst_r32f = format == rhi::Format::R32Float;
-    const bool src_rgba32f = image.format == rhi::Format::RGBA32Float;
-    const bool dst_rgba32f = format == rhi::Format::RGBA32Float;
-    const bool supported =
-        (src_rgba8 && dst_rgba8) ||
-        (src_rgba8 && dst_rgba32f) ||
-        (src_rgba32f && dst_rgba8) ||
-        (src_rgba32f && dst_rgba32f) ||
-        (src_r8 && dst_r32f) ||
-        (src_r32f && dst_r8) ||
-        (src_r32f && dst_rgba8) ||
-        (src_r32f && dst_rgba32f);
-    if (!supported) {
+    if (!converts(image.format, format)) {
         return {};
     }
 
@@ -129,91 +555,76 @@ Image convert_image(const Image &image, rhi::Format format) {
         image.height,
         format,
         static_cast<usize>(image.width) * bytes_per_pixel(format));
+    convert_rows(image.data(), image.row_pitch, image.format, converted);
+    return converted;
+}
 
-    for (u32 y = 0; y < image.height; ++y) {
-        const auto *src_row = image.row_data(y);
-        auto *dst_row = converted.row_data(y);
-        for (u32 x = 0; x < image.width; ++x) {
-            if (src_r8 && dst_r32f) {
-                const auto *src = src_row + static_cast<usize>(x);
-                auto *dst = reinterpret_cast<f32 *>(dst_row + static_cast<usize>(x) * sizeof(f32));
-                dst[0] = unorm8_to_float(static_cast<u8>(src[0]));
-                continue;
-            }
-
-            if (src_r32f && dst_r8) {
-                const auto *src = reinterpret_cast<const f32 *>(src_row + static_cast<usize>(x) * sizeof(f32));
-                auto *dst = dst_row + static_cast<usize>(x);
-                dst[0] = static_cast<byte>(float_to_unorm8(sanitize_scalar(src[0])));
-                continue;
-            }
+usize aligned_row_pitch(u32 width, rhi::Format format) noexcept {
+    const usize row_size = static_cast<usize>(width) * bytes_per_pixel(format);
+    return (row_size + k_image_row_alignment - 1) / k_image_row_alignment * k_image_row_alignment;
+}
 
-            if (src_r32f && dst_rgba8) {
-                const auto *src = reinterpret_cast<const f32 *>(src_row + static_cast<usize>(x) * sizeof(f32));
-                const f32 value = sanitize_scalar(src[0]);
-                const f32 rgba[4] = {value, value, value, 1.0f};
-                auto *dst = dst_row + static_cast<usize>(x) * 4;
-                store_rgba8_from_linear_rgba(dst, format, rgba);
-                continue;
-            }
+Image decode_image(std::span<const byte> encoded, rhi::Format format) {
+    if (encoded.empty() || encoded.size() > static_cast<usize>(INT_MAX)) return {};
+    const auto *data = reinterpret_cast<const stbi_uc *>(encoded.data());
+    const auto size = static_cast<i32>(encoded.size());
 
-            if (src_r32f && dst_rgba32f) {
-                const auto *src = reinterpret_cast<const f32 *>(src_row + static_cast<usize>(x) * sizeof(f32));
-                const f32 value = sanitize_scalar(src[0]);
-                auto *dst = reinterpret_cast<f32 *>(dst_row + static_cast<usize>(x) * 4 * sizeof(f32));
-                dst[0] = value;
-                dst[1] = value;
-                dst[2] = value;
-                dst[3] = 1.0f;
-                continue;
-            }
+    i32 width = 0;
+    i32 height = 0;
+    i32 channels = 0;
+    if (!stbi_info_from_memory(data, size, &width, &height, &channels)) return {};
 
-            f32 rgba[4]{};
-            if (src_rgba8) {
-                const auto *src = src_row + static_cast<usize>(x) * 4;
-                load_rgba_from_rgba8(src, image.format, rgba);
-            } else {
-                const auto *src = reinterpret_cast<const f32 *>(src_row + static_cast<usize>(x) * 4 * sizeof(f32));
-                rgba[0] = sanitize_scalar(src[0]);
-                rgba[1] = sanitize_scalar(src[1]);
-                rgba[2] = sanitize_scalar(src[2]);
-                rgba[3] = sanitize_scalar(src[3]);
-            }
+    // gray stays one channel unless a wider format is asked for, anything else decodes to RGBA
+    const auto requested = pixel_layout(format);
+    const bool gray = requested ? requested->channel_count == 1 : channels == 1;
+    const i32 components = gray ? 1 : 4;
+    const bool hdr = stbi_is_hdr_from_memory(data, size) != 0;
+    const bool wide = !hdr && stbi_is_16_bit_from_memory(data, size) != 0;
 
-            if (dst_rgba8) {
-                auto *dst = dst_row + static_cast<usize>(x) * 4;
-                store_rgba8_from_linear_rgba(dst, format, rgba);
-            } else {
-                auto *dst = reinterpret_cast<f32 *>(dst_row + static_cast<usize>(x) * 4 * sizeof(f32));
-                dst[0] = rgba[0];
-                dst[1] = rgba[1];
-                dst[2] = rgba[2];
-                dst[3] = rgba[3];
-            }
-        }
+    rhi::Format decoded_format = gray ? rhi::Format::R8Unorm : rhi::Format::RGBA8Unorm;
+    void *pixels = nullptr;
+    if (hdr) {
+        decoded_format = gray ? rhi::Format::R32Float : rhi::Format::RGBA32Float;
+        pixels = stbi_loadf_from_memory(data, size, &width, &height, &channels, components);
+    } else if (wide) {
+        decoded_format = gray ? rhi::Format::R16Unorm : rhi::Format::RGBA16Unorm;
+        pixels = stbi_load_16_from_memory(data, size, &width, &height, &channels, components);
+    } else {
+        // 8-bit colour is sRGB-encoded as a rule, so asking for sRGB only relabels it
+        if (format == rhi::Format::RGBA8UnormSrgb) decoded_format = format;
+        pixels = stbi_load_from_memory(data, size, &width, &height, &channels, components);
     }
+    if (!pixels) return {};
 
-    return converted;
-}
-
-bool write_image_png(const std::filesystem::path &path, const Image &image) {
-    if (!image) return false;
-
-    if (image.format == rhi::Format::R32Float) {
-        auto converted = convert_image(image, rhi::Format::RGBA8Unorm);
-        if (!converted) return false;
-        return write_image_png(path, converted);
+    const auto target_format = format == rhi::Format::Undefined ? decoded_format : format;
+    // 16-bit colour is sRGB-encoded as well: quantized as unorm and relabelled, not encoded again
+    const auto convert_format =
+        wide && target_format == rhi::Format::RGBA8UnormSrgb ? rhi::Format::RGBA8Unorm : target_format;
+    Image image;
+    if (converts(decoded_format, convert_format)) {
+        image = Image(
+            static_cast<u32>(width),
+            static_cast<u32>(height),
+            convert_format,
+            aligned_row_pitch(static_cast<u32>(width), convert_format));
+        const usize decoded_pitch = static_cast<usize>(width) * bytes_per_pixel(decoded_format);
+        convert_rows(static_cast<const byte *>(pixels), decoded_pitch, decoded_format, image);
+        image.format = target_format;
     }
+    stbi_image_free(pixels);
+    return image;
+}
 
-    if (image.format != rhi::Format::RGBA8Unorm) return false;
+Image load_image(const std::filesystem::path &path, rhi::Format format) {
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    if (!stream) return {};
+    const auto size = static_cast<std::streamoff>(stream.tellg());
+    if (size <= 0) return {};
 
-    return stbi_write_png(
-               path.string().c_str(),
-               static_cast<i32>(image.width),
-               static_cast<i32>(image.height),
-               4,
-               image.data(),
-               static_cast<i32>(image.row_pitch)) != 0;
+    std::vector<byte> encoded(static_cast<usize>(size));
+    stream.seekg(0);
+    if (!stream.read(reinterpret_cast<char *>(encoded.data()), size)) return {};
+    return decode_image(encoded, format);
 }
 
 } // namespace llc
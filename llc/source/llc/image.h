@@ -6,6 +6,8 @@
 #include <filesystem>
 #include <mdspan/mdspan.hpp>
 #include <memory>
+#include <span>
+#include <vector>
 
 #include <slang-rhi.h>
 
@@ -13,7 +15,13 @@
 
 namespace llc {
 
+/// Row alignment of decoded images: the strictest row pitch among the backends' copies between
+/// buffers and textures, so uploads can take them as they are.
+constexpr usize k_image_row_alignment = 256;
+
 usize bytes_per_pixel(rhi::Format format) noexcept;
+/// Bytes of a row of `width` pixels, rounded up to `k_image_row_alignment`.
+usize aligned_row_pitch(u32 width, rhi::Format format) noexcept;
 
 struct Image final {
     u32 width = 0;
@@ -75,7 +83,35 @@ struct Image final {
     }
 };
 
+/// `image` in `format`, tightly packed; an empty image if the formats do not convert. 8-bit, 16-bit
+/// unorm and float formats convert into each other with the same channel count, and single-channel
+/// ones into RGBA as gray with opaque alpha. sRGB is decoded to linear, alpha never is.
 Image convert_image(const Image &image, rhi::Format format);
+
+/// Decodes a PNG, JPEG, Radiance HDR or other file stb_image reads, with rows `aligned_row_pitch`
+/// apart. Gray files decode to one channel and everything else to RGBA: 8-bit files as unorm,
+/// 16-bit PNGs as `RGBA16Unorm` and HDR as `RGBA32Float`. A set `format` is converted to while the
+/// pixels leave the decoder; `RGBA8UnormSrgb` only relabels 8-bit data, which is sRGB-encoded as a
+/// rule, and quantizes 16-bit data, which is encoded the same way. Returns an empty image if the
+/// file cannot be read, decoded or converted.
+Image load_image(const std::filesystem::path &path, rhi::Format format = rhi::Format::Undefined);
+/// `load_image` of a file already in memory.
+Image decode_image(std::span<const byte> encoded, rhi::Format format = rhi::Format::Undefined);
+
+/// PNG of `image`: 8 and 16-bit unorm gray and RGBA as they are, other formats converted to
+/// `RGBA8Unorm`. Rows are filtered and deflated in pieces of a fixed size on all hardware threads;
+/// each piece is its own IDAT chunk holding deflate blocks that match only within it. Empty if the
+/// image has no PNG encoding.
+std::vector<byte> encode_png(const Image &image);
+/// QOI of `image` converted to `RGBA8Unorm`, or tagged sRGB if it is `RGBA8UnormSrgb`. QOI runs
+/// in a single pass that cannot be split, but in several times less time than PNG.
+std::vector<byte> encode_qoi(const Image &image);
+/// PFM of `image` converted to `R32Float` if it has one channel and to `RGBA32Float` otherwise,
+/// without alpha, which PFM cannot hold. The floats are copied as they are, in native byte order.
+std::vector<byte> encode_pfm(const Image &image);
+
 bool write_image_png(const std::filesystem::path &path, const Image &image);
+bool write_image_qoi(const std::filesystem::path &path, const Image &image);
+bool write_image_pfm(const std::filesystem::path &path, const Image &image);
 
 } // namespace llc
@@ -0,0 +1,92 @@
+#include "image_async.h"
+
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <llc/async/io/fs.h>
+#include <llc/async/io/request.h>
+
+namespace llc {
+
+namespace {
+
+/// libuv takes UTF-8 paths on every platform.
+std::string utf8_path(const std::filesystem::path &path) {
+    const auto utf8 = path.u8string();
+    return std::string(reinterpret_cast<const char *>(utf8.data()), utf8.size());
+}
+
+Task<void, Error> write_file(std::filesystem::path path, std::span<const byte> data, EventLoop &loop) {
+    const auto fd = co_await fs::open(utf8_path(path), UV_FS_O_WRONLY | UV_FS_O_CREAT | UV_FS_O_TRUNC, 0644, loop)
+                        .or_fail();
+    std::optional<Error> error;
+    usize size = 0;
+    while (size < data.size()) {
+        const auto chunk = std::span(reinterpret_cast<const char *>(data.data()) + size, data.size() - size);
+        auto written = co_await fs::write(fd, chunk, static_cast<i64>(size), loop);
+        if (written.has_error()) {
+            error = written.error();
+            break;
+        }
+        size += *written;
+    }
+    co_await fs::close(fd, loop);
+    if (error) co_await fail(*error);
+}
+
+template <typename Encode>
+Task<void, Error> encode_and_write(std::filesystem::path path, Encode encode, EventLoop &loop) {
+    const auto encoded = co_await queue(std::move(encode), loop).or_fail();
+    if (encoded.empty()) co_await fail(Error::k_invalid_argument);
+    co_await write_file(std::move(path), encoded, loop).or_fail();
+}
+
+} // namespace
+
+Task<Image, Error> load_image_async(std::filesystem::path path, rhi::Format format, EventLoop &loop) {
+    const auto fd = co_await fs::open(utf8_path(path), UV_FS_O_RDONLY, 0, loop).or_fail();
+
+    // the descriptor is closed on every path, errors propagate once it is
+    std::vector<byte> encoded;
+    std::optional<Error> error;
+    auto stats = co_await fs::fstat(fd, loop);
+    if (stats.has_error()) {
+        error = stats.error();
+    } else {
+        encoded.resize(static_cast<usize>(stats->size));
+        usize size = 0;
+        while (size < encoded.size()) {
+            auto chunk = std::span(reinterpret_cast<char *>(encoded.data()) + size, encoded.size() - size);
+            auto read = co_await fs::read(fd, chunk, static_cast<i64>(size), loop);
+            if (read.has_error()) {
+                error = read.error();
+                break;
+            }
+            if (*read == 0) break;
+            size += *read;
+        }
+        encoded.resize(size);
+    }
+    co_await fs::close(fd, loop);
+    if (error) co_await fail(*error);
+
+    auto image = co_await queue([&] { return decode_image(encoded, format); }, loop).or_fail();
+    if (!image) co_await fail(Error::k_inappropriate_file_type_or_format);
+    co_return std::move(image);
+}
+
+Task<void, Error> write_image_png_async(std::filesystem::path path, const Image &image, EventLoop &loop) {
+    return encode_and_write(std::move(path), [&image] { return encode_png(image); }, loop);
+}
+
+Task<void, Error> write_image_qoi_async(std::filesystem::path path, const Image &image, EventLoop &loop) {
+    return encode_and_write(std::move(path), [&image] { return encode_qoi(image); }, loop);
+}
+
+Task<void, Error> write_image_pfm_async(std::filesystem::path path, const Image &image, EventLoop &loop) {
+    return encode_and_write(std::move(path), [&image] { return encode_pfm(image); }, loop);
+}
+
+} // namespace llc
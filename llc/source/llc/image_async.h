@@ -0,0 +1,40 @@
+#pragma once
+
+#include <filesystem>
+
+#include <slang-rhi.h>
+
+#include <llc/async/io/loop.h>
+#include <llc/async/runtime/task.h>
+#include <llc/async/vocab/error.h>
+#include <llc/image.h>
+
+namespace llc {
+
+/// `load_image` that reads the file through the loop and decodes it on libuv's worker pool, so
+/// several images load at once without blocking the loop. Fails with
+/// `Error::k_inappropriate_file_type_or_format` if the file does not decode to `format`.
+Task<Image, Error> load_image_async(
+    std::filesystem::path path,
+    rhi::Format format = rhi::Format::Undefined,
+    EventLoop &loop = EventLoop::current());
+
+/// `write_image_png` that encodes on libuv's worker pool and writes the file through the loop.
+/// `image` must outlive the task. Fails with `Error::k_invalid_argument` if the image has no
+/// encoding.
+Task<void, Error> write_image_png_async(
+    std::filesystem::path path,
+    const Image &image,
+    EventLoop &loop = EventLoop::current());
+/// `write_image_qoi` the way `write_image_png_async` writes PNG.
+Task<void, Error> write_image_qoi_async(
+    std::filesystem::path path,
+    const Image &image,
+    EventLoop &loop = EventLoop::current());
+/// `write_image_pfm` the way `write_image_png_async` writes PNG.
+Task<void, Error> write_image_pfm_async(
+    std::filesystem::path path,
+    const Image &image,
+    EventLoop &loop = EventLoop::current());
+
+} // namespace llc
@@ -0,0 +1,588 @@
+#include "image.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <llc/scalar_types.hpp>
+#include <llc/utils/parallel.h>
+
+namespace llc {
+
+namespace {
+
+/// Filtered bytes per deflate piece. Pieces are cut by size rather than by thread count so the
+/// file is the same on every machine; each one loses the matches into the piece before it.
+constexpr usize k_png_piece_bytes = 1 << 18;
+constexpr usize k_deflate_window = 32768;
+constexpr u32 k_deflate_hash_bits = 15;
+/// candidates the matcher tries per position, about what stb_image_write does at its default level
+constexpr u32 k_deflate_max_chain = 16;
+constexpr usize k_deflate_min_match = 3;
+constexpr usize k_deflate_max_match = 258;
+
+constexpr std::array<u16, 29> k_length_base{
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr std::array<u8, 29> k_length_extra{
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr std::array<u16, 30> k_distance_base{
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+    193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr std::array<u8, 30> k_distance_extra{
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+/// Bit-reversed fixed Huffman code, ready to go out least significant bit first.
+struct FixedCode final {
+    u16 bits = 0;
+    u8 length = 0;
+};
+
+constexpr FixedCode reversed_code(u32 code, u8 length) {
+    u32 reversed = 0;
+    for (u32 i = 0; i < length; ++i, code >>= 1) reversed = reversed << 1 | (code & 1);
+    return FixedCode{static_cast<u16>(reversed), length};
+}
+
+/// Literal and length symbols of the fixed Huffman code.
+constexpr std::array<FixedCode, 288> k_fixed_symbol_codes = [] {
+    std::array<FixedCode, 288> codes{};
+    for (u32 symbol = 0; symbol < 288; ++symbol) {
+        if (symbol <= 143) {
+            codes[symbol] = reversed_code(0x30 + symbol, 8);
+        } else if (symbol <= 255) {
+            codes[symbol] = reversed_code(0x190 + symbol - 144, 9);
+        } else if (symbol <= 279) {
+            codes[symbol] = reversed_code(symbol - 256, 7);
+        } else {
+            codes[symbol] = reversed_code(0xc0 + symbol - 280, 8);
+        }
+    }
+    return codes;
+}();
+
+/// Length code of every match length.
+constexpr std::array<u8, k_deflate_max_match + 1> k_length_codes = [] {
+    std::array<u8, k_deflate_max_match + 1> codes{};
+    for (u8 code = 0; code < k_length_base.size(); ++code) {
+        const usize end = code + 1u < k_length_base.size() ? k_length_base[code + 1] : k_deflate_max_match + 1;
+        for (usize length = k_length_base[code]; length < end; ++length) codes[length] = code;
+    }
+    return codes;
+}();
+
+/// Distance code of `distance - 1` below 256 and of `256 + ((distance - 1) >> 7)` above, as zlib
+/// keeps them; every code above 256 spans a multiple of 128 distances.
+constexpr std::array<u8, 512> k_distance_codes = [] {
+    std::array<u8, 512> codes{};
+    for (u8 code = 0; code < k_distance_base.size(); ++code) {
+        const usize first = k_distance_base[code];
+        const usize end = first + (usize{1} << k_distance_extra[code]);
+        for (usize distance = first; distance < end; ++distance) {
+            codes[distance <= 256 ? distance - 1 : 256 + ((distance - 1) >> 7)] = code;
+        }
+    }
+    return codes;
+}();
+
+constexpr std::array<u8, 8> k_png_signature{0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a};
+
+constexpr std::array<u32, 256> k_crc_table = [] {
+    std::array<u32, 256> table{};
+    for (u32 n = 0; n < 256; ++n) {
+        u32 c = n;
+        for (u32 k = 0; k < 8; ++k) c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        table[n] = c;
+    }
+    return table;
+}();
+
+u32 crc32(std::span<const byte> data, u32 crc = 0) noexcept {
+    crc = ~crc;
+    for (const auto value : data) crc = k_crc_table[(crc ^ std::to_integer<u32>(value)) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+constexpr u32 k_adler_base = 65521;
+
+u32 adler32(std::span<const u8> data) noexcept {
+    u32 a = 1;
+    u32 b = 0;
+    // 5552 bytes is the most that cannot overflow `b` between reductions
+    for (usize begin = 0; begin < data.size(); begin += 5552) {
+        const usize end = std::min(data.size(), begin + 5552);
+        for (usize i = begin; i < end; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= k_adler_base;
+        b %= k_adler_base;
+    }
+    return b << 16 | a;
+}
+
+/// Adler-32 of two blocks back to back, from their own checksums and the length of the second.
+u32 adler32_combine(u32 first, u32 second, usize second_size) noexcept {
+    const u64 rem = second_size % k_adler_base;
+    u64 sum1 = first & 0xffff;
+    u64 sum2 = rem * sum1 % k_adler_base;
+    sum1 += (second & 0xffff) + k_adler_base - 1;
+    sum2 += (first >> 16) + (second >> 16) + k_adler_base - rem;
+    if (sum1 >= k_adler_base) sum1 -= k_adler_base;
+    if (sum1 >= k_adler_base) sum1 -= k_adler_base;
+    if (sum2 >= 2 * k_adler_base) sum2 -= 2 * k_adler_base;
+    if (sum2 >= k_adler_base) sum2 -= k_adler_base;
+    return static_cast<u32>(sum2 << 16 | sum1);
+}
+
+void append_u32_be(std::vector<byte> &out, u32 value) {
+    for (i32 shift = 24; shift >= 0; shift -= 8) out.push_back(static_cast<byte>(value >> shift));
+}
+
+void append_bytes(std::vector<byte> &out, std::string_view text) {
+    for (const char c : text) out.push_back(static_cast<byte>(c));
+}
+
+/// Deflate bits, least significant first.
+struct BitWriter final {
+    std::vector<byte> &out;
+    u64 bits = 0;
+    u32 count = 0;
+
+    void put(u32 value, u32 length) {
+        bits |= static_cast<u64>(value) << count;
+        count += length;
+        while (count >= 8) {
+            out.push_back(static_cast<byte>(bits & 0xff));
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    void put(const FixedCode &code) {
+        put(code.bits, code.length);
+    }
+
+    void align() {
+        if (count > 0) put(0, 8 - count);
+    }
+};
+
+void put_fixed_match(BitWriter &writer, usize length, usize distance) {
+    const u32 length_code = k_length_codes[length];
+    writer.put(k_fixed_symbol_codes[257 + length_code]);
+    writer.put(static_cast<u32>(length - k_length_base[length_code]), k_length_extra[length_code]);
+
+    const u32 distance_code = k_distance_codes[distance <= 256 ? distance - 1 : 256 + ((distance - 1) >> 7)];
+    writer.put(reversed_code(distance_code, 5));
+    writer.put(static_cast<u32>(distance - k_distance_base[distance_code]), k_distance_extra[distance_code]);
+}
+
+/// Bytes `a` and `b` have in common, up to `max_length`.
+usize match_length(const u8 *a, const u8 *b, usize max_length) noexcept {
+    usize length = 0;
+    if constexpr (std::endian::native == std::endian::little) {
+        for (; length + 8 <= max_length; length += 8) {
+            u64 x = 0;
+            u64 y = 0;
+            std::memcpy(&x, a + length, 8);
+            std::memcpy(&y, b + length, 8);
+            if (x != y) return length + static_cast<usize>(std::countr_zero(x ^ y)) / 8;
+        }
+    }
+    while (length < max_length && a[length] == b[length]) ++length;
+    return length;
+}
+
+u32 deflate_hash(const u8 *data) noexcept {
+    const u32 key = static_cast<u32>(data[0]) << 16 | static_cast<u32>(data[1]) << 8 | data[2];
+    return (key * 2654435761u) >> (32 - k_deflate_hash_bits);
+}
+
+/// Deflates `data` as fixed-Huffman blocks that match only within it. A piece that is not `last`
+/// ends in an empty stored block, which leaves the stream byte-aligned for the next piece to
+/// start a new block in.
+void deflate_piece(std::span<const u8> data, bool last, std::vector<byte> &out) {
+    BitWriter writer{out};
+    writer.put(last ? 1 : 0, 1);
+    writer.put(1, 2);
+
+    std::vector<i32> head(usize{1} << k_deflate_hash_bits, -1);
+    std::vector<i32> previous(k_deflate_window, -1);
+    const auto insert = [&](usize position) {
+        const u32 hash = deflate_hash(data.data() + position);
+        previous[position % k_deflate_window] = head[hash];
+        head[hash] = static_cast<i32>(position);
+    };
+
+    const usize size = data.size();
+    usize position = 0;
+    while (position < size) {
+        usize best_length = 0;
+        usize best_distance = 0;
+        if (position + k_deflate_min_match <= size) {
+            const usize max_length = std::min(k_deflate_max_match, size - position);
+            i32 candidate = head[deflate_hash(data.data() + position)];
+            for (u32 chain = 0; candidate >= 0 && chain < k_deflate_max_chain; ++chain) {
+                const usize distance = position - static_cast<usize>(candidate);
+                if (distance > k_deflate_window) break;
+                const u8 *a = data.data() + candidate;
+                const u8 *b = data.data() + position;
+                // a candidate that differs at the end of the best match cannot beat it
+                const usize length = a[best_length] == b[best_length] ? match_length(a, b, max_length) : 0;
+                if (length > best_length) {
+                    best_length = length;
+                    best_distance = distance;
+                    if (length == max_length) break;
+                }
+                candidate = previous[static_cast<usize>(candidate) % k_deflate_window];
+            }
+            insert(position);
+        }
+
+        if (best_length >= k_deflate_min_match) {
+            put_fixed_match(writer, best_length, best_distance);
+            const usize end = position + best_length;
+            for (++position; position < end && position + k_deflate_min_match <= size; ++position) insert(position);
+            position = end;
+        } else {
+            writer.put(k_fixed_symbol_codes[data[position]]);
+            ++position;
+        }
+    }
+    writer.put(k_fixed_symbol_codes[256]);
+
+    if (!last) {
+        writer.put(0, 3);
+        writer.align();
+        append_u32_be(out, 0x0000ffffu);
+    } else {
+        writer.align();
+    }
+}
+
+struct PngLayout final {
+    u8 color_type = 0;
+    u8 bit_depth = 8;
+    usize pixel_bytes = 0;
+};
+
+/// How `format` is stored in a PNG as it is, nullopt if it must be converted first.
+std::optional<PngLayout> png_layout(rhi::Format format) noexcept {
+    switch (format) {
+        case rhi::Format::R8Unorm:
+            return PngLayout{0, 8, 1};
+        case rhi::Format::R16Unorm:
+            return PngLayout{0, 16, 2};
+        case rhi::Format::RGBA8Unorm:
+        case rhi::Format::RGBA8UnormSrgb:
+            return PngLayout{6, 8, 4};
+        case rhi::Format::RGBA16Unorm:
+            return PngLayout{6, 16, 8};
+        default:
+            return std::nullopt;
+    }
+}
+
+/// Row `y` in PNG byte order: as it is for 8-bit samples, byte-swapped into `buffer` for 16-bit.
+const u8 *png_row(const Image &image, const PngLayout &layout, u32 y, std::vector<u8> &buffer) {
+    const auto *row = reinterpret_cast<const u8 *>(image.row_data(y));
+    if (layout.bit_depth == 8) return row;
+    for (usize i = 0; i < buffer.size(); i += 2) {
+        buffer[i] = row[i + 1];
+        buffer[i + 1] = row[i];
+    }
+    return buffer.data();
+}
+
+u8 paeth(u8 a, u8 b, u8 c) noexcept {
+    const i32 p = static_cast<i32>(a) + b - c;
+    const i32 pa = std::abs(p - a);
+    const i32 pb = std::abs(p - b);
+    const i32 pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return pb <= pc ? b : c;
+}
+
+/// Writes `row` less `predict(left, up, up_left)` to `out` and returns the sum of absolute
+/// differences. The first pixel is split off so the loop over the rest does not branch.
+template <typename Predict>
+u64 apply_filter(const u8 *row, const u8 *prior, usize size, usize pixel_bytes, u8 *out, Predict predict) {
+    u64 score = 0;
+    const auto put = [&](usize i, u8 predicted) {
+        out[i] = static_cast<u8>(row[i] - predicted);
+        score += static_cast<u64>(std::abs(static_cast<i32>(static_cast<i8>(out[i]))));
+    };
+    for (usize i = 0; i < std::min(pixel_bytes, size); ++i) put(i, predict(u8{0}, prior[i], u8{0}));
+    for (usize i = pixel_bytes; i < size; ++i) put(i, predict(row[i - pixel_bytes], prior[i], prior[i - pixel_bytes]));
+    return score;
+}
+
+/// Appends the filter byte and the filtered `row`, with the filter that leaves the smallest sum of
+/// absolute differences, the heuristic stb_image_write and libpng use.
+void filter_row(const u8 *row, const u8 *prior, usize size, usize pixel_bytes, std::vector<u8> &scratch, std::vector<u8> &out) {
+    u8 *candidates = scratch.data();
+    const std::array<u64, 5> scores{
+        apply_filter(row, prior, size, pixel_bytes, candidates, [](u8, u8, u8) { return u8{0}; }),
+        apply_filter(row, prior, size, pixel_bytes, candidates + size, [](u8 a, u8, u8) { return a; }),
+        apply_filter(row, prior, size, pixel_bytes, candidates + 2 * size, [](u8, u8 b, u8) { return b; }),
+        apply_filter(row, prior, size, pixel_bytes, candidates + 3 * size, [](u8 a, u8 b, u8) {
+            return static_cast<u8>((a + b) / 2);
+        }),
+        apply_filter(row, prior, size, pixel_bytes, candidates + 4 * size, paeth),
+    };
+    const auto best_filter = static_cast<u8>(std::min_element(scores.begin(), scores.end()) - scores.begin());
+    out.push_back(best_filter);
+    out.insert(out.end(), candidates + best_filter * size, candidates + (best_filter + 1) * size);
+}
+
+void append_png_chunk(std::vector<byte> &out, std::string_view type, std::span<const byte> data) {
+    append_u32_be(out, static_cast<u32>(data.size()));
+    const usize crc_begin = out.size();
+    append_bytes(out, type);
+    out.insert(out.end(), data.begin(), data.end());
+    append_u32_be(out, crc32(std::span(out).subspan(crc_begin)));
+}
+
+/// `image` itself if it is in `format`, else its conversion in `storage`; nullptr if it has none.
+const Image *image_in(const Image &image, rhi::Format format, Image &storage) {
+    if (image.format == format) return &image;
+    storage = convert_image(image, format);
+    return storage ? &storage : nullptr;
+}
+
+bool write_file(const std::filesystem::path &path, std::span<const byte> data) {
+    if (data.empty()) return false;
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(stream);
+}
+
+} // namespace
+
+std::vector<byte> encode_png(const Image &image) {
+    if (!image) return {};
+    Image storage;
+    const Image *source = &image;
+    auto layout = png_layout(image.format);
+    if (!layout) {
+        source = image_in(image, rhi::Format::RGBA8Unorm, storage);
+        if (!source) return {};
+        layout = png_layout(rhi::Format::RGBA8Unorm);
+    }
+
+    const usize row_size = static_cast<usize>(source->width) * layout->pixel_bytes;
+    const usize rows_per_piece = std::max<usize>(1, k_png_piece_bytes / (row_size + 1));
+    const usize piece_count = (source->height + rows_per_piece - 1) / rows_per_piece;
+
+    // every piece is one IDAT chunk of its own; the zlib stream runs on across them
+    std::vector<std::vector<byte>> chunks(piece_count);
+    std::vector<u32> adlers(piece_count);
+    std::vector<usize> filtered_sizes(piece_count);
+    parallel_for_chunks(piece_count, parallel_chunk_count(piece_count, 1), [&](usize begin, usize end, u32) {
+        std::vector<u8> filtered;
+        std::vector<u8> scratch(row_size * 5);
+        std::vector<u8> row_buffer(row_size);
+        std::vector<u8> prior_buffer(row_size, 0);
+        std::vector<byte> data;
+        for (usize piece = begin; piece < end; ++piece) {
+            const auto first_row = static_cast<u32>(piece * rows_per_piece);
+            const auto last_row = static_cast<u32>(std::min<usize>(source->height, first_row + rows_per_piece));
+            filtered.clear();
+            filtered.reserve((last_row - first_row) * (row_size + 1));
+            std::fill(prior_buffer.begin(), prior_buffer.end(), u8{0});
+            const u8 *prior = first_row > 0 ? png_row(*source, *layout, first_row - 1, prior_buffer) : prior_buffer.data();
+            for (u32 y = first_row; y < last_row; ++y) {
+                const u8 *row = png_row(*source, *layout, y, row_buffer);
+                filter_row(row, prior, row_size, layout->pixel_bytes, scratch, filtered);
+                if (layout->bit_depth == 8) {
+                    prior = row;
+                } else {
+                    std::swap(row_buffer, prior_buffer);
+                    prior = prior_buffer.data();
+                }
+            }
+            adlers[piece] = adler32(filtered);
+            filtered_sizes[piece] = filtered.size();
+
+            data.clear();
+            if (piece == 0) {
+                data.push_back(byte{0x78});
+                data.push_back(byte{0x5e});
+            }
+            deflate_piece(filtered, piece + 1 == piece_count, data);
+            append_png_chunk(chunks[piece], "IDAT", data);
+        }
+    });
+
+    u32 adler = adlers[0];
+    for (usize piece = 1; piece < piece_count; ++piece) {
+        adler = adler32_combine(adler, adlers[piece], filtered_sizes[piece]);
+    }
+
+    std::vector<byte> header;
+    append_u32_be(header, source->width);
+    append_u32_be(header, source->height);
+    header.push_back(static_cast<byte>(layout->bit_depth));
+    header.push_back(static_cast<byte>(layout->color_type));
+    header.push_back(byte{0});
+    header.push_back(byte{0});
+    header.push_back(byte{0});
+    std::vector<byte> checksum;
+    append_u32_be(checksum, adler);
+
+    std::vector<byte> png;
+    usize png_size = 8 + 25 + 16 + 12;
+    for (const auto &chunk : chunks) png_size += chunk.size();
+    png.reserve(png_size);
+    for (const u8 value : k_png_signature) png.push_back(static_cast<byte>(value));
+    append_png_chunk(png, "IHDR", header);
+    for (const auto &chunk : chunks) png.insert(png.end(), chunk.begin(), chunk.end());
+    append_png_chunk(png, "IDAT", checksum);
+    append_png_chunk(png, "IEND", {});
+    return png;
+}
+
+std::vector<byte> encode_qoi(const Image &image) {
+    if (!image) return {};
+    Image storage;
+    const bool srgb = image.format == rhi::Format::RGBA8UnormSrgb;
+    const Image *source = srgb ? &image : image_in(image, rhi::Format::RGBA8Unorm, storage);
+    if (!source) return {};
+
+    using Pixel = std::array<u8, 4>;
+    const auto hash = [](const Pixel &p) { return (p[0] * 3 + p[1] * 5 + p[2] * 7 + p[3] * 11) % 64; };
+
+    std::vector<byte> qoi;
+    qoi.reserve(14 + static_cast<usize>(source->width) * source->height * 5 + 8);
+    append_bytes(qoi, "qoif");
+    append_u32_be(qoi, source->width);
+    append_u32_be(qoi, source->height);
+    qoi.push_back(byte{4});
+    // 0 is sRGB colour with linear alpha, 1 all channels linear
+    qoi.push_back(srgb ? byte{0} : byte{1});
+
+    const auto put = [&](u32 value) { qoi.push_back(static_cast<byte>(value)); };
+    std::array<Pixel, 64> index{};
+    Pixel previous{0, 0, 0, 255};
+    u32 run = 0;
+    for (u32 y = 0; y < source->height; ++y) {
+        const auto *row = reinterpret_cast<const u8 *>(source->row_data(y));
+        for (u32 x = 0; x < source->width; ++x) {
+            const Pixel pixel{row[x * 4], row[x * 4 + 1], row[x * 4 + 2], row[x * 4 + 3]};
+            if (pixel == previous) {
+                if (++run == 62) {
+                    put(0xc0 | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0) {
+                put(0xc0 | (run - 1));
+                run = 0;
+            }
+
+            const auto slot = hash(pixel);
+            if (index[slot] == pixel) {
+                put(slot);
+            } else {
+                index[slot] = pixel;
+                if (pixel[3] == previous[3]) {
+                    const auto dr = static_cast<i8>(pixel[0] - previous[0]);
+                    const auto dg = static_cast<i8>(pixel[1] - previous[1]);
+                    const auto db = static_cast<i8>(pixel[2] - previous[2]);
+                    const i32 dr_dg = dr - dg;
+                    const i32 db_dg = db - dg;
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                        put(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+                    } else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7) {
+                        put(0x80 | (dg + 32));
+                        put((dr_dg + 8) << 4 | (db_dg + 8));
+                    } else {
+                        put(0xfe);
+                        put(pixel[0]);
+                        put(pixel[1]);
+                        put(pixel[2]);
+                    }
+                } else {
+                    put(0xff);
+                    put(pixel[0]);
+                    put(pixel[1]);
+                    put(pixel[2]);
+                    put(pixel[3]);
+                }
+            }
+            previous = pixel;
+        }
+    }
+    if (run > 0) put(0xc0 | (run - 1));
+    for (u32 i = 0; i < 7; ++i) put(0);
+    put(1);
+    return qoi;
+}
+
+std::vector<byte> encode_pfm(const Image &image) {
+    if (!image) return {};
+    Image storage;
+    const Image *source = nullptr;
+    if (image.format == rhi::Format::R32Float || image.format == rhi::Format::RGBA32Float) {
+        source = &image;
+    } else {
+        // single-channel formats convert to R32Float only
+        source = image_in(image, rhi::Format::R32Float, storage);
+        if (!source) source = image_in(image, rhi::Format::RGBA32Float, storage);
+        if (!source) return {};
+    }
+
+    const bool gray = source->format == rhi::Format::R32Float;
+    const usize channels = gray ? 1 : 3;
+    std::string header = gray ? "Pf\n" : "PF\n";
+    header += std::to_string(source->width) + " " + std::to_string(source->height) + "\n";
+    // a negative scale marks little-endian samples
+    header += std::endian::native == std::endian::little ? "-1.0\n" : "1.0\n";
+
+    const usize row_size = static_cast<usize>(source->width) * channels * sizeof(f32);
+    std::vector<byte> pfm(header.size() + row_size * source->height);
+    std::memcpy(pfm.data(), header.data(), header.size());
+    byte *pixels = pfm.data() + header.size();
+
+    // rows run bottom to top, RGBA drops its alpha
+    const usize min_rows = std::max<usize>(1, (usize{1} << 20) / std::max<usize>(row_size, 1));
+    parallel_for_chunks(source->height, parallel_chunk_count(source->height, min_rows), [&](usize begin, usize end, u32) {
+        for (usize y = begin; y < end; ++y) {
+            const auto *row = source->row_data(static_cast<u32>(y));
+            auto *dst = pixels + (source->height - 1 - y) * row_size;
+            if (gray) {
+                std::memcpy(dst, row, row_size);
+                continue;
+            }
+            for (u32 x = 0; x < source->width; ++x) {
+                std::memcpy(dst + x * 3 * sizeof(f32), row + x * 4 * sizeof(f32), 3 * sizeof(f32));
+            }
+        }
+    });
+    return pfm;
+}
+
+bool write_image_png(const std::filesystem::path &path, const Image &image) {
+    return write_file(path, encode_png(image));
+}
+
+bool write_image_qoi(const std::filesystem::path &path, const Image &image) {
+    return write_file(path, encode_qoi(image));
+}
+
+bool write_image_pfm(const std::filesystem::path &path, const Image &image) {
+    return write_file(path, encode_pfm(image));
+}
+
+} // namespace llc
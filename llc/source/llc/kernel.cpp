@@ -1,9 +1,11 @@
 #include "kernel.h"
 
+#include <algorithm>
 #include <array>
 #include <filesystem>
 #include <ranges>
 #include <span>
+#include <string>
 #include <system_error>
 #include <fmt/format.h>
 
@@ -11,6 +13,7 @@
 #include <llc/blob.h>
 #include <llc/utils/fs.h>
 #include <llc/utils/config.h>
+#include <llc/utils/module_registry.h>
 
 namespace llc {
 
@@ -61,6 +64,16 @@ auto build_search_directories(std::span<const char *const> extra_search_paths) {
            std::views::filter([](const path &search_directory) { return !search_directory.empty(); });
 }
 
+/// Resolution depends on the search paths, so they are part of the registry key.
+std::string registry_key(const char *module_name, std::span<const char *const> extra_search_paths) {
+    std::string key(module_name);
+    for (const char *search_path : extra_search_paths) {
+        key.push_back('\n');
+        key.append(search_path);
+    }
+    return key;
+}
+
 } // namespace
 
 ComPtr<slang::IModule> load_shader_module(
@@ -68,6 +81,10 @@ ComPtr<slang::IModule> load_shader_module(
     const char *module_name,
     std::span<const char *const> extra_search_paths) {
 
+    auto &registry = module_registry(context);
+    const auto key = registry_key(module_name, extra_search_paths);
+    if (auto cached = find_registered_module(registry, key)) return cached;
+
     auto *slang_session = context.slang_session();
 
     ComPtr<slang::IModule> slang_module;
@@ -83,7 +100,8 @@ ComPtr<slang::IModule> load_shader_module(
             const path binary_full_path = current_search_path / binary_module_filename;
             if (!std::filesystem::exists(binary_full_path)) break;
 
-            auto shader_ir = FileBlob::load(binary_full_path);
+            // deserializing touches every byte of the IR, so read it all in right away
+            auto shader_ir = load_file_blob(binary_full_path, MapAccess::WILL_NEED);
             if (!shader_ir) break;
 
             slang_module = slang_session->loadModuleFromIRBlob(
@@ -105,6 +123,7 @@ ComPtr<slang::IModule> load_shader_module(
         if (slang_module) break;
     }
 
+    if (slang_module) register_module(registry, key, slang_module.get());
     return slang_module;
 }
 
@@ -130,8 +149,26 @@ Kernel Kernel::load(
 
     Kernel res;
 
+    if (auto *layout = linked_program->getLayout()) {
+        if (auto *entry_point_layout = layout->getEntryPointByIndex(0)) {
+            SlangUInt sizes[3] = {1, 1, 1};
+            entry_point_layout->getComputeThreadGroupSize(3, sizes);
+            for (int i = 0; i < 3; ++i) {
+                res.thread_group_size_[i] = std::max(static_cast<u32>(sizes[i]), 1u);
+            }
+        }
+    }
+
     rhi::ComputePipelineDesc desc;
     auto *device = context.device();
+
+    // a zero limit means the backend does not report it
+    const auto &limits = device->getInfo().limits;
+    for (int i = 0; i < 3; ++i) {
+        if (limits.maxComputeDispatchThreadGroups[i] != 0) {
+            res.max_group_count_[i] = limits.maxComputeDispatchThreadGroups[i];
+        }
+    }
     {
         ComPtr<slang::IBlob> diagnostics;
         auto program = device->createShaderProgram(linked_program, diagnostics.writeRef());
@@ -3,21 +3,128 @@
 #include <slang-com-ptr.h>
 #include <slang-rhi.h>
 
+#include <algorithm>
 #include <span>
+#include <type_traits>
 
 #include <llc/context.h>
+#include <llc/types.hpp>
 
 namespace llc {
+
+/// The threads one dispatch of a split `Kernel::dispatch` covers.
+struct DispatchRegion final {
+    u32x3 thread_offset{0, 0, 0};
+    u32x3 thread_count{0, 0, 0};
+};
 
 struct Kernel final {
     Slang::ComPtr<rhi::IShaderProgram> program_;
     Slang::ComPtr<rhi::IComputePipeline> pipeline_;
+    /// `[numthreads]` of the entry point, read from reflection at load
+    u32x3 thread_group_size_{1, 1, 1};
+    /// groups a single dispatch may launch per dimension, from the device limits
+    u32x3 max_group_count_{k_fallback_max_group_count, k_fallback_max_group_count, k_fallback_max_group_count};
+
+    /// What every backend guarantees when the device does not report its limit.
+    static constexpr u32 k_fallback_max_group_count = 65535;
 
     operator bool() const noexcept { return program_ && pipeline_; }
     static Kernel load(slang::IModule *slang_module, Context &context, const char *entry_point_name);
+
+    /// Encodes a compute pass running one thread per element of `threads` (use 1 for unused
+    /// dimensions), with group counts derived from `thread_group_size_`.
+    ///
+    /// `bind_fn(rhi::IShaderObject *root)` binds the parameters and returns a SlangResult. A dispatch
+    /// needing more groups than the device allows is split along the oversized dimensions; that is
+    /// only possible if `bind_fn` also takes a `const DispatchRegion &`, since the kernel has to know
+    /// which threads it covers. Otherwise oversized dispatches fail with SLANG_E_INVALID_ARG.
+    template <typename BindFn>
+    SlangResult dispatch(rhi::ICommandEncoder *encoder, const u32x3 &threads, BindFn &&bind_fn) const;
+
+    /// Calls `chunk_fn(const DispatchRegion &, const u32x3 &group_count)` for every dispatch
+    /// `threads` is split into under `max_group_count_`, x fastest, and returns the first failure.
+    /// `dispatch` encodes these; a single call is the common case.
+    template <typename ChunkFn>
+    SlangResult for_each_dispatch_chunk(const u32x3 &threads, ChunkFn &&chunk_fn) const;
+
+    /// Groups needed to run one thread per element of `threads`.
+    [[nodiscard]] u32x3 group_count(const u32x3 &threads) const noexcept {
+        // u64 so thread counts close to 2^32 do not wrap while rounding up
+        u32x3 count;
+        for (int i = 0; i < 3; ++i) {
+            const u64 size = thread_group_size_[i];
+            count[i] = static_cast<u32>((u64{threads[i]} + size - 1) / size);
+        }
+        return count;
+    }
+
+    /// Whether a single dispatch may launch `group_count` groups.
+    [[nodiscard]] bool fits_dispatch_limits(const u32x3 &group_count) const noexcept {
+        return group_count.x <= max_group_count_.x && group_count.y <= max_group_count_.y &&
+               group_count.z <= max_group_count_.z;
+    }
 };
 
 Slang::ComPtr<slang::IModule>
 load_shader_module(Context &context, const char *module_name, std::span<const char *const> extra_search_paths = {});
 
+template <typename BindFn>
+SlangResult Kernel::dispatch(rhi::ICommandEncoder *encoder, const u32x3 &threads, BindFn &&bind_fn) const {
+    constexpr bool k_splittable = std::is_invocable_v<BindFn &, rhi::IShaderObject *, const DispatchRegion &>;
+    static_assert(
+        k_splittable || std::is_invocable_v<BindFn &, rhi::IShaderObject *>,
+        "bind_fn must take (rhi::IShaderObject *) or (rhi::IShaderObject *, const DispatchRegion &)");
+
+    if (threads.x == 0 || threads.y == 0 || threads.z == 0) return SLANG_OK;
+
+    const auto group_count = this->group_count(threads);
+    if constexpr (!k_splittable) {
+        if (!fits_dispatch_limits(group_count)) return SLANG_E_INVALID_ARG;
+    }
+
+    auto *pass = encoder->beginComputePass();
+    SlangResult result = SLANG_OK;
+    if constexpr (k_splittable) {
+        result = for_each_dispatch_chunk(threads, [&](const DispatchRegion &region, const u32x3 &chunk_group_count) {
+            auto *root_object = pass->bindPipeline(pipeline_.get());
+            SLANG_RETURN_ON_FAIL(bind_fn(root_object, region));
+            pass->dispatchCompute(chunk_group_count.x, chunk_group_count.y, chunk_group_count.z);
+            return SLANG_OK;
+        });
+    } else {
+        auto *root_object = pass->bindPipeline(pipeline_.get());
+        result = bind_fn(root_object);
+        if (SLANG_SUCCEEDED(result)) pass->dispatchCompute(group_count.x, group_count.y, group_count.z);
+    }
+    pass->end();
+    return result;
+}
+
+template <typename ChunkFn>
+SlangResult Kernel::for_each_dispatch_chunk(const u32x3 &threads, ChunkFn &&chunk_fn) const {
+    if (threads.x == 0 || threads.y == 0 || threads.z == 0) return SLANG_OK;
+
+    // walk the group grid in chunks the device accepts
+    const auto group_count = this->group_count(threads);
+    u32x3 first_group{0, 0, 0};
+    for (first_group.z = 0; first_group.z < group_count.z; first_group.z += max_group_count_.z) {
+        for (first_group.y = 0; first_group.y < group_count.y; first_group.y += max_group_count_.y) {
+            for (first_group.x = 0; first_group.x < group_count.x; first_group.x += max_group_count_.x) {
+                DispatchRegion region;
+                u32x3 chunk_group_count;
+                for (int i = 0; i < 3; ++i) {
+                    chunk_group_count[i] = std::min(group_count[i] - first_group[i], max_group_count_[i]);
+                    region.thread_offset[i] = first_group[i] * thread_group_size_[i];
+                    region.thread_count[i] = std::min(
+                        threads[i] - region.thread_offset[i],
+                        chunk_group_count[i] * thread_group_size_[i]);
+                }
+                SLANG_RETURN_ON_FAIL(chunk_fn(static_cast<const DispatchRegion &>(region), chunk_group_count));
+            }
+        }
+    }
+    return SLANG_OK;
+}
+
 } // namespace llc
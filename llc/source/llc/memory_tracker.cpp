@@ -0,0 +1,206 @@
+#include "memory_tracker.h"
+
+#include <algorithm>
+
+#include <llc/image.h>
+
+namespace llc {
+
+namespace {
+
+void add_bytes(MemoryCounters &counters, u64 size) noexcept {
+    counters.current_bytes += size;
+    counters.peak_bytes = std::max(counters.peak_bytes, counters.current_bytes);
+}
+
+/// Texture footprint without asking the device, for backends that cannot tell.
+u64 estimate_texture_size(const rhi::TextureDesc &desc) noexcept {
+    // formats `Image` does not know are mostly compressed ones, which are smaller than this
+    const u64 texel_size = std::max<usize>(bytes_per_pixel(desc.format), 4);
+    const u64 layer_count = std::max<u32>(desc.arrayLength, 1) * (desc.type == rhi::TextureType::TextureCube ? 6 : 1);
+
+    u64 texel_count = 0;
+    for (u32 mip = 0; mip < std::max<u32>(desc.mipCount, 1); ++mip) {
+        const u64 width = std::max<u32>(desc.size.width >> mip, 1);
+        const u64 height = std::max<u32>(desc.size.height >> mip, 1);
+        const u64 depth = std::max<u32>(desc.size.depth >> mip, 1);
+        texel_count += width * height * depth;
+    }
+    return texel_count * texel_size * layer_count;
+}
+
+} // namespace
+
+std::string_view memory_category_name(MemoryCategory category) noexcept {
+    switch (category) {
+        case MemoryCategory::BUFFER:
+            return "buffer";
+        case MemoryCategory::TEXTURE:
+            return "texture";
+        case MemoryCategory::SCRATCH:
+            return "scratch";
+        case MemoryCategory::READBACK:
+            return "readback";
+        case MemoryCategory::STAGING:
+            return "staging";
+    }
+    return "unknown";
+}
+
+void MemoryTracker::collect() {
+    for (usize i = 0; i < entries.size();) {
+        if (!try_release(i)) ++i;
+    }
+    collect_cursor = 0;
+}
+
+void MemoryTracker::collect_slice() {
+    for (usize checked = 0; checked < k_collect_slice && !entries.empty(); ++checked) {
+        if (collect_cursor >= entries.size()) collect_cursor = 0;
+        // a released entry is replaced by the last one, which is checked next
+        if (!try_release(collect_cursor)) ++collect_cursor;
+    }
+}
+
+bool MemoryTracker::try_release(usize index) {
+    auto *resource = entries[index].resource.get();
+    if (!unused_locked(resource)) return false;
+    if (--held[resource] == 0) held.erase(resource);
+
+    auto &counters = categories[static_cast<usize>(entries[index].category)];
+    counters.current_bytes -= entries[index].size;
+    --counters.live_count;
+    total.current_bytes -= entries[index].size;
+    --total.live_count;
+
+    entries[index] = std::move(entries.back());
+    entries.pop_back();
+    return true;
+}
+
+bool MemoryTracker::reserve(u64 size, MemoryCategory category) {
+    std::scoped_lock lock(mutex);
+    collect_slice();
+    if (budget != 0 && total.current_bytes + size > budget) {
+        // released resources the sweep has not reached yet do not count against the budget
+        collect();
+        if (total.current_bytes + size > budget) return false;
+    }
+
+    add_bytes(categories[static_cast<usize>(category)], size);
+    add_bytes(total, size);
+    return true;
+}
+
+void MemoryTracker::cancel(u64 size, MemoryCategory category) {
+    std::scoped_lock lock(mutex);
+    categories[static_cast<usize>(category)].current_bytes -= size;
+    total.current_bytes -= size;
+}
+
+void MemoryTracker::commit(rhi::IResource *resource, u64 size, MemoryCategory category) {
+    std::scoped_lock lock(mutex);
+    entries.push_back({Slang::ComPtr<rhi::IResource>(resource), size, category});
+    ++held[resource];
+    ++categories[static_cast<usize>(category)].live_count;
+    ++total.live_count;
+}
+
+void MemoryTracker::hold(rhi::IResource *resource, u32 count) {
+    std::scoped_lock lock(mutex);
+    held[resource] += count;
+}
+
+void MemoryTracker::unhold(rhi::IResource *resource, u32 count) {
+    std::scoped_lock lock(mutex);
+    const auto it = held.find(resource);
+    if (it == held.end()) return;
+    if (it->second <= count) {
+        held.erase(it);
+    } else {
+        it->second -= count;
+    }
+}
+
+bool MemoryTracker::unused(rhi::IResource *resource) {
+    std::scoped_lock lock(mutex);
+    return unused_locked(resource);
+}
+
+bool MemoryTracker::unused_locked(rhi::IResource *resource) const {
+    const auto it = held.find(resource);
+    resource->addRef();
+    return resource->release() <= (it == held.end() ? 0 : it->second);
+}
+
+MemorySnapshot MemoryTracker::snapshot() {
+    std::scoped_lock lock(mutex);
+    collect();
+    return MemorySnapshot{
+        .categories = categories,
+        .total = total,
+        .budget = budget,
+    };
+}
+
+Slang::ComPtr<rhi::IBuffer>
+create_tracked_buffer(Context &context, const rhi::BufferDesc &desc, const void *init_data, MemoryCategory category) {
+    auto &tracker = memory_tracker(context);
+    if (!tracker.enabled.load(std::memory_order_relaxed)) return context.device()->createBuffer(desc, init_data);
+
+    if (!tracker.reserve(desc.size, category)) return nullptr;
+    auto buffer = context.device()->createBuffer(desc, init_data);
+    if (buffer) {
+        tracker.commit(buffer.get(), desc.size, category);
+    } else {
+        tracker.cancel(desc.size, category);
+    }
+    return buffer;
+}
+
+Slang::ComPtr<rhi::ITexture> create_tracked_texture(
+    Context &context,
+    const rhi::TextureDesc &desc,
+    MemoryCategory category,
+    const rhi::SubresourceData *init_data) {
+
+    auto &tracker = memory_tracker(context);
+    auto *device = context.device();
+    if (!tracker.enabled.load(std::memory_order_relaxed)) return device->createTexture(desc, init_data);
+
+    // the device knows about row alignment and tiling, the estimate only about texels
+    rhi::Size size = 0;
+    rhi::Size alignment = 0;
+    if (SLANG_FAILED(device->getTextureAllocationInfo(desc, &size, &alignment)) || size == 0) {
+        size = estimate_texture_size(desc);
+    }
+
+    if (!tracker.reserve(size, category)) return nullptr;
+    auto texture = device->createTexture(desc, init_data);
+    if (texture) {
+        tracker.commit(texture.get(), size, category);
+    } else {
+        tracker.cancel(size, category);
+    }
+    return texture;
+}
+
+MemorySnapshot memory_snapshot(Context &context) {
+    return memory_tracker(context).snapshot();
+}
+
+void collect_memory(Context &context) {
+    auto &tracker = memory_tracker(context);
+    if (!tracker.enabled.load(std::memory_order_relaxed)) return;
+    std::scoped_lock lock(tracker.mutex);
+    tracker.collect();
+}
+
+void set_memory_budget(Context &context, u64 budget) {
+    auto &tracker = memory_tracker(context);
+    std::scoped_lock lock(tracker.mutex);
+    tracker.budget = budget;
+    if (budget != 0) tracker.enabled.store(true, std::memory_order_relaxed);
+}
+
+} // namespace llc
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <slang-com-ptr.h>
+#include <slang-rhi.h>
+
+#include <llc/context.h>
+#include <llc/types.hpp>
+
+namespace llc {
+
+enum class MemoryCategory : u8 {
+    /// device buffers created through `create_buffer` and friends
+    BUFFER,
+    TEXTURE,
+    /// intermediate buffers of the `pp` algorithms
+    SCRATCH,
+    /// host-visible buffers the device writes to
+    READBACK,
+    /// host-visible buffers the device reads from
+    STAGING,
+};
+
+inline constexpr usize k_memory_category_count = 5;
+
+std::string_view memory_category_name(MemoryCategory category) noexcept;
+
+struct MemoryCounters final {
+    u64 current_bytes = 0;
+    u64 peak_bytes = 0;
+    u32 live_count = 0;
+};
+
+struct MemorySnapshot final {
+    std::array<MemoryCounters, k_memory_category_count> categories{};
+    MemoryCounters total;
+    /// 0 if allocations are not limited
+    u64 budget = 0;
+
+    [[nodiscard]] const MemoryCounters &operator[](MemoryCategory category) const noexcept {
+        return categories[static_cast<usize>(category)];
+    }
+};
+
+/// Accounts the device memory `llc` allocates, see `ContextDesc::track_memory`.
+///
+/// slang-rhi has no destruction callbacks, so the tracker keeps a reference to every resource and
+/// counts one as released once only it and the caches of the context reference it, see `hold`; the
+/// caches drop such resources at their next collection. Every tracked allocation checks the next
+/// `k_collect_slice` entries, so allocating stays cheap with many live resources; snapshots and
+/// allocations that would exceed the budget check all of them, as does `collect_memory` after every
+/// wait llc does for the queue. Until one of them reaches it, a released resource stays alive and
+/// counts towards the peak.
+struct MemoryTracker final {
+    static constexpr usize k_collect_slice = 32;
+
+    std::mutex mutex;
+    std::atomic<bool> enabled{false};
+    u64 budget = 0;
+
+    struct Entry final {
+        Slang::ComPtr<rhi::IResource> resource;
+        u64 size;
+        MemoryCategory category;
+    };
+    std::vector<Entry> entries;
+    /// next entry `collect_slice` checks
+    usize collect_cursor = 0;
+    /// references the tracker and the caches of the context hold, by resource
+    std::unordered_map<rhi::IResource *, u32> held;
+    std::array<MemoryCounters, k_memory_category_count> categories{};
+    MemoryCounters total;
+
+    /// Releases the resources that are `unused`.
+    void collect();
+    /// `collect` over the next `k_collect_slice` entries, wrapping around.
+    void collect_slice();
+    /// Releases entry `index` if it is `unused`, moving the last entry there.
+    bool try_release(usize index);
+
+    /// Records `count` references a cache takes to `resource`, which do not count as uses of it for
+    /// the tracker or the other caches; `unhold` them when the cache drops them. Only references
+    /// through `ComPtr` count: views keep their texture by a reference `release` does not report.
+    void hold(rhi::IResource *resource, u32 count = 1);
+    void unhold(rhi::IResource *resource, u32 count = 1);
+    /// Whether only the tracker and the caches that `hold` it still reference `resource`.
+    [[nodiscard]] bool unused(rhi::IResource *resource);
+    /// `unused` with `mutex` held.
+    [[nodiscard]] bool unused_locked(rhi::IResource *resource) const;
+
+    /// Accounts `size` bytes ahead of creating a resource; false if they exceed the budget.
+    bool reserve(u64 size, MemoryCategory category);
+    /// Undoes `reserve` when the creation failed.
+    void cancel(u64 size, MemoryCategory category);
+    /// Takes a reference to the resource created for a successful `reserve`.
+    void commit(rhi::IResource *resource, u64 size, MemoryCategory category);
+
+    [[nodiscard]] MemorySnapshot snapshot();
+};
+
+/// `context.device()->createBuffer`, accounted under `category`. Fails if it would exceed the budget.
+Slang::ComPtr<rhi::IBuffer>
+create_tracked_buffer(Context &context, const rhi::BufferDesc &desc, const void *init_data, MemoryCategory category);
+
+/// `context.device()->createTexture`, accounted under `category`. Fails if it would exceed the budget.
+Slang::ComPtr<rhi::ITexture> create_tracked_texture(
+    Context &context,
+    const rhi::TextureDesc &desc,
+    MemoryCategory category = MemoryCategory::TEXTURE,
+    const rhi::SubresourceData *init_data = nullptr);
+
+/// Current and peak usage per category. All zero unless tracking is enabled.
+MemorySnapshot memory_snapshot(Context &context);
+
+/// Releases every tracked resource only llc still references. llc calls it whenever it waits for
+/// the queue; call it after waiting for work llc did not submit to free dropped resources without
+/// allocating or taking a snapshot.
+void collect_memory(Context &context);
+
+/// Limits the bytes tracked allocations may hold, 0 for no limit. Enables tracking if needed;
+/// resources allocated before are not accounted.
+void set_memory_budget(Context &context, u64 budget);
+
+} // namespace llc
@@ -0,0 +1,558 @@
+#include "mip_generator.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <span>
+
+#include <llc/blob.h>
+#include <llc/buffer.h>
+#include <llc/math.h>
+#include <llc/memory_tracker.h>
+
+#include <llc/utils/config.h>
+#include <llc/utils/embedded_module.h>
+#include <llc/utils/pipeline_cache.h>
+#include <llc/utils/small_string.h>
+#include <llc/utils/small_vector.h>
+
+LLC_DECLARE_EMBEDDED_MODULE(generate_mips)
+LLC_DECLARE_EMBEDDED_MODULE(generate_mips_spd)
+
+namespace llc {
+
+namespace {
+
+constexpr LaunchConfig k_default_mip_tile{.group_size_x = 16, .group_size_y = 16, .items_per_thread = 1};
+
+constexpr LaunchConfig k_mip_tile_candidates[] = {
+    {8, 8, 1},
+    {16, 8, 1},
+    {8, 16, 1},
+    {16, 16, 1},
+    {32, 8, 1},
+    {32, 16, 1},
+    {32, 32, 1},
+};
+
+/// parameters of `mainCompute` in generate_mips.slang, in the order of `k_generate_mips_parameters`
+enum GenerateMipsParameter : u32 {
+    GENERATE_MIPS_SRC_SIZE,
+    GENERATE_MIPS_DST_SIZE,
+    GENERATE_MIPS_FILTER,
+    GENERATE_MIPS_SRGB,
+    GENERATE_MIPS_SRC,
+    GENERATE_MIPS_DST,
+};
+constexpr std::array<const char *, 6> k_generate_mips_parameters{
+    "srcSize", "dstSize", "filterType", "srgb", "src", "dst"};
+
+/// destination mips one dispatch writes at most, the size of `dst` in generate_mips_spd.slang
+constexpr u32 k_spd_max_mips = 12;
+/// levels every group reduces on its own; more need the tail reduced by the last group
+constexpr u32 k_spd_tile_levels = 6;
+constexpr u32 k_spd_tile_size = 64;
+/// the tail is reduced by one group, so its source is at most one tile of tiles
+constexpr u32 k_spd_max_tail_source = k_spd_tile_size * k_spd_tile_size;
+
+enum SpdParameter : u32 {
+    SPD_SRC_SIZE,
+    SPD_MIP_COUNT,
+    SPD_GROUP_COUNT,
+    SPD_SRGB,
+    SPD_SRC,
+    SPD_DST,
+    SPD_MID,
+    SPD_COUNTER,
+};
+constexpr std::array<const char *, 8> k_spd_parameters{
+    "srcSize", "mipCount", "groupCount", "srgb", "src", "dst", "spdMid", "spdCounter"};
+
+u32x2 mip_size(const rhi::TextureDesc &desc, u32 mip_level) noexcept {
+    return {std::max(1u, desc.size.width >> mip_level), std::max(1u, desc.size.height >> mip_level)};
+}
+
+/// `mainCompute` of `module` specialized for `format`, linked with `extra_modules`.
+Slang::ComPtr<rhi::IComputePipeline> create_mips_pipeline(
+    Context &context,
+    slang::IModule *module,
+    rhi::Format format,
+    std::span<slang::IComponentType *const> extra_modules) {
+
+    Slang::ComPtr<slang::IEntryPoint> entry_point;
+    if (SLANG_FAILED(module->findEntryPointByName("mainCompute", entry_point.writeRef()))) {
+        return nullptr;
+    }
+
+    const auto specialization_expr = mip_format_specialization_expr(format);
+    if (specialization_expr.empty()) return nullptr;
+
+    slang::SpecializationArg specialization_arg = slang::SpecializationArg::fromExpr(specialization_expr.c_str());
+    Slang::ComPtr<slang::IBlob> diagnostics;
+    Slang::ComPtr<slang::IComponentType> specialized_entry_point;
+    if (SLANG_FAILED(entry_point->specialize(
+            &specialization_arg,
+            1,
+            specialized_entry_point.writeRef(),
+            diagnostics.writeRef()))) {
+        diagnose_if_needed(diagnostics.get());
+        return nullptr;
+    }
+    diagnose_if_needed(diagnostics.get());
+
+    SmallVector<slang::IComponentType *, 3> components{module};
+    for (auto *extra_module : extra_modules) components.push_back(extra_module);
+    components.push_back(specialized_entry_point.get());
+
+    Slang::ComPtr<slang::IComponentType> composed;
+    diagnostics = nullptr;
+    if (SLANG_FAILED(context.slang_session()->createCompositeComponentType(
+            components.data(),
+            static_cast<SlangInt>(components.size()),
+            composed.writeRef(),
+            diagnostics.writeRef()))) {
+        diagnose_if_needed(diagnostics.get());
+        return nullptr;
+    }
+
+    Slang::ComPtr<slang::IComponentType> linked_program;
+    diagnostics = nullptr;
+    if (SLANG_FAILED(composed->link(linked_program.writeRef(), diagnostics.writeRef()))) {
+        diagnose_if_needed(diagnostics.get());
+        return nullptr;
+    }
+    diagnose_if_needed(diagnostics.get());
+
+    auto *device = context.device();
+    auto program = device->createShaderProgram(linked_program);
+    if (!program) return nullptr;
+
+    rhi::ComputePipelineDesc desc{};
+    desc.program = program.get();
+    return device->createComputePipeline(desc);
+}
+
+Slang::ComPtr<rhi::IComputePipeline> create_generate_mips_pipeline(
+    Context &context,
+    rhi::Format format,
+    const LaunchConfig &tile) {
+    auto module = load_embedded_module(context, LLC_EMBEDDED_MODULE_DESC(generate_mips));
+    if (!module) return nullptr;
+
+    if (tile == k_default_mip_tile) return create_mips_pipeline(context, module.get(), format, {});
+
+    // exports the link-time tile size declared `extern` in generate_mips.slang; the default
+    // tile links without it, so only tuned tiles parse Slang source at runtime
+    const auto tile_name = "generate_mips_tile_" + std::to_string(tile.group_size_x) + "x" +
+                           std::to_string(tile.group_size_y);
+    const auto tile_source = "export static const uint TILE_WIDTH = " + std::to_string(tile.group_size_x) +
+                             ";\nexport static const uint TILE_HEIGHT = " + std::to_string(tile.group_size_y) +
+                             ";\n";
+    Slang::ComPtr<slang::IBlob> diagnostics;
+    slang::IModule *tile_module = context.slang_session()->loadModuleFromSourceString(
+        tile_name.c_str(),
+        tile_name.c_str(),
+        tile_source.c_str(),
+        diagnostics.writeRef());
+    diagnose_if_needed(diagnostics.get());
+    if (!tile_module) return nullptr;
+
+    slang::IComponentType *const extra_modules[] = {tile_module};
+    return create_mips_pipeline(context, module.get(), format, extra_modules);
+}
+
+Slang::ComPtr<rhi::IComputePipeline> create_spd_pipeline(Context &context, rhi::Format format) {
+    auto module = load_embedded_module(context, LLC_EMBEDDED_MODULE_DESC(generate_mips_spd));
+    if (!module) return nullptr;
+    return create_mips_pipeline(context, module.get(), format, {});
+}
+
+LaunchConfig generate_mips_tile(Context &context, rhi::Format format) {
+    const auto tuned = tuning_profile(context).find(tuning_key(context, "generate_mips", mip_format_name(format)));
+    return tuned && tuned->thread_count() > 0 ? *tuned : k_default_mip_tile;
+}
+
+} // namespace
+
+const char *mip_format_name(rhi::Format format) noexcept {
+    switch (format) {
+        case rhi::Format::R8Unorm:
+            return "r8";
+        case rhi::Format::RG8Unorm:
+            return "rg8";
+        case rhi::Format::RGBA8Unorm:
+            return "rgba8";
+        case rhi::Format::RGBA8UnormSrgb:
+            return "rgba8_srgb";
+        case rhi::Format::R16Unorm:
+            return "r16";
+        case rhi::Format::RG16Unorm:
+            return "rg16";
+        case rhi::Format::RGBA16Unorm:
+            return "rgba16";
+        case rhi::Format::R16Float:
+            return "r16f";
+        case rhi::Format::RG16Float:
+            return "rg16f";
+        case rhi::Format::RGBA16Float:
+            return "rgba16f";
+        case rhi::Format::R32Float:
+            return "r32f";
+        case rhi::Format::RG32Float:
+            return "rg32f";
+        case rhi::Format::RGBA32Float:
+            return "rgba32f";
+        default:
+            return nullptr;
+    }
+}
+
+std::string mip_format_specialization_expr(rhi::Format format) {
+    switch (mip_storage_format(format)) {
+        case rhi::Format::R8Unorm:
+            return std::to_string(static_cast<i32>(SLANG_IMAGE_FORMAT_r8));
+        case rhi::Format::RG8Unorm:
+            return std::to_string(static_cast<i32>(SLANG_IMAGE_FORMAT_rg8));
+        case rhi::Format::RGBA8Unorm:
+            return std::to_string(static_cast<i32>(SLANG_IMAGE_FORMAT_rgba8));
+        case rhi::Format::R16Unorm:
+            return std::to_string(static_cast<i32>(SLANG_IMAGE_FORMAT_r16));
+        case rhi::Format::RG16Unorm:
+            return std::to_string(static_cast<i32>(SLANG_IMAGE_FORMAT_rg16));
+        case rhi::Format::RGBA16Unorm:
+            return std::to_string(static_cast<i32>(SLANG_IMAGE_FORMAT_rgba16));
+        case rhi::Format::R16Float:
+            return std::to_string(static_cast<i32>(SLANG_IMAGE_FORMAT_r16f));
+        case rhi::Format::RG16Float:
+            return std::to_string(static_cast<i32>(SLANG_IMAGE_FORMAT_rg16f));
+        case rhi::Format::RGBA16Float:
+            return std::to_string(static_cast<i32>(SLANG_IMAGE_FORMAT_rgba16f));
+        case rhi::Format::R32Float:
+            return std::to_string(static_cast<i32>(SLANG_IMAGE_FORMAT_r32f));
+        case rhi::Format::RG32Float:
+            return std::to_string(static_cast<i32>(SLANG_IMAGE_FORMAT_rg32f));
+        case rhi::Format::RGBA32Float:
+            return std::to_string(static_cast<i32>(SLANG_IMAGE_FORMAT_rgba32f));
+        default:
+            return {};
+    }
+}
+
+rhi::Format mip_storage_format(rhi::Format format) noexcept {
+    return format == rhi::Format::RGBA8UnormSrgb ? rhi::Format::RGBA8Unorm : format;
+}
+
+rhi::TextureUsage mip_generation_usage(rhi::Format format) noexcept {
+    if (!mip_format_name(format)) return rhi::TextureUsage::None;
+    if (mip_storage_format(format) != format) return rhi::TextureUsage::CopySource | rhi::TextureUsage::CopyDestination;
+    return rhi::TextureUsage::ShaderResource | rhi::TextureUsage::UnorderedAccess;
+}
+
+MipGenerator::CachedViews *MipGenerator::views_of(Context &context, rhi::ITexture *texture) {
+    ++use_count_;
+    for (auto &cached : textures_) {
+        if (cached.texture.get() == texture) {
+            cached.last_use = use_count_;
+            return &cached;
+        }
+    }
+
+    // a miss is when views of released textures would otherwise pile up
+    collect_locked();
+    if (textures_.size() >= k_max_cached_textures) {
+        const auto oldest = std::ranges::min_element(textures_, {}, &CachedViews::last_use);
+        unhold(*oldest);
+        textures_.erase(oldest);
+    }
+
+    const auto &desc = texture->getDesc();
+    CachedViews cached{.texture = Slang::ComPtr<rhi::ITexture>(texture), .last_use = use_count_};
+    if (const auto storage_format = mip_storage_format(desc.format); storage_format != desc.format) {
+        auto storage_desc = desc;
+        storage_desc.format = storage_format;
+        storage_desc.usage = rhi::TextureUsage::ShaderResource | rhi::TextureUsage::UnorderedAccess |
+                             rhi::TextureUsage::CopySource | rhi::TextureUsage::CopyDestination;
+        storage_desc.defaultState = rhi::ResourceState::ShaderResource;
+        storage_desc.label = nullptr;
+        cached.storage = create_tracked_texture(context, storage_desc, MemoryCategory::SCRATCH);
+        if (!cached.storage) return nullptr;
+    }
+
+    auto *target = cached.storage ? cached.storage.get() : texture;
+    const u32 layer_count = std::max(desc.arrayLength, 1u);
+    cached.views.reserve(static_cast<usize>(layer_count) * desc.mipCount);
+    for (u32 layer = 0; layer < layer_count; ++layer) {
+        for (u32 mip = 0; mip < desc.mipCount; ++mip) {
+            cached.views.push_back(create_texture_view(context, target, mip, layer));
+        }
+    }
+    hold(cached);
+    return &textures_.emplace_back(std::move(cached));
+}
+
+void MipGenerator::hold(const CachedViews &cached) {
+    // the entry's own references; views keep theirs internally, where reference counts do not see it
+    tracker_->hold(cached.texture.get());
+    if (cached.storage) tracker_->hold(cached.storage.get());
+}
+
+void MipGenerator::unhold(const CachedViews &cached) {
+    tracker_->unhold(cached.texture.get());
+    if (cached.storage) tracker_->unhold(cached.storage.get());
+}
+
+void MipGenerator::collect_locked() {
+    std::erase_if(textures_, [this](const CachedViews &cached) {
+        if (!tracker_->unused(cached.texture.get())) return false;
+        unhold(cached);
+        return true;
+    });
+}
+
+SlangResult MipGenerator::encode_single_pass(
+    Context &context,
+    rhi::ICommandEncoder *encoder,
+    const CachedViews &cached) {
+
+    const auto &desc = cached.texture->getDesc();
+    const auto storage_format = mip_storage_format(desc.format);
+    SmallString<32> pipeline_key{"generate_mips_spd_"};
+    pipeline_key.append(mip_format_name(storage_format));
+    auto pipeline = get_cached_pipeline_handle(pipeline_cache(context), pipeline_key, [&context, storage_format]() {
+        return create_spd_pipeline(context, storage_format);
+    });
+    if (!pipeline) return SLANG_E_NOT_AVAILABLE;
+
+    if (!counter_ || !mid_) {
+        const auto usage = rhi::BufferUsage::UnorderedAccess | rhi::BufferUsage::CopyDestination;
+        counter_ = create_scratch_buffer(context, sizeof(u32), usage);
+        mid_ = create_scratch_buffer(context, k_spd_max_tail_source * sizeof(f32x4), usage);
+        if (!counter_ || !mid_) return SLANG_E_OUT_OF_MEMORY;
+        // the kernel leaves the counter at zero, it only has to start there
+        encoder->clearBuffer(counter_.get());
+    }
+
+    const u32 srgb = cached.storage ? 1 : 0;
+    const auto view = [&](u32 layer, u32 mip) { return cached.views[layer * desc.mipCount + mip].get(); };
+    for (u32 layer = 0; layer < std::max(desc.arrayLength, 1u); ++layer) {
+        u32 level_count = 0;
+        for (u32 base = 0; base + 1 < desc.mipCount; base += level_count) {
+            const u32x2 src_size = mip_size(desc, base);
+            const u32 max_levels =
+                std::max(src_size.x, src_size.y) <= k_spd_max_tail_source ? k_spd_max_mips : k_spd_tile_levels;
+            level_count = std::min(desc.mipCount - 1 - base, max_levels);
+            const u32x2 group_count{
+                divide_and_round_up(src_size.x, k_spd_tile_size),
+                divide_and_round_up(src_size.y, k_spd_tile_size)};
+
+            auto *pass = encoder->beginComputePass();
+            auto *root_object = pass->bindPipeline(pipeline.pipeline.get());
+            const auto offsets = pipeline.offsets->resolve(root_object, k_spd_parameters);
+            if (offsets.empty()) {
+                pass->end();
+                return SLANG_E_INVALID_ARG;
+            }
+
+            SlangResult result = SLANG_OK;
+            const auto check = [&result](SlangResult r) {
+                if (SLANG_SUCCEEDED(result)) result = r;
+            };
+            check(root_object->setData(offsets[SPD_SRC_SIZE], &src_size, sizeof(src_size)));
+            check(root_object->setData(offsets[SPD_MIP_COUNT], &level_count, sizeof(level_count)));
+            check(root_object->setData(offsets[SPD_GROUP_COUNT], &group_count, sizeof(group_count)));
+            check(root_object->setData(offsets[SPD_SRGB], &srgb, sizeof(srgb)));
+            check(root_object->setBinding(offsets[SPD_SRC], rhi::Binding(view(layer, base))));
+            for (u32 i = 0; i < k_spd_max_mips; ++i) {
+                // slots past the chain repeat its last level, they are bound but never written
+                auto dst_offset = offsets[SPD_DST];
+                dst_offset.bindingArrayIndex = i;
+                check(root_object->setBinding(dst_offset, rhi::Binding(view(layer, base + 1 + std::min(i, level_count - 1)))));
+            }
+            check(root_object->setBinding(offsets[SPD_MID], rhi::Binding(mid_.get())));
+            check(root_object->setBinding(offsets[SPD_COUNTER], rhi::Binding(counter_.get())));
+            if (SLANG_SUCCEEDED(result)) pass->dispatchCompute(group_count.x, group_count.y, 1);
+            pass->end();
+            SLANG_RETURN_ON_FAIL(result);
+        }
+    }
+    return SLANG_OK;
+}
+
+SlangResult MipGenerator::encode_levels(
+    Context &context,
+    rhi::ICommandEncoder *encoder,
+    const CachedViews &cached,
+    MipFilter filter,
+    const LaunchConfig &tile) {
+
+    const auto &desc = cached.texture->getDesc();
+    const auto storage_format = mip_storage_format(desc.format);
+
+    /// generate pipeline key for cache
+    SmallString<48> pipeline_key{"generate_mips_"};
+    pipeline_key.append(
+        {mip_format_name(storage_format), "_", std::to_string(tile.group_size_x), "x", std::to_string(tile.group_size_y)});
+
+    auto pipeline = get_cached_pipeline_handle(pipeline_cache(context), pipeline_key,
+                                               [&context, storage_format, &tile]() {
+                                                   return create_generate_mips_pipeline(context, storage_format, tile);
+                                               });
+    if (!pipeline) return SLANG_FAIL;
+
+    const u32 filter_type = static_cast<u32>(filter);
+    const u32 srgb = cached.storage ? 1 : 0;
+    const auto view = [&](u32 layer, u32 mip) { return cached.views[layer * desc.mipCount + mip].get(); };
+    for (u32 layer = 0; layer < std::max(desc.arrayLength, 1u); ++layer) {
+        for (u32 mip = 1; mip < desc.mipCount; ++mip) {
+            const u32x2 src_size = mip_size(desc, mip - 1);
+            const u32x2 dst_size = mip_size(desc, mip);
+
+            auto *pass = encoder->beginComputePass();
+            auto *root_object = pass->bindPipeline(pipeline.pipeline.get());
+            const auto offsets = pipeline.offsets->resolve(root_object, k_generate_mips_parameters);
+            if (offsets.empty() ||
+                SLANG_FAILED(root_object->setData(offsets[GENERATE_MIPS_SRC_SIZE], &src_size, sizeof(src_size))) ||
+                SLANG_FAILED(root_object->setData(offsets[GENERATE_MIPS_DST_SIZE], &dst_size, sizeof(dst_size))) ||
+                SLANG_FAILED(root_object->setData(offsets[GENERATE_MIPS_FILTER], &filter_type, sizeof(filter_type))) ||
+                SLANG_FAILED(root_object->setData(offsets[GENERATE_MIPS_SRGB], &srgb, sizeof(srgb))) ||
+                SLANG_FAILED(root_object->setBinding(offsets[GENERATE_MIPS_SRC], rhi::Binding(view(layer, mip - 1)))) ||
+                SLANG_FAILED(root_object->setBinding(offsets[GENERATE_MIPS_DST], rhi::Binding(view(layer, mip))))) {
+                pass->end();
+                return SLANG_FAIL;
+            }
+            pass->dispatchCompute(
+                divide_and_round_up(dst_size.x, tile.group_size_x),
+                divide_and_round_up(dst_size.y, tile.group_size_y),
+                1);
+            pass->end();
+        }
+    }
+    return SLANG_OK;
+}
+
+SlangResult MipGenerator::encode_cached(
+    Context &context,
+    rhi::ICommandEncoder *encoder,
+    rhi::ITexture *texture,
+    MipFilter filter,
+    std::optional<LaunchConfig> tile) {
+
+    const auto &desc = texture->getDesc();
+    if (desc.mipCount <= 1) return SLANG_OK;
+    if (!mip_format_name(desc.format)) return SLANG_E_NOT_IMPLEMENTED;
+
+    std::scoped_lock lock(mutex_);
+    const auto *cached = views_of(context, texture);
+    if (!cached) return SLANG_E_OUT_OF_MEMORY;
+
+    // sRGB formats are not storable: the chain is generated in the linear copy and copied back
+    const rhi::SubresourceRange base_range{0, std::max(desc.arrayLength, 1u), 0, 1};
+    if (cached->storage) {
+        encoder->copyTexture(
+            cached->storage.get(), base_range, {}, texture, base_range, {}, {desc.size.width, desc.size.height, 1});
+    }
+
+    SlangResult result = SLANG_E_NOT_AVAILABLE;
+    if (!tile && filter == MipFilter::BOX && std::has_single_bit(desc.size.width) &&
+        std::has_single_bit(desc.size.height)) {
+        result = encode_single_pass(context, encoder, *cached);
+    }
+    if (result == SLANG_E_NOT_AVAILABLE) {
+        result = encode_levels(
+            context, encoder, *cached, filter, tile ? *tile : generate_mips_tile(context, mip_storage_format(desc.format)));
+    }
+    SLANG_RETURN_ON_FAIL(result);
+
+    if (cached->storage) {
+        for (u32 mip = 1; mip < desc.mipCount; ++mip) {
+            const auto size = mip_size(desc, mip);
+            const rhi::SubresourceRange range{0, base_range.layerCount, mip, 1};
+            encoder->copyTexture(texture, range, {}, cached->storage.get(), range, {}, {size.x, size.y, 1});
+        }
+    }
+    return SLANG_OK;
+}
+
+SlangResult MipGenerator::encode(
+    Context &context,
+    rhi::ICommandEncoder *encoder,
+    rhi::ITexture *texture,
+    MipFilter filter) {
+    return encode_cached(context, encoder, texture, filter, std::nullopt);
+}
+
+SlangResult MipGenerator::encode_per_level(
+    Context &context,
+    rhi::ICommandEncoder *encoder,
+    rhi::ITexture *texture,
+    MipFilter filter,
+    const LaunchConfig &tile) {
+    return encode_cached(context, encoder, texture, filter, tile);
+}
+
+void MipGenerator::release(rhi::ITexture *texture) {
+    std::scoped_lock lock(mutex_);
+    std::erase_if(textures_, [this, texture](const CachedViews &cached) {
+        if (cached.texture.get() != texture) return false;
+        unhold(cached);
+        return true;
+    });
+}
+
+void MipGenerator::collect() {
+    std::scoped_lock lock(mutex_);
+    collect_locked();
+}
+
+void MipGenerator::clear() {
+    std::scoped_lock lock(mutex_);
+    for (const auto &cached : textures_) unhold(cached);
+    textures_.clear();
+    counter_ = nullptr;
+    mid_ = nullptr;
+}
+
+usize MipGenerator::cached_texture_count() const {
+    std::scoped_lock lock(mutex_);
+    return textures_.size();
+}
+
+std::optional<LaunchConfig> tune_generate_mips(
+    Context &context,
+    rhi::Format format,
+    u32 width,
+    u32 height,
+    const TuneOptions &options) {
+
+    // the kernel only sees the storage format, sRGB chains run the linear one
+    format = mip_storage_format(format);
+    if (!mip_format_name(format) || width == 0 || height == 0) return std::nullopt;
+
+    rhi::TextureDesc desc{};
+    desc.type = rhi::TextureType::Texture2D;
+    desc.size.width = width;
+    desc.size.height = height;
+    desc.size.depth = 1;
+    desc.mipCount = compute_max_mip_count(width, height);
+    desc.arrayLength = 1;
+    desc.format = format;
+    desc.usage = mip_generation_usage(format);
+    desc.defaultState = rhi::ResourceState::ShaderResource;
+
+    auto texture = create_tracked_texture(context, desc);
+    if (!texture) return std::nullopt;
+
+    auto &generator = mip_generator(context);
+    auto result = autotune_launch(
+        context,
+        tuning_key(context, "generate_mips", mip_format_name(format)),
+        k_mip_tile_candidates,
+        [&context, &generator, &texture](const LaunchConfig &tile, rhi::ICommandEncoder *encoder) {
+            return generator.encode_per_level(context, encoder, texture.get(), MipFilter::BOX, tile);
+        },
+        options);
+    generator.release(texture.get());
+    return result;
+}
+
+} // namespace llc
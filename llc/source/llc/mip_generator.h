@@ -0,0 +1,106 @@
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <slang-com-ptr.h>
+#include <slang-rhi.h>
+
+#include <llc/autotune.h>
+#include <llc/context.h>
+#include <llc/texture.h>
+#include <llc/types.hpp>
+
+namespace llc {
+
+/// Name of `format` in mip generation pipeline keys, nullptr if mips cannot be generated for it.
+const char *mip_format_name(rhi::Format format) noexcept;
+/// Value of the `DST_FORMAT` specialization of the mip kernels, empty if there is none.
+std::string mip_format_specialization_expr(rhi::Format format);
+/// Format the mip kernels write for a texture of `format`: the format itself, or its linear
+/// counterpart for sRGB formats, which are not storable.
+rhi::Format mip_storage_format(rhi::Format format) noexcept;
+
+/// Mip generation, owned by the context: a single-pass kernel (see generate_mips_spd.slang) for
+/// box-filtered chains with power-of-two sides, one pass per level (see generate_mips.slang) for
+/// the rest.
+///
+/// Keeps the views of every mip of the textures it generated mips for, so regenerating a chain
+/// every frame creates no views. Cached views keep their texture alive; like `ViewCache`, the
+/// generator drops them once only it, the memory tracker and the other caches reference the
+/// texture, checked on every miss and on `collect`. Beyond `k_max_cached_textures` the least
+/// recently used texture is released anyway.
+struct MipGenerator final {
+    static constexpr usize k_max_cached_textures = 64;
+
+    /// `tracker` accounts the references the generator holds, it must outlive the generator.
+    explicit MipGenerator(MemoryTracker &tracker) noexcept : tracker_(&tracker) {}
+
+    /// Encodes the generation of mips [1, mipCount) of every layer from mip 0. Single-pass chains up
+    /// to 4096 texels on a side take one dispatch per layer, larger ones one more for every six
+    /// levels above. Returns SLANG_E_NOT_IMPLEMENTED for formats without mip generation.
+    SlangResult encode(
+        Context &context,
+        rhi::ICommandEncoder *encoder,
+        rhi::ITexture *texture,
+        MipFilter filter = MipFilter::BOX);
+
+    /// `encode` one pass per level, with the per-level kernel specialized for `tile`.
+    SlangResult encode_per_level(
+        Context &context,
+        rhi::ICommandEncoder *encoder,
+        rhi::ITexture *texture,
+        MipFilter filter,
+        const LaunchConfig &tile);
+
+    /// Drops the views of `texture` right away.
+    void release(rhi::ITexture *texture);
+    /// Drops the views of every texture the generator alone keeps alive.
+    void collect();
+    /// Releases every cached view and the buffers of the kernel.
+    void clear();
+    [[nodiscard]] usize cached_texture_count() const;
+
+private:
+    struct CachedViews final {
+        Slang::ComPtr<rhi::ITexture> texture;
+        /// linear copy the kernels write for sRGB textures, nullptr for the others
+        Slang::ComPtr<rhi::ITexture> storage;
+        /// layer * mipCount + mip, of `storage` if there is one
+        std::vector<Slang::ComPtr<rhi::ITextureView>> views;
+        u64 last_use = 0;
+    };
+
+    CachedViews *views_of(Context &context, rhi::ITexture *texture);
+    /// Reports the references `cached` holds to the tracker, or withdraws them.
+    void hold(const CachedViews &cached);
+    void unhold(const CachedViews &cached);
+    void collect_locked();
+    SlangResult encode_single_pass(
+        Context &context,
+        rhi::ICommandEncoder *encoder,
+        const CachedViews &cached);
+    SlangResult encode_levels(
+        Context &context,
+        rhi::ICommandEncoder *encoder,
+        const CachedViews &cached,
+        MipFilter filter,
+        const LaunchConfig &tile);
+    SlangResult encode_cached(
+        Context &context,
+        rhi::ICommandEncoder *encoder,
+        rhi::ITexture *texture,
+        MipFilter filter,
+        std::optional<LaunchConfig> tile);
+
+    MemoryTracker *tracker_;
+    mutable std::mutex mutex_;
+    std::vector<CachedViews> textures_;
+    u64 use_count_ = 0;
+    Slang::ComPtr<rhi::IBuffer> counter_;
+    Slang::ComPtr<rhi::IBuffer> mid_;
+};
+
+} // namespace llc
@@ -0,0 +1,172 @@
+#include "mirrored_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <llc/buffer.h>
+#include <llc/memory_tracker.h>
+
+namespace llc {
+
+namespace {
+
+SlangResult submit_signaling(rhi::ICommandQueue *queue, rhi::ICommandBuffer *command_buffer, rhi::IFence *fence, u64 value) {
+    rhi::SubmitDesc submit{};
+    submit.commandBuffers = &command_buffer;
+    submit.commandBufferCount = 1;
+    submit.signalFences = &fence;
+    submit.signalFenceValues = &value;
+    submit.signalFenceCount = 1;
+    return queue->submit(submit);
+}
+
+} // namespace
+
+void DirtyRanges::add(ByteRange range) {
+    if (range.begin >= range.end) return;
+
+    // first range that ends at or after `range` begins, i.e. the first one it can merge with
+    auto first = std::lower_bound(ranges_.begin(), ranges_.end(), range.begin, [](const ByteRange &r, u64 begin) {
+        return r.end < begin;
+    });
+    auto last = first;
+    while (last != ranges_.end() && last->begin <= range.end) {
+        range.begin = std::min(range.begin, last->begin);
+        range.end = std::max(range.end, last->end);
+        ++last;
+    }
+
+    if (first == last) {
+        ranges_.insert(first, range);
+    } else {
+        *first = range;
+        ranges_.erase(first + 1, last);
+    }
+}
+
+u64 DirtyRanges::byte_count() const noexcept {
+    u64 count = 0;
+    for (const auto &range : ranges_) count += range.size();
+    return count;
+}
+
+std::optional<MirroredBytes> MirroredBytes::create(Context &context, u64 byte_size, const MirrorOptions &options) {
+    if (byte_size == 0) return std::nullopt;
+
+    MirroredBytes mirror;
+    mirror.context_ = &context;
+    mirror.options_ = options;
+    mirror.shadow_.assign(byte_size, byte{0});
+    mirror.buffer_ = create_buffer(context, byte_size, options.usage | rhi::BufferUsage::CopyDestination, mirror.shadow_.data());
+    if (!mirror.buffer_) return std::nullopt;
+    return mirror;
+}
+
+std::vector<ByteRange> upload_ranges(const DirtyRanges &dirty, u64 byte_size, const MirrorOptions &options) {
+    if (dirty.empty()) return {};
+    if (static_cast<f64>(dirty.byte_count()) >= static_cast<f64>(options.full_upload_ratio) * static_cast<f64>(byte_size)) {
+        return {ByteRange{0, byte_size}};
+    }
+
+    // coalesce ranges separated by less than the merge gap into one upload
+    std::vector<ByteRange> uploads;
+    const auto ranges = dirty.ranges();
+    ByteRange pending = ranges.front();
+    for (const auto &range : ranges.subspan(1)) {
+        if (range.begin - pending.end < options.merge_gap) {
+            pending.end = range.end;
+        } else {
+            uploads.push_back(pending);
+            pending = range;
+        }
+    }
+    uploads.push_back(pending);
+    return uploads;
+}
+
+void MirroredBytes::flush(rhi::ICommandEncoder *encoder) {
+    for (const auto &range : upload_ranges(dirty_, shadow_.size(), options_)) {
+        encoder->uploadBufferData(buffer_.get(), range.begin, range.size(), shadow_.data() + range.begin);
+    }
+    dirty_.clear();
+}
+
+SlangResult MirroredBytes::flush() {
+    if (dirty_.empty()) return SLANG_OK;
+
+    auto *queue = context_->queue();
+    auto encoder = queue->createCommandEncoder();
+    flush(encoder.get());
+    Slang::ComPtr<rhi::ICommandBuffer> command_buffer;
+    SLANG_RETURN_ON_FAIL(encoder->finish(command_buffer.writeRef()));
+    return queue->submit(command_buffer.get());
+}
+
+SlangResult MirroredBytes::begin_download() {
+    auto *device = context_->device();
+    if (!readback_) {
+        readback_ = create_buffer(
+            *context_,
+            shadow_.size(),
+            rhi::BufferUsage::CopyDestination,
+            nullptr,
+            rhi::MemoryType::ReadBack,
+            rhi::ResourceState::CopyDestination);
+        if (!readback_) return SLANG_E_OUT_OF_MEMORY;
+    }
+    if (!fence_) SLANG_RETURN_ON_FAIL(device->createFence(rhi::FenceDesc{}, fence_.writeRef()));
+
+    auto *queue = context_->queue();
+    auto encoder = queue->createCommandEncoder();
+    encoder->copyBuffer(readback_.get(), 0, buffer_.get(), 0, shadow_.size());
+    Slang::ComPtr<rhi::ICommandBuffer> command_buffer;
+    SLANG_RETURN_ON_FAIL(encoder->finish(command_buffer.writeRef()));
+    SLANG_RETURN_ON_FAIL(submit_signaling(queue, command_buffer.get(), fence_.get(), fence_value_ + 1));
+    download_value_ = ++fence_value_;
+    // ranges still dirty reach the device after the copy, even if they are flushed before it runs
+    written_ = dirty_;
+    return SLANG_OK;
+}
+
+bool MirroredBytes::download_ready() const {
+    if (download_value_ == 0) return false;
+    u64 completed = 0;
+    return SLANG_SUCCEEDED(fence_->getCurrentValue(&completed)) && completed >= download_value_;
+}
+
+bool MirroredBytes::end_download(bool wait) {
+    if (download_value_ == 0) return false;
+
+    auto *device = context_->device();
+    if (wait) {
+        rhi::IFence *fence = fence_.get();
+        if (SLANG_FAILED(device->waitForFences(1, &fence, &download_value_, true, rhi::kTimeoutInfinite))) return false;
+    } else if (!download_ready()) {
+        return false;
+    }
+    download_value_ = 0;
+    collect_memory(*context_);
+    const auto written = std::exchange(written_, DirtyRanges{});
+
+    void *mapped = nullptr;
+    if (SLANG_FAILED(device->mapBuffer(readback_.get(), rhi::CpuAccessMode::Read, &mapped))) return false;
+    const auto *source = static_cast<const byte *>(mapped);
+
+    // everything but the ranges the host wrote since, which are newer than the device copy whether
+    // or not they were flushed
+    u64 begin = 0;
+    const auto copy_until = [&](u64 end) {
+        if (end > begin) std::memcpy(shadow_.data() + begin, source + begin, end - begin);
+    };
+    for (const auto &range : written.ranges()) {
+        copy_until(range.begin);
+        begin = range.end;
+    }
+    copy_until(shadow_.size());
+
+    device->unmapBuffer(readback_.get());
+    return true;
+}
+
+} // namespace llc
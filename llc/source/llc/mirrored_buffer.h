@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cassert>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <slang-com-ptr.h>
+#include <slang-rhi.h>
+
+#include <llc/context.h>
+#include <llc/types.hpp>
+
+namespace llc {
+
+/// Half-open byte range [begin, end).
+struct ByteRange final {
+    u64 begin = 0;
+    u64 end = 0;
+
+    [[nodiscard]] u64 size() const noexcept { return end - begin; }
+    bool operator==(const ByteRange &) const = default;
+};
+
+/// Sorted, disjoint byte ranges; overlapping and touching ranges are merged on insert.
+struct DirtyRanges final {
+    void add(ByteRange range);
+    void clear() noexcept { ranges_.clear(); }
+
+    [[nodiscard]] bool empty() const noexcept { return ranges_.empty(); }
+    [[nodiscard]] std::span<const ByteRange> ranges() const noexcept { return ranges_; }
+    [[nodiscard]] u64 byte_count() const noexcept;
+
+private:
+    std::vector<ByteRange> ranges_;
+};
+
+struct MirrorOptions final {
+    /// Dirty ranges closer than this are uploaded as one copy, gap included, since a few extra bytes
+    /// are cheaper than another copy command. Use 0 if the device writes the buffer as well, the
+    /// gap would overwrite what it wrote with the host copy.
+    u64 merge_gap = 256;
+    /// Upload everything in one copy once this fraction of the buffer is dirty.
+    f32 full_upload_ratio = 0.5f;
+    rhi::BufferUsage usage = rhi::BufferUsage::ShaderResource | rhi::BufferUsage::UnorderedAccess |
+                             rhi::BufferUsage::CopySource | rhi::BufferUsage::CopyDestination;
+};
+
+/// Copies `MirroredBytes::flush` encodes for `dirty` in a buffer of `byte_size` bytes: the whole
+/// buffer past `options.full_upload_ratio`, otherwise the dirty ranges with the gaps shorter than
+/// `options.merge_gap` between them included.
+std::vector<ByteRange> upload_ranges(const DirtyRanges &dirty, u64 byte_size, const MirrorOptions &options);
+
+/// Untyped part of `MirroredBuffer<T>`.
+struct MirroredBytes final {
+    static std::optional<MirroredBytes> create(Context &context, u64 byte_size, const MirrorOptions &options);
+
+    [[nodiscard]] std::span<byte> host() noexcept { return shadow_; }
+    [[nodiscard]] std::span<const byte> host() const noexcept { return shadow_; }
+    [[nodiscard]] rhi::IBuffer *buffer() const noexcept { return buffer_.get(); }
+    [[nodiscard]] const DirtyRanges &dirty() const noexcept { return dirty_; }
+
+    void mark_dirty(ByteRange range) {
+        assert(range.end <= shadow_.size());
+        dirty_.add(range);
+        if (download_value_ != 0) written_.add(range);
+    }
+
+    /// Encodes the uploads of the dirty ranges and clears them.
+    void flush(rhi::ICommandEncoder *encoder);
+    SlangResult flush();
+
+    /// Copies the device buffer into a host-visible one and submits it without waiting.
+    SlangResult begin_download();
+    [[nodiscard]] bool download_pending() const noexcept { return download_value_ != 0; }
+    /// Whether the last `begin_download` has completed on the device.
+    [[nodiscard]] bool download_ready() const;
+    /// Copies the downloaded data into the shadow, keeping the ranges that were dirty when it began
+    /// or written since, flushed or not. Waits for the device unless `wait` is false, in which
+    /// case it returns false if the copy is not ready yet.
+    bool end_download(bool wait = true);
+
+private:
+    MirroredBytes() = default;
+
+    Context *context_ = nullptr;
+    MirrorOptions options_;
+    std::vector<byte> shadow_;
+    DirtyRanges dirty_;
+    /// ranges dirty at `begin_download` or written since, newer than the download; unlike
+    /// `dirty_` they are kept through `flush`
+    DirtyRanges written_;
+    Slang::ComPtr<rhi::IBuffer> buffer_;
+    Slang::ComPtr<rhi::IBuffer> readback_;
+    Slang::ComPtr<rhi::IFence> fence_;
+    u64 fence_value_ = 0;
+    /// fence value of the download in flight, 0 if none
+    u64 download_value_ = 0;
+};
+
+/// A device buffer with a host copy that the CPU edits sparsely between dispatches.
+///
+/// Writes through `write`/`set` mark their range dirty; `flush` uploads only the dirty ranges,
+/// coalesced, and is meant to be encoded ahead of the dispatches reading the buffer. The device
+/// buffer starts out equal to the shadow, i.e. zeroed.
+template <standard_layout T>
+struct MirroredBuffer final {
+    static std::optional<MirroredBuffer> create(Context &context, usize count, const MirrorOptions &options = {}) {
+        auto bytes = MirroredBytes::create(context, count * sizeof(T), options);
+        if (!bytes) return std::nullopt;
+        return MirroredBuffer(std::move(*bytes));
+    }
+
+    [[nodiscard]] usize size() const noexcept { return bytes_.host().size() / sizeof(T); }
+    [[nodiscard]] rhi::IBuffer *buffer() const noexcept { return bytes_.buffer(); }
+
+    /// Read-only view of the host copy.
+    [[nodiscard]] std::span<const T> host() const noexcept {
+        const auto data = bytes_.host();
+        return {reinterpret_cast<const T *>(data.data()), size()};
+    }
+
+    /// Marks `[first, first + count)` dirty and returns it for writing.
+    std::span<T> write(usize first, usize count) {
+        assert(first + count <= size());
+        bytes_.mark_dirty({first * sizeof(T), (first + count) * sizeof(T)});
+        return {reinterpret_cast<T *>(bytes_.host().data()) + first, count};
+    }
+
+    void set(usize index, const T &value) { write(index, 1)[0] = value; }
+
+    void flush(rhi::ICommandEncoder *encoder) { bytes_.flush(encoder); }
+    /// Uploads the dirty ranges in a submission of its own.
+    SlangResult flush() { return bytes_.flush(); }
+
+    [[nodiscard]] const DirtyRanges &dirty() const noexcept { return bytes_.dirty(); }
+
+    /// Device to host: copies the device buffer back without blocking, `end_download` applies it.
+    SlangResult begin_download() { return bytes_.begin_download(); }
+    [[nodiscard]] bool download_ready() const { return bytes_.download_ready(); }
+    bool end_download(bool wait = true) { return bytes_.end_download(wait); }
+
+private:
+    explicit MirroredBuffer(MirroredBytes bytes) : bytes_(std::move(bytes)) {}
+
+    MirroredBytes bytes_;
+};
+
+} // namespace llc
@@ -1,30 +1,70 @@
 #include "reduce.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include <slang-rhi/shader-cursor.h>
 
 #include <llc/scalar_types.hpp>
+#include <llc/autotune.h>
 #include <llc/blob.h>
 #include <llc/buffer.h>
 #include <llc/math.h>
+#include <llc/memory_tracker.h>
 #include <llc/texture.h>
+#include <llc/pp/reduce_host.h>
 
 #include <llc/utils/embedded_module.h>
 #include <llc/utils/pipeline_cache.h>
+#include <llc/utils/small_vector.h>
 
 extern "C" const llc::u8 _binary_reduce_slang_module_start[]; // NOLINT(readability-identifier-naming)
 extern "C" const llc::u8 _binary_reduce_slang_module_end[];   // NOLINT(readability-identifier-naming)
 
+LLC_DECLARE_EMBEDDED_MODULE(reduce_config_float)
+LLC_DECLARE_EMBEDDED_MODULE(reduce_config_half)
+LLC_DECLARE_EMBEDDED_MODULE(reduce_config_float2)
+LLC_DECLARE_EMBEDDED_MODULE(reduce_config_float3)
+LLC_DECLARE_EMBEDDED_MODULE(reduce_config_float4)
+LLC_DECLARE_EMBEDDED_MODULE(reduce_config_half2)
+LLC_DECLARE_EMBEDDED_MODULE(reduce_config_half3)
+LLC_DECLARE_EMBEDDED_MODULE(reduce_config_half4)
+LLC_DECLARE_EMBEDDED_MODULE(reduce_texture_config_float)
+LLC_DECLARE_EMBEDDED_MODULE(reduce_texture_config_float4)
+LLC_DECLARE_EMBEDDED_MODULE(reduce_texture_config_float_array)
+LLC_DECLARE_EMBEDDED_MODULE(reduce_texture_config_float4_array)
+LLC_DECLARE_EMBEDDED_MODULE(reduce_texture_config_float_3d)
+LLC_DECLARE_EMBEDDED_MODULE(reduce_texture_config_float4_3d)
+
 namespace llc::pp {
 
 namespace {
 
 using namespace llc::types;
 
-constexpr usize k_thread_group_size = 256;
+constexpr LaunchConfig k_default_launch{.group_size_x = 256, .group_size_y = 1, .items_per_thread = 2};
+/// Scratch sizes are computed for this many elements per group, so tuned launches never cover fewer.
+constexpr usize k_min_group_item_count = 512;
+constexpr u32 k_warp_size = 32;
+
+constexpr LaunchConfig k_launch_candidates[] = {
+    {64, 1, 8},
+    {128, 1, 4},
+    {128, 1, 8},
+    {256, 1, 2},
+    {256, 1, 4},
+    {256, 1, 8},
+    {512, 1, 1},
+    {512, 1, 2},
+    {512, 1, 4},
+    {1024, 1, 1},
+    {1024, 1, 2},
+    {1024, 1, 4},
+};
 
 template <typename T>
 struct ReduceTypeInfo;
@@ -32,82 +72,111 @@ struct ReduceTypeInfo;
 template <typename T>
 struct ReduceTextureTypeInfo;
 
-#define LLC_REDUCE_CONFIG(slang_type)                                            \
-    "import reduce;\n"                                                           \
-    "struct Impl : IReduceElement {\n"                                           \
-    "    " slang_type " value;\n"                                                \
-    "    __init(int v) { value = " slang_type "(v); }\n"                         \
-    "    __init(" slang_type " v) { value = v; }\n"                              \
-    "    This dadd(This other) { return This(value + other.value); }\n"          \
-    "    static This waveSum(This a) { return This(WaveActiveSum(a.value)); }\n" \
-    "};\n"                                                                       \
-    "export struct ReduceElement : IReduceElement = Impl;\n"
-
-#define LLC_REDUCE_TEXTURE_CONFIG(reduce_module_name, texel_type)                  \
-    "import " reduce_module_name ";\n"                                             \
-    "export struct ReduceTexture {\n"                                              \
-    "    Texture2D<" texel_type "> texture;\n"                                     \
-    "    ReduceElement load(uint2 sourceSize, uint index) {\n"                     \
-    "        if (index >= sourceSize.x * sourceSize.y) return ReduceElement(0);\n" \
-    "        uint x = index % sourceSize.x;\n"                                     \
-    "        uint y = index / sourceSize.x;\n"                                     \
-    "        return ReduceElement(texture.Load(int3(int(x), int(y), 0)));\n"       \
-    "    }\n"                                                                      \
-    "};\n"
-
-#define LLC_DEFINE_REDUCE_TYPE_INFO(shader_type, cpp_type)                         \
-    template <>                                                                    \
-    struct ReduceTypeInfo<cpp_type> final {                                        \
-        static constexpr const char *k_slang_type = shader_type;                   \
-        static constexpr usize k_byte_size = sizeof(cpp_type);                     \
-        static constexpr const char *k_config_name = "reduce_config_" shader_type; \
-        static constexpr const char *k_config_source =                             \
-            LLC_REDUCE_CONFIG(shader_type);                                        \
+// element and texture configurations are compiled to IR at build time (shader/pp/reduce_*config_*.slang),
+// so creating a pipeline only loads and links embedded modules
+#define LLC_DEFINE_REDUCE_TYPE_INFO(shader_type, cpp_type, module_name)                          \
+    template <>                                                                                  \
+    struct ReduceTypeInfo<cpp_type> final {                                                      \
+        static constexpr const char *k_slang_type = shader_type;                                 \
+        static constexpr usize k_byte_size = sizeof(cpp_type);                                   \
+        static constexpr EmbeddedModuleDesc k_config = LLC_EMBEDDED_MODULE_DESC(module_name);    \
     }
 
-LLC_DEFINE_REDUCE_TYPE_INFO("float", f32);
-LLC_DEFINE_REDUCE_TYPE_INFO("half", f16);
-LLC_DEFINE_REDUCE_TYPE_INFO("float2", f32x2);
-LLC_DEFINE_REDUCE_TYPE_INFO("float3", f32x3);
-LLC_DEFINE_REDUCE_TYPE_INFO("vector<half, 2>", f16x2);
-LLC_DEFINE_REDUCE_TYPE_INFO("vector<half, 3>", f16x3);
-LLC_DEFINE_REDUCE_TYPE_INFO("vector<half, 4>", f16x4);
-
-template <>
-struct ReduceTypeInfo<f32x4> final {
-    static constexpr const char *k_slang_type = "float4";
-    static constexpr usize k_byte_size = sizeof(f32x4);
-    static constexpr const char *k_config_name = "reduce_config_float4";
-    static constexpr const char *k_config_source =
-        "import reduce;\n"
-        "export struct ReduceElement : IReduceElement {\n"
-        "    float4 value;\n"
-        "    __init(int v) { value = float4(v); }\n"
-        "    __init(float4 v) { value = v; }\n"
-        "    This dadd(This other) { return This(value + other.value); }\n"
-        "    static This waveSum(This a) { return This(WaveActiveSum(a.value)); }\n"
-        "};\n";
-};
+LLC_DEFINE_REDUCE_TYPE_INFO("float", f32, reduce_config_float);
+LLC_DEFINE_REDUCE_TYPE_INFO("half", f16, reduce_config_half);
+LLC_DEFINE_REDUCE_TYPE_INFO("float2", f32x2, reduce_config_float2);
+LLC_DEFINE_REDUCE_TYPE_INFO("float3", f32x3, reduce_config_float3);
+LLC_DEFINE_REDUCE_TYPE_INFO("float4", f32x4, reduce_config_float4);
+LLC_DEFINE_REDUCE_TYPE_INFO("vector<half, 2>", f16x2, reduce_config_half2);
+LLC_DEFINE_REDUCE_TYPE_INFO("vector<half, 3>", f16x3, reduce_config_half3);
+LLC_DEFINE_REDUCE_TYPE_INFO("vector<half, 4>", f16x4, reduce_config_half4);
+
+/// texture types `reduce_texture` reads, each with a configuration module of its own
+enum TextureShape : u32 { TEXTURE_SHAPE_2D, TEXTURE_SHAPE_2D_ARRAY, TEXTURE_SHAPE_3D };
+
+std::optional<TextureShape> texture_shape(rhi::TextureType type) noexcept {
+    switch (type) {
+        case rhi::TextureType::Texture2D:
+            return TEXTURE_SHAPE_2D;
+        case rhi::TextureType::Texture2DArray:
+            return TEXTURE_SHAPE_2D_ARRAY;
+        case rhi::TextureType::Texture3D:
+            return TEXTURE_SHAPE_3D;
+        default:
+            return std::nullopt;
+    }
+}
 
-#define LLC_DEFINE_REDUCE_TEXTURE_TYPE_INFO(cpp_type, format, shader_type)                 \
-    template <>                                                                            \
-    struct ReduceTextureTypeInfo<cpp_type> final {                                         \
-        static constexpr auto k_format = format;                                           \
-        static constexpr const char *k_config_name = "reduce_texture_config_" shader_type; \
-        static constexpr const char *k_config_source =                                     \
-            LLC_REDUCE_TEXTURE_CONFIG("reduce_config_" shader_type, shader_type);          \
-        static constexpr const char *k_pipeline_key = "reduce_texture_" shader_type;       \
+constexpr std::array<const char *, 3> k_texture_shape_suffixes{"", "_array", "_3d"};
+
+// the first format is the one the host path reduces; the others read as float too and are
+// converted to it on the host
+#define LLC_DEFINE_REDUCE_TEXTURE_TYPE_INFO(cpp_type, shader_type, module_name, ...)             \
+    template <>                                                                                  \
+    struct ReduceTextureTypeInfo<cpp_type> final {                                               \
+        static constexpr std::array k_formats{__VA_ARGS__};                                      \
+        /* indexed by TextureShape */                                                            \
+        static constexpr std::array<EmbeddedModuleDesc, 3> k_configs{                            \
+            LLC_EMBEDDED_MODULE_DESC(module_name),                                               \
+            LLC_EMBEDDED_MODULE_DESC(module_name##_array),                                       \
+            LLC_EMBEDDED_MODULE_DESC(module_name##_3d)};                                         \
+        static constexpr const char *k_pipeline_key = "reduce_texture_" shader_type;             \
     }
 
-LLC_DEFINE_REDUCE_TEXTURE_TYPE_INFO(f32, rhi::Format::R32Float, "float");
-LLC_DEFINE_REDUCE_TEXTURE_TYPE_INFO(f32x4, rhi::Format::RGBA32Float, "float4");
+LLC_DEFINE_REDUCE_TEXTURE_TYPE_INFO(
+    f32, "float", reduce_texture_config_float,
+    rhi::Format::R32Float, rhi::Format::R16Float, rhi::Format::R16Unorm);
+LLC_DEFINE_REDUCE_TEXTURE_TYPE_INFO(
+    f32x4, "float4", reduce_texture_config_float4,
+    rhi::Format::RGBA32Float, rhi::Format::RGBA16Float, rhi::Format::RGBA16Unorm);
+
+#undef LLC_DEFINE_REDUCE_TYPE_INFO
+#undef LLC_DEFINE_REDUCE_TEXTURE_TYPE_INFO
+
+template <typename T>
+bool is_reduce_texture_format(rhi::Format format) noexcept {
+    return std::ranges::find(ReduceTextureTypeInfo<T>::k_formats, format) != ReduceTextureTypeInfo<T>::k_formats.end();
+}
+
+/// The reduce kernels keep the group's wave sums in one wave, see reduce.slang.
+bool is_valid_reduce_launch(const LaunchConfig &launch) noexcept {
+    return launch.group_size_y == 1 && launch.group_size_x % k_warp_size == 0 &&
+           launch.group_size_x <= k_warp_size * k_warp_size && launch.items_per_thread > 0 &&
+           static_cast<usize>(launch.group_size_x) * launch.items_per_thread >= k_min_group_item_count;
+}
+
+LaunchConfig reduce_launch_config(Context &context, std::string_view kernel, std::string_view type) {
+    const auto tuned = tuning_profile(context).find(tuning_key(context, kernel, type));
+    return tuned && is_valid_reduce_launch(*tuned) ? *tuned : k_default_launch;
+}
+
+std::string launch_suffix(const LaunchConfig &launch) {
+    return "_" + std::to_string(launch.group_size_x) + "x" + std::to_string(launch.items_per_thread);
+}
+
+slang::IModule *load_source_module(slang::ISession *session, const char *name, const char *source) {
+    Slang::ComPtr<slang::IBlob> diagnostics;
+    slang::IModule *module = session->loadModuleFromSourceString(name, name, source, diagnostics.writeRef());
+    diagnose_if_needed(diagnostics.get());
+    return module;
+}
+
+/// Exports the link-time launch constants declared `extern` in reduce.slang. Only tuned launches need
+/// one, so this is the only Slang source parsed at runtime and never for the default launch.
+slang::IModule *load_launch_module(slang::ISession *session, const LaunchConfig &launch) {
+    const auto name = "reduce_launch" + launch_suffix(launch);
+    const auto source = "export static const uint THREAD_GROUP_SIZE = " + std::to_string(launch.group_size_x) +
+                        ";\nexport static const uint ITEMS_PER_THREAD = " +
+                        std::to_string(launch.items_per_thread) + ";\n";
+    return load_source_module(session, name.c_str(), source.c_str());
+}
 
 Slang::ComPtr<rhi::IComputePipeline> create_linked_pipeline(
     Context &context,
     slang::IModule *main_module,
-    const std::string &config_name,
-    const std::string &config_source,
+    const EmbeddedModuleDesc &config,
     const char *entry_point_name,
+    const LaunchConfig &launch,
     const slang::SpecializationArg *specialization_args = nullptr,
     usize specialization_arg_count = 0) {
 
@@ -115,15 +184,18 @@ Slang::ComPtr<rhi::IComputePipeline> create_linked_pipeline(
     auto *session = context.slang_session();
     if (!device || !session || !main_module) return nullptr;
 
-    Slang::ComPtr<slang::IBlob> diagnostics;
-    slang::IModule *config_module = session->loadModuleFromSourceString(
-        config_name.c_str(),
-        config_name.c_str(),
-        config_source.c_str(),
-        diagnostics.writeRef());
-    diagnose_if_needed(diagnostics.get());
+    auto config_module = load_embedded_module(context, config);
     if (!config_module) return nullptr;
 
+    SmallVector<slang::IComponentType *, 4> components{main_module, config_module.get()};
+    if (launch != k_default_launch) {
+        slang::IModule *launch_module = load_launch_module(session, launch);
+        if (!launch_module) return nullptr;
+        components.push_back(launch_module);
+    }
+
+    Slang::ComPtr<slang::IBlob> diagnostics;
+
     Slang::ComPtr<slang::IEntryPoint> entry_point;
     if (SLANG_FAILED(main_module->findEntryPointByName(entry_point_name, entry_point.writeRef()))) {
         return nullptr;
@@ -145,12 +217,12 @@ Slang::ComPtr<rhi::IComputePipeline> create_linked_pipeline(
         entry_point_component = specialized_entry_point.get();
     }
 
-    slang::IComponentType *components[] = {main_module, config_module, entry_point_component};
+    components.push_back(entry_point_component);
     Slang::ComPtr<slang::IComponentType> composed;
     diagnostics = nullptr;
     if (SLANG_FAILED(session->createCompositeComponentType(
-            components,
-            std::size(components),
+            components.data(),
+            static_cast<SlangInt>(components.size()),
             composed.writeRef(),
             diagnostics.writeRef()))) {
         diagnose_if_needed(diagnostics.get());
@@ -173,7 +245,10 @@ Slang::ComPtr<rhi::IComputePipeline> create_linked_pipeline(
 }
 
 template <typename T>
-Slang::ComPtr<rhi::IComputePipeline> create_linked_texture_pipeline(Context &context) {
+Slang::ComPtr<rhi::IComputePipeline> create_linked_texture_pipeline(
+    Context &context,
+    TextureShape shape,
+    const LaunchConfig &launch) {
     using ReduceInfo = ReduceTypeInfo<T>;
     using TextureInfo = ReduceTextureTypeInfo<T>;
     auto *device = context.device();
@@ -187,22 +262,10 @@ Slang::ComPtr<rhi::IComputePipeline> create_linked_texture_pipeline(Context &con
                                                 });
     if (!reduce) return nullptr;
 
-    Slang::ComPtr<slang::IBlob> diagnostics;
-    slang::IModule *reduce_element_module = session->loadModuleFromSourceString(
-        ReduceInfo::k_config_name,
-        ReduceInfo::k_config_name,
-        ReduceInfo::k_config_source,
-        diagnostics.writeRef());
-    diagnose_if_needed(diagnostics.get());
+    // the texture configuration imports the element configuration, which has to be loaded first
+    auto reduce_element_module = load_embedded_module(context, ReduceInfo::k_config);
     if (!reduce_element_module) return nullptr;
-
-    diagnostics = nullptr;
-    slang::IModule *texture_module = session->loadModuleFromSourceString(
-        TextureInfo::k_config_name,
-        TextureInfo::k_config_name,
-        TextureInfo::k_config_source,
-        diagnostics.writeRef());
-    diagnose_if_needed(diagnostics.get());
+    auto texture_module = load_embedded_module(context, TextureInfo::k_configs[shape]);
     if (!texture_module) return nullptr;
 
     Slang::ComPtr<slang::IEntryPoint> entry_point;
@@ -210,12 +273,19 @@ Slang::ComPtr<rhi::IComputePipeline> create_linked_texture_pipeline(Context &con
         return nullptr;
     }
 
-    slang::IComponentType *components[] = {reduce.get(), reduce_element_module, texture_module, entry_point.get()};
+    SmallVector<slang::IComponentType *, 5> components{reduce.get(), reduce_element_module.get(), texture_module.get()};
+    if (launch != k_default_launch) {
+        slang::IModule *launch_module = load_launch_module(session, launch);
+        if (!launch_module) return nullptr;
+        components.push_back(launch_module);
+    }
+    components.push_back(entry_point.get());
+
+    Slang::ComPtr<slang::IBlob> diagnostics;
     Slang::ComPtr<slang::IComponentType> composed;
-    diagnostics = nullptr;
     if (SLANG_FAILED(session->createCompositeComponentType(
-            components,
-            std::size(components),
+            components.data(),
+            static_cast<SlangInt>(components.size()),
             composed.writeRef(),
             diagnostics.writeRef()))) {
         diagnose_if_needed(diagnostics.get());
@@ -237,24 +307,34 @@ Slang::ComPtr<rhi::IComputePipeline> create_linked_texture_pipeline(Context &con
     return device->createComputePipeline(desc);
 }
 
-constexpr usize next_reduce_count(usize count) noexcept {
-    return divide_and_round_up(count, k_thread_group_size * 2);
+constexpr usize next_reduce_count(usize count, const LaunchConfig &launch) noexcept {
+    return divide_and_round_up(count, static_cast<usize>(launch.group_size_x) * launch.items_per_thread);
 }
 
+/// parameters of the `reduce` entry point, in the order of `k_reduce_parameters`
+enum ReduceParameter : u32 { REDUCE_SOURCE, REDUCE_RESULT };
+constexpr std::array<const char *, 2> k_reduce_parameters{"source", "result"};
+
+/// parameters of the `reduce_texture` entry point, in the order of `k_reduce_texture_parameters`
+enum ReduceTextureParameter : u32 { REDUCE_TEXTURE_SOURCE_SIZE, REDUCE_TEXTURE_SOURCE, REDUCE_TEXTURE_RESULT };
+constexpr std::array<const char *, 3> k_reduce_texture_parameters{"sourceSize", "source.texture", "result"};
+
 SlangResult encode_buffer_pass(
     rhi::ICommandEncoder *encoder,
-    rhi::IComputePipeline *pipeline,
+    const PipelineHandle &pipeline,
     rhi::IBuffer *source, u64 count,
-    rhi::IBuffer *result, u32 element_byte_size) {
+    rhi::IBuffer *result, u32 element_byte_size,
+    const LaunchConfig &launch) {
 
-    const u32 group_count = next_reduce_count(count);
+    const auto group_count = static_cast<u32>(next_reduce_count(count, launch));
     auto *pass = encoder->beginComputePass();
-    auto root_object = pass->bindPipeline(pipeline);
-    auto cursor = rhi::ShaderCursor(root_object);
-    SLANG_RETURN_ON_FAIL(
-        cursor["source"].setBinding(rhi::Binding(source, rhi::BufferRange{0, count * element_byte_size})));
-    SLANG_RETURN_ON_FAIL(
-        cursor["result"].setBinding(rhi::Binding(result, rhi::BufferRange{0, group_count * element_byte_size})));
+    auto *root_object = pass->bindPipeline(pipeline.pipeline.get());
+    const auto offsets = pipeline.offsets->resolve(root_object, k_reduce_parameters);
+    if (offsets.empty()) return SLANG_FAIL;
+    SLANG_RETURN_ON_FAIL(root_object->setBinding(
+        offsets[REDUCE_SOURCE], rhi::Binding(source, rhi::BufferRange{0, count * element_byte_size})));
+    SLANG_RETURN_ON_FAIL(root_object->setBinding(
+        offsets[REDUCE_RESULT], rhi::Binding(result, rhi::BufferRange{0, group_count * element_byte_size})));
     pass->dispatchCompute(group_count, 1, 1);
     pass->end();
     return SLANG_OK;
@@ -265,52 +345,50 @@ SlangResult encode_texture_pass(
     Context &context,
     rhi::ICommandEncoder *encoder,
     rhi::ITexture *source,
+    TextureShape shape,
     u64 count,
-    rhi::IBuffer *result) {
+    rhi::IBuffer *result,
+    const LaunchConfig &launch) {
 
     using Info = ReduceTextureTypeInfo<T>;
-    auto pipeline = get_cached_pipeline(
+    auto pipeline = get_cached_pipeline_handle(
         pipeline_cache(context),
-        Info::k_pipeline_key,
-        [&context]() { return create_linked_texture_pipeline<T>(context); });
+        Info::k_pipeline_key + std::string(k_texture_shape_suffixes[shape]) + launch_suffix(launch),
+        [&context, shape, &launch]() { return create_linked_texture_pipeline<T>(context, shape, launch); });
     if (!pipeline) return SLANG_FAIL;
 
     using ReduceInfo = ReduceTypeInfo<T>;
-    const auto group_count = static_cast<u32>(next_reduce_count(count));
+    const auto group_count = static_cast<u32>(next_reduce_count(count, launch));
     const auto &desc = source->getDesc();
-    const u32x2 source_size{desc.size.width, desc.size.height};
+    const u32x3 source_size{desc.size.width, desc.size.height, texture_layer_count(desc)};
 
     auto *pass = encoder->beginComputePass();
-    auto root_object = pass->bindPipeline(pipeline.get());
-    auto cursor = rhi::ShaderCursor(root_object);
-    SLANG_RETURN_ON_FAIL(cursor["sourceSize"].setData(source_size));
-    SLANG_RETURN_ON_FAIL(cursor["source"]["texture"].setBinding(source));
-    SLANG_RETURN_ON_FAIL(cursor["result"].setBinding(
+    auto *root_object = pass->bindPipeline(pipeline.pipeline.get());
+    const auto offsets = pipeline.offsets->resolve(root_object, k_reduce_texture_parameters);
+    if (offsets.empty()) return SLANG_FAIL;
+    SLANG_RETURN_ON_FAIL(
+        root_object->setData(offsets[REDUCE_TEXTURE_SOURCE_SIZE], &source_size, sizeof(source_size)));
+    SLANG_RETURN_ON_FAIL(root_object->setBinding(offsets[REDUCE_TEXTURE_SOURCE], rhi::Binding(source)));
+    SLANG_RETURN_ON_FAIL(root_object->setBinding(
+        offsets[REDUCE_TEXTURE_RESULT],
         rhi::Binding(result, rhi::BufferRange{0, static_cast<u64>(group_count) * ReduceInfo::k_byte_size})));
     pass->dispatchCompute(group_count, 1, 1);
     pass->end();
     return SLANG_OK;
 }
 
-} // namespace
-
-template <typename T>
-usize reduce_sum_scratch_size(usize count) {
-    return next_reduce_count(count) * ReduceTypeInfo<T>::k_byte_size;
-}
-
 template <typename T>
-SlangResult encode_reduce_sum(
+SlangResult encode_reduce_sum_with(
     Context &context,
     rhi::ICommandEncoder *encoder,
     rhi::IBuffer *source,
     usize count,
-    rhi::IBuffer *result) {
-
-    assert(context.device() && encoder && source && result);
+    rhi::IBuffer *result,
+    const LaunchConfig &launch) {
 
     using Info = ReduceTypeInfo<T>;
-    auto pipeline = get_cached_pipeline(pipeline_cache(context), Info::k_slang_type, [&context]() {
+    const auto key = Info::k_slang_type + launch_suffix(launch);
+    auto pipeline = get_cached_pipeline_handle(pipeline_cache(context), key, [&context, &launch]() {
         auto reduce = load_embedded_module(context, EmbeddedModuleDesc{
                                                         .name = "reduce",
                                                         .start = _binary_reduce_slang_module_start,
@@ -318,35 +396,97 @@ SlangResult encode_reduce_sum(
                                                     });
 
         if (!reduce) return Slang::ComPtr<rhi::IComputePipeline>{};
-        return create_linked_pipeline(
-            context,
-            reduce.get(),
-            Info::k_config_name,
-            Info::k_config_source,
-            "reduce");
+        return create_linked_pipeline(context, reduce.get(), Info::k_config, "reduce", launch);
     });
     if (!pipeline) return SLANG_FAIL;
 
     constexpr u32 elem_size = Info::k_byte_size;
     const auto initial_count = static_cast<u64>(count);
 
-    for (u64 l = initial_count; l > 1; l = next_reduce_count(l)) {
+    for (u64 l = initial_count; l > 1; l = next_reduce_count(l, launch)) {
         auto *src = (l == initial_count) ? source : result;
-        SLANG_RETURN_ON_FAIL(encode_buffer_pass(encoder, pipeline.get(), src, l, result, elem_size));
+        SLANG_RETURN_ON_FAIL(encode_buffer_pass(encoder, pipeline, src, l, result, elem_size, launch));
     }
     return SLANG_OK;
 }
 
 template <typename T>
-T reduce_sum(Context &context, rhi::IBuffer *source, usize count) {
+SlangResult encode_reduce_texture_sum_with(
+    Context &context,
+    rhi::ICommandEncoder *encoder,
+    rhi::ITexture *source,
+    rhi::IBuffer *result,
+    const LaunchConfig &texture_launch) {
+
+    using Info = ReduceTextureTypeInfo<T>;
+    const auto &desc = source->getDesc();
+    const auto shape = texture_shape(desc.type);
+    if (!shape) return SLANG_FAIL;
+    if (!is_reduce_texture_format<T>(desc.format)) return SLANG_FAIL;
+
+    // every layer or slice is reduced by the same first pass
+    const auto count = texture_texel_count(desc);
+    SLANG_RETURN_ON_FAIL(encode_texture_pass<T>(context, encoder, source, *shape, count, result, texture_launch));
+    const auto reduced_count = next_reduce_count(count, texture_launch);
+    if (reduced_count <= 1) return SLANG_OK;
+
+    const auto launch = reduce_launch_config(context, "reduce", ReduceTypeInfo<T>::k_slang_type);
+    return encode_reduce_sum_with<T>(context, encoder, result, reduced_count, result, launch);
+}
+
+} // namespace
+
+template <typename T>
+usize reduce_sum_scratch_size(usize count) {
+    return divide_and_round_up(count, k_min_group_item_count) * ReduceTypeInfo<T>::k_byte_size;
+}
+
+template <typename T>
+SlangResult encode_reduce_sum(
+    Context &context,
+    rhi::ICommandEncoder *encoder,
+    rhi::IBuffer *source,
+    usize count,
+    rhi::IBuffer *result) {
+
+    assert(context.device() && encoder && source && result);
+    const auto launch = reduce_launch_config(context, "reduce", ReduceTypeInfo<T>::k_slang_type);
+    return encode_reduce_sum_with<T>(context, encoder, source, count, result, launch);
+}
+
+template <typename T>
+T reduce_sum(Context &context, rhi::IBuffer *source, usize count, const ReduceDispatch &dispatch) {
     assert(context.device() && source);
 
+    if (source->getDesc().memoryType == rhi::MemoryType::ReadBack) {
+        auto *device = context.device();
+        context.queue()->waitOnHost();
+        collect_memory(context);
+        void *mapped = nullptr;
+        if (SLANG_SUCCEEDED(device->mapBuffer(source, rhi::CpuAccessMode::Read, &mapped))) {
+            const T sum = host_reduce_sum(std::span<const T>(static_cast<const T *>(mapped), count), dispatch.host);
+            device->unmapBuffer(source);
+            return sum;
+        }
+    }
+
+    if (count <= dispatch.host_max_count_device_resident) {
+        if (count == 0) return host_reduce_sum(std::span<const T>{}, dispatch.host);
+        auto readback = read_buffer<T>(context, source, 0, count);
+        return host_reduce_sum(readback.as_span(), dispatch.host);
+    }
+
     const auto result_size = reduce_sum_scratch_size<T>(count);
-    auto result = create_buffer(
+    auto result = create_scratch_buffer(
         context,
         result_size,
         rhi::BufferUsage::ShaderResource | rhi::BufferUsage::UnorderedAccess | rhi::BufferUsage::CopySource |
             rhi::BufferUsage::CopyDestination);
+    if (!result) {
+        // over the memory budget, the readback needs no device scratch
+        auto readback = read_buffer<T>(context, source, 0, count);
+        return host_reduce_sum(readback.as_span(), dispatch.host);
+    }
 
     auto queue = context.queue();
     auto encoder = queue->createCommandEncoder();
@@ -355,9 +495,28 @@ T reduce_sum(Context &context, rhi::IBuffer *source, usize count) {
     auto command_buffer = encoder->finish();
     queue->submit(command_buffer);
     queue->waitOnHost();
+    collect_memory(context);
 
-    auto readback = read_buffer<T>(context, result.get(), 0, 1);
-    return readback[0];
+    T sum{};
+    if (SLANG_FAILED(read_buffer_into(context, result.get(), 0, std::span<T>(&sum, 1)))) {
+        LLC_PANIC("Failed to read back buffer data from device.");
+    }
+    return sum;
+}
+
+template <typename T>
+T reduce_sum(Context &context, std::span<const T> source, const ReduceDispatch &dispatch) {
+    if (source.size() < dispatch.device_min_count_host_resident) {
+        return host_reduce_sum(source, dispatch.host);
+    }
+
+    auto buffer = create_buffer<T>(
+        context,
+        rhi::BufferUsage::ShaderResource | rhi::BufferUsage::UnorderedAccess | rhi::BufferUsage::CopySource |
+            rhi::BufferUsage::CopyDestination,
+        source);
+    if (!buffer) return host_reduce_sum(source, dispatch.host);
+    return reduce_sum<T>(context, buffer.get(), source.size(), dispatch);
 }
 
 template <typename T>
@@ -368,32 +527,29 @@ SlangResult encode_reduce_texture_sum(
     rhi::IBuffer *result) {
 
     assert(context.device() && encoder && source && result);
-
-    using Info = ReduceTextureTypeInfo<T>;
-    const auto &desc = source->getDesc();
-    if (desc.type != rhi::TextureType::Texture2D) return SLANG_FAIL;
-    if (desc.format != Info::k_format) return SLANG_FAIL;
-
-    const auto count = static_cast<usize>(desc.size.width) * static_cast<usize>(desc.size.height);
-    SLANG_RETURN_ON_FAIL(encode_texture_pass<T>(context, encoder, source, count, result));
-    const auto reduced_count = next_reduce_count(count);
-    if (reduced_count <= 1) return SLANG_OK;
-
-    return encode_reduce_sum<T>(context, encoder, result, reduced_count, result);
+    const auto launch = reduce_launch_config(context, "reduce_texture", ReduceTypeInfo<T>::k_slang_type);
+    return encode_reduce_texture_sum_with<T>(context, encoder, source, result, launch);
 }
 
 template <typename T>
-T reduce_texture_sum(Context &context, rhi::ITexture *source) {
+T reduce_texture_sum(Context &context, rhi::ITexture *source, const ReduceDispatch &dispatch) {
     assert(context.device() && source);
 
     const auto &desc = source->getDesc();
-    const auto count = static_cast<usize>(desc.size.width) * static_cast<usize>(desc.size.height);
+    const auto count = texture_texel_count(desc);
+    if (count <= dispatch.host_max_count_device_resident && is_reduce_texture_format<T>(desc.format)) {
+        constexpr auto host_format = ReduceTextureTypeInfo<T>::k_formats[0];
+        auto image = read_texture_layers_to_image(context, source);
+        if (image.format != host_format) image = convert_image(image, host_format);
+        return host_reduce_image_sum<T>(image, dispatch.host);
+    }
     const auto result_size = reduce_sum_scratch_size<T>(count);
-    auto result = create_buffer(
+    auto result = create_scratch_buffer(
         context,
         result_size,
         rhi::BufferUsage::ShaderResource | rhi::BufferUsage::UnorderedAccess | rhi::BufferUsage::CopySource |
             rhi::BufferUsage::CopyDestination);
+    if (!result) return {};
 
     auto queue = context.queue();
     auto encoder = queue->createCommandEncoder();
@@ -404,9 +560,59 @@ T reduce_texture_sum(Context &context, rhi::ITexture *source) {
     auto command_buffer = encoder->finish();
     queue->submit(command_buffer);
     queue->waitOnHost();
+    collect_memory(context);
+
+    T sum{};
+    if (SLANG_FAILED(read_buffer_into(context, result.get(), 0, std::span<T>(&sum, 1)))) {
+        LLC_PANIC("Failed to read back buffer data from device.");
+    }
+    return sum;
+}
 
-    auto readback = read_buffer<T>(context, result.get(), 0, 1);
-    return readback[0];
+template <typename T>
+std::optional<LaunchConfig> tune_reduce_sum(Context &context, usize count, const TuneOptions &options) {
+    assert(context.device() && count > 0);
+
+    constexpr auto usage = rhi::BufferUsage::ShaderResource | rhi::BufferUsage::UnorderedAccess |
+                           rhi::BufferUsage::CopySource | rhi::BufferUsage::CopyDestination;
+    auto source = create_scratch_buffer(context, count * ReduceTypeInfo<T>::k_byte_size, usage);
+    auto result = create_scratch_buffer(context, reduce_sum_scratch_size<T>(count), usage);
+    if (!source || !result) return std::nullopt;
+    clear_buffer(context, source.get());
+
+    return autotune_launch(
+        context,
+        tuning_key(context, "reduce", ReduceTypeInfo<T>::k_slang_type),
+        k_launch_candidates,
+        [&](const LaunchConfig &launch, rhi::ICommandEncoder *encoder) {
+            return encode_reduce_sum_with<T>(context, encoder, source.get(), count, result.get(), launch);
+        },
+        options);
+}
+
+template <typename T>
+std::optional<LaunchConfig> tune_reduce_texture_sum(Context &context, u32 width, u32 height, const TuneOptions &options) {
+    assert(context.device() && width > 0 && height > 0);
+
+    using Info = ReduceTextureTypeInfo<T>;
+    auto source = create_texture_2d(context, width, height, Info::k_formats[0], rhi::TextureUsage::ShaderResource,
+                                    rhi::ResourceState::ShaderResource);
+    const auto count = static_cast<usize>(width) * height;
+    auto result = create_scratch_buffer(
+        context,
+        reduce_sum_scratch_size<T>(count),
+        rhi::BufferUsage::ShaderResource | rhi::BufferUsage::UnorderedAccess | rhi::BufferUsage::CopySource |
+            rhi::BufferUsage::CopyDestination);
+    if (!source || !result) return std::nullopt;
+
+    return autotune_launch(
+        context,
+        tuning_key(context, "reduce_texture", ReduceTypeInfo<T>::k_slang_type),
+        k_launch_candidates,
+        [&](const LaunchConfig &launch, rhi::ICommandEncoder *encoder) {
+            return encode_reduce_texture_sum_with<T>(context, encoder, source.get(), result.get(), launch);
+        },
+        options);
 }
 
 // clang-format off
@@ -414,12 +620,15 @@ T reduce_texture_sum(Context &context, rhi::ITexture *source) {
     template usize reduce_sum_scratch_size<T>(usize);                                                                 \
     template SlangResult encode_reduce_sum<T>(                                                                        \
         Context &, rhi::ICommandEncoder *, rhi::IBuffer *, usize, rhi::IBuffer *);                                    \
-    template T reduce_sum<T>(Context &, rhi::IBuffer *, usize);
+    template T reduce_sum<T>(Context &, rhi::IBuffer *, usize, const ReduceDispatch &);                               \
+    template T reduce_sum<T>(Context &, std::span<const T>, const ReduceDispatch &);                                  \
+    template std::optional<LaunchConfig> tune_reduce_sum<T>(Context &, usize, const TuneOptions &);
 
 #define LLC_INSTANTIATE_REDUCE_TEXTURE(T)                                                                             \
     template SlangResult encode_reduce_texture_sum<T>(                                                                \
         Context &, rhi::ICommandEncoder *, rhi::ITexture *, rhi::IBuffer *);                                          \
-    template T reduce_texture_sum<T>(Context &, rhi::ITexture *);
+    template T reduce_texture_sum<T>(Context &, rhi::ITexture *, const ReduceDispatch &);                             \
+    template std::optional<LaunchConfig> tune_reduce_texture_sum<T>(Context &, u32, u32, const TuneOptions &);
 
 LLC_INSTANTIATE_REDUCE(f32)
 LLC_INSTANTIATE_REDUCE(f16)
@@ -3,11 +3,27 @@
 #include <slang-com-ptr.h>
 #include <slang-rhi.h>
 
+#include <optional>
+#include <span>
+
+#include <llc/autotune.h>
 #include <llc/context.h>
 #include <llc/types.hpp>
+#include <llc/pp/reduce_host.h>
 
 namespace llc::pp {
 
+/// Thresholds for choosing between the host and the device reduction path.
+struct ReduceDispatch final {
+    /// Device-resident inputs up to this many elements are read back once and reduced on the host,
+    /// which saves the per-level dispatches and the separate result readback.
+    usize host_max_count_device_resident = usize{1} << 14;
+    /// Host-resident inputs are only uploaded and reduced on the device from this many elements on.
+    /// The upload touches every byte anyway, so the host usually wins; raise it to never upload.
+    usize device_min_count_host_resident = usize{1} << 26;
+    HostReduceOptions host{};
+};
+
 /// Reduction kernels require a device created with rhi::Feature::WaveOps.
 template <typename T>
 usize reduce_sum_scratch_size(usize count);
@@ -20,9 +36,15 @@ SlangResult encode_reduce_sum(
     usize count,
     rhi::IBuffer *result);
 
+/// Buffers in `MemoryType::ReadBack` are mapped and always reduced on the host.
 template <typename T>
-T reduce_sum(Context &context, rhi::IBuffer *source, usize count);
+T reduce_sum(Context &context, rhi::IBuffer *source, usize count, const ReduceDispatch &dispatch = {});
 
+template <typename T>
+T reduce_sum(Context &context, std::span<const T> source, const ReduceDispatch &dispatch = {});
+
+/// Texture sums accumulate in f32 for every format that reads as float: `R32Float`, `R16Float` and
+/// `R16Unorm` textures for f32, their RGBA counterparts for f32x4.
 template <typename T>
 SlangResult encode_reduce_texture_sum(
     Context &context,
@@ -31,6 +53,20 @@ SlangResult encode_reduce_texture_sum(
     rhi::IBuffer *result);
 
 template <typename T>
-T reduce_texture_sum(Context &context, rhi::ITexture *source);
+T reduce_texture_sum(Context &context, rhi::ITexture *source, const ReduceDispatch &dispatch = {});
+
+/// Benchmarks group sizes and items per thread on `count` elements and stores the fastest in the
+/// context's tuning profile; later `reduce_sum` pipelines of `T` are specialized with it.
+/// Save the profile with `tuning_profile(context).save(path)` to reuse it in later runs.
+template <typename T>
+std::optional<LaunchConfig> tune_reduce_sum(Context &context, usize count = usize{1} << 24, const TuneOptions &options = {});
+
+/// Same as `tune_reduce_sum`, for the first pass of `reduce_texture_sum`.
+template <typename T>
+std::optional<LaunchConfig> tune_reduce_texture_sum(
+    Context &context,
+    u32 width = 2048,
+    u32 height = 2048,
+    const TuneOptions &options = {});
 
 } // namespace llc::pp
@@ -0,0 +1,138 @@
+#include "reduce_cooperative.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include <llc/scalar_types.hpp>
+#include <llc/buffer.h>
+#include <llc/pp/reduce.h>
+
+namespace llc::pp {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+f64 seconds_since(Clock::time_point start) noexcept {
+    return std::chrono::duration<f64>(Clock::now() - start).count();
+}
+
+f64 smooth(f64 average, f64 sample, f64 weight) noexcept {
+    return average > 0.0 ? average + (sample - average) * weight : sample;
+}
+
+} // namespace
+
+CooperativeReducer::CooperativeReducer(const CooperativeReduceOptions &options) noexcept
+    : options_(options), host_fraction_(options.initial_host_fraction) {}
+
+void CooperativeReducer::reset() noexcept {
+    input_ = nullptr;
+    result_ = nullptr;
+    host_fraction_ = options_.initial_host_fraction;
+    host_rate_ = 0.0;
+    device_rate_ = 0.0;
+}
+
+bool CooperativeReducer::reserve(Context &context, usize input_byte_size, usize result_byte_size) {
+    constexpr auto k_usage = rhi::BufferUsage::ShaderResource | rhi::BufferUsage::UnorderedAccess |
+                             rhi::BufferUsage::CopySource | rhi::BufferUsage::CopyDestination;
+
+    if (!input_ || input_->getDesc().size < input_byte_size) {
+        // grow geometrically, so a slowly drifting split does not reallocate every call
+        const auto current = input_ ? input_->getDesc().size : 0;
+        input_ = create_scratch_buffer(context, std::max<u64>(input_byte_size, current + current / 2), k_usage);
+    }
+    if (!result_ || result_->getDesc().size < result_byte_size) {
+        result_ = create_scratch_buffer(context, result_byte_size, k_usage);
+    }
+    return input_ && result_;
+}
+
+void CooperativeReducer::record(usize host_bytes, f64 host_seconds, usize device_bytes, f64 device_seconds) noexcept {
+    if (host_bytes > 0 && host_seconds > 0.0) {
+        host_rate_ = smooth(host_rate_, static_cast<f64>(host_bytes) / host_seconds, options_.smoothing);
+    }
+    if (device_bytes > 0 && device_seconds > 0.0) {
+        device_rate_ = smooth(device_rate_, static_cast<f64>(device_bytes) / device_seconds, options_.smoothing);
+    }
+    if (host_rate_ > 0.0 && device_rate_ > 0.0) {
+        // both sides finish at the same time when each gets a share proportional to its throughput
+        const f64 lower = options_.min_host_fraction;
+        host_fraction_ = std::clamp(host_rate_ / (host_rate_ + device_rate_), lower, 1.0 - lower);
+    }
+}
+
+template <typename T>
+T CooperativeReducer::reduce_sum(Context &context, std::span<const T> source) {
+    const usize count = source.size();
+    const usize min_part = std::max<usize>(options_.min_part_count, 2);
+
+    usize host_count = static_cast<usize>(std::llround(static_cast<f64>(count) * host_fraction_));
+    host_count = std::min(host_count, count);
+    if (host_count < min_part) host_count = 0;
+    if (count - host_count < min_part) host_count = count;
+
+    const auto host_part = source.first(host_count);
+    const auto device_part = source.subspan(host_count);
+    if (device_part.empty()) {
+        const auto start = Clock::now();
+        const T sum = host_reduce_sum(host_part, options_.host);
+        record(host_part.size_bytes(), seconds_since(start), 0, 0.0);
+        return sum;
+    }
+
+    const usize result_byte_size = reduce_sum_scratch_size<T>(device_part.size());
+    if (!reserve(context, device_part.size_bytes(), result_byte_size)) {
+        return host_reduce_sum(source, options_.host);
+    }
+
+    T host_sum = host_reduce_sum(std::span<const T>{}, options_.host);
+    f64 host_seconds = 0.0;
+    std::jthread host_worker;
+    if (!host_part.empty()) {
+        host_worker = std::jthread([&] {
+            const auto start = Clock::now();
+            host_sum = host_reduce_sum(host_part, options_.host);
+            host_seconds = seconds_since(start);
+        });
+    }
+
+    const auto device_start = Clock::now();
+    auto queue = context.queue();
+    auto encoder = queue->createCommandEncoder();
+    encoder->uploadBufferData(input_.get(), 0, device_part.size_bytes(), device_part.data());
+    if (SLANG_FAILED(encode_reduce_sum<T>(context, encoder.get(), input_.get(), device_part.size(), result_.get()))) {
+        if (host_worker.joinable()) host_worker.join();
+        return host_sum + host_reduce_sum(device_part, options_.host);
+    }
+    auto command_buffer = encoder->finish();
+    queue->submit(command_buffer);
+    queue->waitOnHost();
+    const T device_sum = read_buffer<T>(context, result_.get(), 0, 1)[0];
+    const f64 device_seconds = seconds_since(device_start);
+
+    if (host_worker.joinable()) host_worker.join();
+    record(host_part.size_bytes(), host_seconds, device_part.size_bytes(), device_seconds);
+    return host_sum + device_sum;
+}
+
+// clang-format off
+#define LLC_INSTANTIATE_COOPERATIVE_REDUCE(T)                                                                         \
+    template T CooperativeReducer::reduce_sum<T>(Context &, std::span<const T>);
+
+LLC_INSTANTIATE_COOPERATIVE_REDUCE(f32)
+LLC_INSTANTIATE_COOPERATIVE_REDUCE(f16)
+LLC_INSTANTIATE_COOPERATIVE_REDUCE(f32x2)
+LLC_INSTANTIATE_COOPERATIVE_REDUCE(f32x3)
+LLC_INSTANTIATE_COOPERATIVE_REDUCE(f32x4)
+LLC_INSTANTIATE_COOPERATIVE_REDUCE(f16x2)
+LLC_INSTANTIATE_COOPERATIVE_REDUCE(f16x3)
+LLC_INSTANTIATE_COOPERATIVE_REDUCE(f16x4)
+// clang-format on
+
+#undef LLC_INSTANTIATE_COOPERATIVE_REDUCE
+
+} // namespace llc::pp
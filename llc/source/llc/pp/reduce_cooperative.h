@@ -0,0 +1,58 @@
+#pragma once
+
+#include <span>
+
+#include <slang-com-ptr.h>
+#include <slang-rhi.h>
+
+#include <llc/context.h>
+#include <llc/types.hpp>
+#include <llc/pp/reduce_host.h>
+
+namespace llc::pp {
+
+struct CooperativeReduceOptions final {
+    /// Share of the input reduced on the host before any throughput has been measured.
+    f64 initial_host_fraction = 0.5;
+    /// Weight of the newest measurement in the moving average of both throughputs.
+    f64 smoothing = 0.25;
+    /// The host share never leaves [min_host_fraction, 1 - min_host_fraction], so both sides keep
+    /// being measured and the split can follow changes in load.
+    f64 min_host_fraction = 0.05;
+    /// A side that would get fewer elements than this gets none, the other side takes everything.
+    usize min_part_count = usize{1} << 16;
+    HostReduceOptions host{};
+};
+
+/// Splits host-resident (or mapped) inputs between host threads and the device, which reduce their parts
+/// concurrently; the partial sums are merged on the host. The split ratio adapts to the throughput
+/// measured in previous calls, and the device input/result buffers are reused between calls.
+/// Reducing on the device requires rhi::Feature::WaveOps, see `reduce_sum`.
+struct CooperativeReducer final {
+    explicit CooperativeReducer(const CooperativeReduceOptions &options = {}) noexcept;
+
+    template <typename T>
+    T reduce_sum(Context &context, std::span<const T> source);
+
+    /// Share of the next input that goes to the host.
+    [[nodiscard]] f64 host_fraction() const noexcept { return host_fraction_; }
+    /// Smoothed throughput of each side, zero until that side has been measured.
+    [[nodiscard]] f64 host_bytes_per_second() const noexcept { return host_rate_; }
+    [[nodiscard]] f64 device_bytes_per_second() const noexcept { return device_rate_; }
+
+    /// Forgets measured throughputs and releases the device buffers.
+    void reset() noexcept;
+
+private:
+    bool reserve(Context &context, usize input_byte_size, usize result_byte_size);
+    void record(usize host_bytes, f64 host_seconds, usize device_bytes, f64 device_seconds) noexcept;
+
+    CooperativeReduceOptions options_;
+    Slang::ComPtr<rhi::IBuffer> input_;
+    Slang::ComPtr<rhi::IBuffer> result_;
+    f64 host_fraction_;
+    f64 host_rate_ = 0.0;
+    f64 device_rate_ = 0.0;
+};
+
+} // namespace llc::pp
@@ -0,0 +1,93 @@
+#include "reduce_group.h"
+
+#include <cassert>
+#include <chrono>
+
+#include <llc/scalar_types.hpp>
+#include <llc/utils/parallel.h>
+#include <llc/utils/small_vector.h>
+
+namespace llc::pp {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+f64 seconds_since(Clock::time_point start) noexcept {
+    return std::chrono::duration<f64>(Clock::now() - start).count();
+}
+
+/// Runs `reduce_fn(index)` for every context of `group` on a thread of its own, records the time
+/// each took for `byte_count(index)` bytes and returns the sum of the partial results.
+template <typename T, typename ReduceFn, typename ByteCountFn>
+T reduce_partitioned(ContextGroup &group, ReduceFn &&reduce_fn, ByteCountFn &&byte_count) {
+    const usize context_count = group.size();
+    SmallVector<T, 8> partials(context_count);
+    SmallVector<f64, 8> seconds(context_count);
+    parallel_for_chunks(context_count, static_cast<u32>(context_count), [&](usize begin, usize end, u32) {
+        for (usize i = begin; i < end; ++i) {
+            const auto start = Clock::now();
+            partials[i] = reduce_fn(i);
+            seconds[i] = seconds_since(start);
+        }
+    });
+
+    T total = partials[0];
+    group.record(0, byte_count(0), seconds[0]);
+    for (usize i = 1; i < context_count; ++i) {
+        total = total + partials[i];
+        group.record(i, byte_count(i), seconds[i]);
+    }
+    return total;
+}
+
+} // namespace
+
+template <typename T>
+T reduce_sum(ContextGroup &group, std::span<const T> source, const ReduceDispatch &dispatch) {
+    assert(group.size() > 0);
+
+    const auto ranges = group.partition(source.size());
+    return reduce_partitioned<T>(
+        group,
+        [&](usize index) {
+            // empty parts still go through, so every partial starts out as a proper zero
+            return reduce_sum<T>(group[index], source.subspan(ranges[index].begin, ranges[index].size()), dispatch);
+        },
+        [&](usize index) { return ranges[index].size() * sizeof(T); });
+}
+
+template <typename T>
+T reduce_sum(
+    ContextGroup &group,
+    std::span<rhi::IBuffer *const> sources,
+    std::span<const usize> counts,
+    const ReduceDispatch &dispatch) {
+
+    assert(group.size() > 0 && sources.size() == group.size() && counts.size() == group.size());
+
+    return reduce_partitioned<T>(
+        group,
+        [&](usize index) { return reduce_sum<T>(group[index], sources[index], counts[index], dispatch); },
+        [&](usize index) { return counts[index] * sizeof(T); });
+}
+
+// clang-format off
+#define LLC_INSTANTIATE_GROUP_REDUCE(T)                                                                               \
+    template T reduce_sum<T>(ContextGroup &, std::span<const T>, const ReduceDispatch &);                             \
+    template T reduce_sum<T>(                                                                                         \
+        ContextGroup &, std::span<rhi::IBuffer *const>, std::span<const usize>, const ReduceDispatch &);
+
+LLC_INSTANTIATE_GROUP_REDUCE(f32)
+LLC_INSTANTIATE_GROUP_REDUCE(f16)
+LLC_INSTANTIATE_GROUP_REDUCE(f32x2)
+LLC_INSTANTIATE_GROUP_REDUCE(f32x3)
+LLC_INSTANTIATE_GROUP_REDUCE(f32x4)
+LLC_INSTANTIATE_GROUP_REDUCE(f16x2)
+LLC_INSTANTIATE_GROUP_REDUCE(f16x3)
+LLC_INSTANTIATE_GROUP_REDUCE(f16x4)
+// clang-format on
+
+#undef LLC_INSTANTIATE_GROUP_REDUCE
+
+} // namespace llc::pp
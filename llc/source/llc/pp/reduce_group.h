@@ -0,0 +1,30 @@
+#pragma once
+
+#include <span>
+
+#include <slang-rhi.h>
+
+#include <llc/context_group.h>
+#include <llc/types.hpp>
+#include <llc/pp/reduce.h>
+
+namespace llc::pp {
+
+/// Splits host-resident `source` across the contexts of `group` with `ContextGroup::partition`,
+/// reduces the parts concurrently, one thread per context, and merges the partial sums on the host.
+/// Each part goes through `reduce_sum(Context &, ...)` with `dispatch`, so lower
+/// `device_min_count_host_resident` for the parts to be uploaded. The time every context took is
+/// recorded in the group, later calls split in proportion to the measured throughput.
+template <typename T>
+T reduce_sum(ContextGroup &group, std::span<const T> source, const ReduceDispatch &dispatch = {});
+
+/// Device-resident variant: `sources[i]` holds `counts[i]` elements on context `i` of `group`.
+/// The parts are reduced concurrently and merged on the host; nothing is moved between devices.
+template <typename T>
+T reduce_sum(
+    ContextGroup &group,
+    std::span<rhi::IBuffer *const> sources,
+    std::span<const usize> counts,
+    const ReduceDispatch &dispatch = {});
+
+} // namespace llc::pp
@@ -0,0 +1,196 @@
+#include "reduce_host.h"
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <type_traits>
+
+#include <llc/scalar_types.hpp>
+#include <llc/utils/config.h>
+#include <llc/utils/parallel.h>
+#include <llc/utils/small_vector.h>
+
+#if LLC_SIMD_AVX2
+#include <immintrin.h>
+#endif
+#if LLC_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace llc::pp {
+
+namespace {
+
+using namespace llc::types;
+
+using Sums = std::array<f64, 4>;
+
+/// Elements per block. Lanes accumulate a block in f32, block totals are promoted to f64.
+constexpr usize k_block_size = 1024;
+
+template <typename T>
+struct HostReduceTypeInfo;
+
+#define LLC_DEFINE_HOST_REDUCE_TYPE_INFO(cpp_type, scalar_cpp_type, component_count) \
+    template <>                                                                     \
+    struct HostReduceTypeInfo<cpp_type> final {                                     \
+        using scalar_type = scalar_cpp_type;                                        \
+        static constexpr u32 k_components = component_count;                       \
+    }
+
+LLC_DEFINE_HOST_REDUCE_TYPE_INFO(f32, f32, 1);
+LLC_DEFINE_HOST_REDUCE_TYPE_INFO(f16, f16, 1);
+LLC_DEFINE_HOST_REDUCE_TYPE_INFO(f32x2, f32, 2);
+LLC_DEFINE_HOST_REDUCE_TYPE_INFO(f32x3, f32, 3);
+LLC_DEFINE_HOST_REDUCE_TYPE_INFO(f32x4, f32, 4);
+LLC_DEFINE_HOST_REDUCE_TYPE_INFO(f16x2, f16, 2);
+LLC_DEFINE_HOST_REDUCE_TYPE_INFO(f16x3, f16, 3);
+LLC_DEFINE_HOST_REDUCE_TYPE_INFO(f16x4, f16, 4);
+
+#undef LLC_DEFINE_HOST_REDUCE_TYPE_INFO
+
+template <typename T>
+constexpr rhi::Format k_image_format = rhi::Format::Undefined;
+template <>
+constexpr rhi::Format k_image_format<f32> = rhi::Format::R32Float;
+template <>
+constexpr rhi::Format k_image_format<f32x4> = rhi::Format::RGBA32Float;
+
+/// Adds `float_count` consecutive floats, a whole number of N-component elements, to `sums`.
+/// Float `i` belongs to component `i % N`; every SIMD step consumes N registers so each lane
+/// keeps a fixed component.
+template <u32 N>
+void accumulate_block(const f32 *data, usize float_count, Sums &sums) noexcept {
+    usize i = 0;
+#if LLC_SIMD_AVX2
+    constexpr usize k_lanes = 8;
+    __m256 acc[N];
+    for (u32 k = 0; k < N; ++k) acc[k] = _mm256_setzero_ps();
+    for (; i + k_lanes * N <= float_count; i += k_lanes * N) {
+        for (u32 k = 0; k < N; ++k) acc[k] = _mm256_add_ps(acc[k], _mm256_loadu_ps(data + i + k * k_lanes));
+    }
+    alignas(32) f32 lanes[k_lanes * N];
+    for (u32 k = 0; k < N; ++k) _mm256_store_ps(lanes + k * k_lanes, acc[k]);
+#elif LLC_SIMD_NEON
+    constexpr usize k_lanes = 4;
+    float32x4_t acc[N];
+    for (u32 k = 0; k < N; ++k) acc[k] = vdupq_n_f32(0.0f);
+    for (; i + k_lanes * N <= float_count; i += k_lanes * N) {
+        for (u32 k = 0; k < N; ++k) acc[k] = vaddq_f32(acc[k], vld1q_f32(data + i + k * k_lanes));
+    }
+    alignas(16) f32 lanes[k_lanes * N];
+    for (u32 k = 0; k < N; ++k) vst1q_f32(lanes + k * k_lanes, acc[k]);
+#else
+    // independent lanes break the serial add chain, so the compiler can still vectorize this
+    constexpr usize k_lanes = 4;
+    f32 lanes[k_lanes * N]{};
+    for (; i + k_lanes * N <= float_count; i += k_lanes * N) {
+        for (usize j = 0; j < k_lanes * N; ++j) lanes[j] += data[i + j];
+    }
+#endif
+
+    std::array<f32, N> partial{};
+    for (usize j = 0; j < k_lanes * N; ++j) partial[j % N] += lanes[j];
+    for (; i < float_count; ++i) partial[i % N] += data[i];
+    for (u32 c = 0; c < N; ++c) sums[c] += static_cast<f64>(partial[c]);
+}
+
+template <typename T>
+void accumulate_range(const T *data, usize count, Sums &sums) noexcept {
+    using Info = HostReduceTypeInfo<T>;
+    constexpr u32 N = Info::k_components;
+
+    for (usize begin = 0; begin < count; begin += k_block_size) {
+        const usize block_count = std::min(k_block_size, count - begin);
+        if constexpr (std::is_same_v<typename Info::scalar_type, f32>) {
+            accumulate_block<N>(reinterpret_cast<const f32 *>(data + begin), block_count * N, sums);
+        } else {
+            std::array<f32, k_block_size * N> converted;
+            convert_f16_to_f32(
+                std::span<const f16>(reinterpret_cast<const f16 *>(data + begin), block_count * N),
+                converted);
+            accumulate_block<N>(converted.data(), block_count * N, sums);
+        }
+    }
+}
+
+template <typename T>
+T from_sums(const Sums &sums) noexcept {
+    using Info = HostReduceTypeInfo<T>;
+    using Scalar = typename Info::scalar_type;
+    if constexpr (Info::k_components == 1) {
+        return T(static_cast<f32>(sums[0]));
+    } else {
+        T result;
+        for (u32 c = 0; c < Info::k_components; ++c) {
+            result[static_cast<glm::length_t>(c)] = Scalar(static_cast<f32>(sums[c]));
+        }
+        return result;
+    }
+}
+
+Sums combine(std::span<const Sums> partials) noexcept {
+    Sums total{};
+    for (const auto &partial : partials) {
+        for (usize c = 0; c < total.size(); ++c) total[c] += partial[c];
+    }
+    return total;
+}
+
+} // namespace
+
+template <typename T>
+T host_reduce_sum(std::span<const T> source, const HostReduceOptions &options) {
+    const u32 chunk_count = parallel_chunk_count(source.size(), options.min_elements_per_thread, options.max_threads);
+
+    SmallVector<Sums, 16> partials(chunk_count);
+    parallel_for_chunks(source.size(), chunk_count, [&](usize begin, usize end, u32 index) {
+        Sums sums{};
+        accumulate_range(source.data() + begin, end - begin, sums);
+        partials[index] = sums;
+    });
+    return from_sums<T>(combine(std::span<const Sums>(partials.data(), partials.size())));
+}
+
+template <typename T>
+T host_reduce_image_sum(const Image &image, const HostReduceOptions &options) {
+    if (!image || image.format != k_image_format<T>) return from_sums<T>(Sums{});
+
+    const usize min_rows = std::max<usize>(1, options.min_elements_per_thread / image.width);
+    const u32 chunk_count = parallel_chunk_count(image.height, min_rows, options.max_threads);
+
+    SmallVector<Sums, 16> partials(chunk_count);
+    parallel_for_chunks(image.height, chunk_count, [&](usize begin, usize end, u32 index) {
+        Sums sums{};
+        for (usize y = begin; y < end; ++y) {
+            const auto *row = reinterpret_cast<const T *>(image.row_data(static_cast<u32>(y)));
+            accumulate_range(row, image.width, sums);
+        }
+        partials[index] = sums;
+    });
+    return from_sums<T>(combine(std::span<const Sums>(partials.data(), partials.size())));
+}
+
+// clang-format off
+#define LLC_INSTANTIATE_HOST_REDUCE(T)                                                                                \
+    template T host_reduce_sum<T>(std::span<const T>, const HostReduceOptions &);
+
+#define LLC_INSTANTIATE_HOST_REDUCE_IMAGE(T)                                                                          \
+    template T host_reduce_image_sum<T>(const Image &, const HostReduceOptions &);
+
+LLC_INSTANTIATE_HOST_REDUCE(f32)
+LLC_INSTANTIATE_HOST_REDUCE(f16)
+LLC_INSTANTIATE_HOST_REDUCE(f32x2)
+LLC_INSTANTIATE_HOST_REDUCE(f32x3)
+LLC_INSTANTIATE_HOST_REDUCE(f32x4)
+LLC_INSTANTIATE_HOST_REDUCE(f16x2)
+LLC_INSTANTIATE_HOST_REDUCE(f16x3)
+LLC_INSTANTIATE_HOST_REDUCE(f16x4)
+LLC_INSTANTIATE_HOST_REDUCE_IMAGE(f32)
+LLC_INSTANTIATE_HOST_REDUCE_IMAGE(f32x4)
+// clang-format on
+
+#undef LLC_INSTANTIATE_HOST_REDUCE
+#undef LLC_INSTANTIATE_HOST_REDUCE_IMAGE
+
+} // namespace llc::pp
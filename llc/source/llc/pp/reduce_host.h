@@ -0,0 +1,28 @@
+#pragma once
+
+#include <span>
+
+#include <llc/image.h>
+#include <llc/types.hpp>
+
+namespace llc::pp {
+
+struct HostReduceOptions final {
+    /// Upper bound on worker threads, 0 means all hardware threads.
+    u32 max_threads = 0;
+    /// A new worker thread is only used once every thread gets at least this many elements.
+    usize min_elements_per_thread = usize{1} << 16;
+};
+
+/// Sums `source` on the host, vectorized with AVX2/NEON when available and split across threads.
+/// Partial sums are promoted to f64 per block, so the result doubles as a validation oracle for the
+/// device reduction.
+template <typename T>
+T host_reduce_sum(std::span<const T> source, const HostReduceOptions &options = {});
+
+/// Host counterpart of `reduce_texture_sum<T>` for an image with the matching format
+/// (`R32Float` for f32, `RGBA32Float` for f32x4). Returns zero on a format mismatch.
+template <typename T>
+T host_reduce_image_sum(const Image &image, const HostReduceOptions &options = {});
+
+} // namespace llc::pp
@@ -0,0 +1,225 @@
+#include "reduce_stream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include <llc/scalar_types.hpp>
+#include <llc/buffer.h>
+#include <llc/memory_tracker.h>
+#include <llc/pp/reduce.h>
+#include <llc/pp/reduce_host.h>
+#include <llc/utils/mapped_file.h>
+
+namespace llc::pp {
+
+namespace {
+
+constexpr auto k_device_usage = rhi::BufferUsage::ShaderResource | rhi::BufferUsage::UnorderedAccess |
+                                rhi::BufferUsage::CopySource | rhi::BufferUsage::CopyDestination;
+
+SlangResult submit_signaling(rhi::ICommandQueue *queue, rhi::ICommandBuffer *command_buffer, rhi::IFence *fence, u64 value) {
+    rhi::SubmitDesc submit{};
+    submit.commandBuffers = &command_buffer;
+    submit.commandBufferCount = 1;
+    submit.signalFences = &fence;
+    submit.signalFenceValues = &value;
+    submit.signalFenceCount = 1;
+    return queue->submit(submit);
+}
+
+} // namespace
+
+template <typename T>
+std::optional<StreamingReducer<T>> StreamingReducer<T>::create(Context &context, const StreamReduceOptions &options) {
+    if (options.chunk_count == 0 || options.ring_size == 0 || options.max_partial_count < 2) {
+        return std::nullopt;
+    }
+
+    StreamingReducer reducer;
+    reducer.context_ = &context;
+    reducer.options_ = options;
+
+    const usize chunk_byte_size = options.chunk_count * sizeof(T);
+    reducer.slots_.resize(options.ring_size);
+    for (auto &slot : reducer.slots_) {
+        slot.staging = create_buffer(
+            context,
+            chunk_byte_size,
+            rhi::BufferUsage::CopySource,
+            nullptr,
+            rhi::MemoryType::Upload,
+            rhi::ResourceState::CopySource);
+        slot.chunk = create_scratch_buffer(context, chunk_byte_size, k_device_usage);
+        slot.scratch = create_scratch_buffer(context, reduce_sum_scratch_size<T>(options.chunk_count), k_device_usage);
+        if (!slot.staging || !slot.chunk || !slot.scratch) return std::nullopt;
+    }
+
+    reducer.partials_ = create_scratch_buffer(context, options.max_partial_count * sizeof(T), k_device_usage);
+    reducer.fold_scratch_ = create_scratch_buffer(context, reduce_sum_scratch_size<T>(options.max_partial_count), k_device_usage);
+    if (!reducer.partials_ || !reducer.fold_scratch_) return std::nullopt;
+
+    if (SLANG_FAILED(context.device()->createFence(rhi::FenceDesc{}, reducer.fence_.writeRef()))) {
+        return std::nullopt;
+    }
+    return reducer;
+}
+
+template <typename T>
+bool StreamingReducer<T>::wait_for_slot(const Slot &slot) {
+    if (slot.fence_value == 0) return true;
+    rhi::IFence *fence = fence_.get();
+    return SLANG_SUCCEEDED(context_->device()->waitForFences(1, &fence, &slot.fence_value, true, rhi::kTimeoutInfinite));
+}
+
+template <typename T>
+bool StreamingReducer<T>::push(std::span<const T> source) {
+    auto *device = context_->device();
+    while (!source.empty()) {
+        auto &slot = slots_[current_slot_];
+        if (filled_count_ == 0 && !wait_for_slot(slot)) return false;
+
+        void *mapped = nullptr;
+        if (SLANG_FAILED(device->mapBuffer(slot.staging.get(), rhi::CpuAccessMode::Write, &mapped))) return false;
+        const usize count = std::min(options_.chunk_count - filled_count_, source.size());
+        std::memcpy(static_cast<byte *>(mapped) + filled_count_ * sizeof(T), source.data(), count * sizeof(T));
+        device->unmapBuffer(slot.staging.get());
+
+        filled_count_ += count;
+        pushed_count_ += count;
+        source = source.subspan(count);
+        if (filled_count_ == options_.chunk_count && !flush()) return false;
+    }
+    return true;
+}
+
+template <typename T>
+bool StreamingReducer<T>::flush() {
+    if (filled_count_ == 0) return true;
+
+    constexpr u64 elem_size = sizeof(T);
+    auto &slot = slots_[current_slot_];
+    auto queue = context_->queue();
+    auto encoder = queue->createCommandEncoder();
+
+    // fold the per-chunk totals into the first one before the partials buffer overflows
+    if (partial_count_ == options_.max_partial_count) {
+        if (SLANG_FAILED(encode_reduce_sum<T>(*context_, encoder.get(), partials_.get(), partial_count_, fold_scratch_.get()))) {
+            return false;
+        }
+        encoder->copyBuffer(partials_.get(), 0, fold_scratch_.get(), 0, elem_size);
+        partial_count_ = 1;
+    }
+
+    encoder->copyBuffer(slot.chunk.get(), 0, slot.staging.get(), 0, filled_count_ * elem_size);
+    rhi::IBuffer *chunk_total = slot.chunk.get();
+    if (filled_count_ > 1) {
+        if (SLANG_FAILED(encode_reduce_sum<T>(*context_, encoder.get(), slot.chunk.get(), filled_count_, slot.scratch.get()))) {
+            return false;
+        }
+        chunk_total = slot.scratch.get();
+    }
+    encoder->copyBuffer(partials_.get(), partial_count_ * elem_size, chunk_total, 0, elem_size);
+    ++partial_count_;
+
+    auto command_buffer = encoder->finish();
+    if (SLANG_FAILED(submit_signaling(queue, command_buffer.get(), fence_.get(), last_fence_value_ + 1))) {
+        return false;
+    }
+    slot.fence_value = ++last_fence_value_;
+    current_slot_ = (current_slot_ + 1) % static_cast<u32>(slots_.size());
+    filled_count_ = 0;
+    return true;
+}
+
+template <typename T>
+std::optional<T> StreamingReducer<T>::finish() {
+    std::optional<T> total;
+    auto queue = context_->queue();
+
+    if (flush()) {
+        total = host_reduce_sum(std::span<const T>{});
+        if (partial_count_ > 0) {
+            auto encoder = queue->createCommandEncoder();
+            rhi::IBuffer *source = partials_.get();
+            if (partial_count_ > 1) {
+                if (SLANG_SUCCEEDED(encode_reduce_sum<T>(*context_, encoder.get(), partials_.get(), partial_count_, fold_scratch_.get()))) {
+                    source = fold_scratch_.get();
+                } else {
+                    source = nullptr;
+                }
+            }
+
+            if (source) {
+                auto command_buffer = encoder->finish();
+                queue->submit(command_buffer);
+                queue->waitOnHost();
+                collect_memory(*context_);
+                total = read_buffer<T>(*context_, source, 0, 1)[0];
+            } else {
+                total.reset();
+            }
+        }
+    }
+
+    queue->waitOnHost();
+    collect_memory(*context_);
+    current_slot_ = 0;
+    partial_count_ = 0;
+    filled_count_ = 0;
+    pushed_count_ = 0;
+    return total;
+}
+
+template <typename T>
+std::optional<T> reduce_sum_file(
+    Context &context,
+    const std::filesystem::path &path,
+    const StreamReduceOptions &options,
+    StreamFileAccess access) {
+
+    auto reducer = StreamingReducer<T>::create(context, options);
+    if (!reducer) return std::nullopt;
+
+    if (access == StreamFileAccess::MAPPED) {
+        auto file = MappedFile::open(path);
+        if (!file) return std::nullopt;
+
+        // mappings are page aligned, which satisfies the alignment of every element type
+        const auto *elements = reinterpret_cast<const T *>(file->data());
+        if (!reducer->push(std::span<const T>(elements, file->size() / sizeof(T)))) return std::nullopt;
+        return reducer->finish();
+    }
+
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) return std::nullopt;
+
+    std::vector<T> chunk(options.chunk_count);
+    while (stream) {
+        stream.read(reinterpret_cast<char *>(chunk.data()), static_cast<std::streamsize>(chunk.size() * sizeof(T)));
+        const auto count = static_cast<usize>(stream.gcount()) / sizeof(T);
+        if (count == 0) break;
+        if (!reducer->push(std::span<const T>(chunk.data(), count))) return std::nullopt;
+    }
+    return reducer->finish();
+}
+
+// clang-format off
+#define LLC_INSTANTIATE_STREAM_REDUCE(T)                                                                              \
+    template struct StreamingReducer<T>;                                                                              \
+    template std::optional<T> reduce_sum_file<T>(                                                                     \
+        Context &, const std::filesystem::path &, const StreamReduceOptions &, StreamFileAccess);
+
+LLC_INSTANTIATE_STREAM_REDUCE(f32)
+LLC_INSTANTIATE_STREAM_REDUCE(f16)
+LLC_INSTANTIATE_STREAM_REDUCE(f32x2)
+LLC_INSTANTIATE_STREAM_REDUCE(f32x3)
+LLC_INSTANTIATE_STREAM_REDUCE(f32x4)
+LLC_INSTANTIATE_STREAM_REDUCE(f16x2)
+LLC_INSTANTIATE_STREAM_REDUCE(f16x3)
+LLC_INSTANTIATE_STREAM_REDUCE(f16x4)
+// clang-format on
+
+#undef LLC_INSTANTIATE_STREAM_REDUCE
+
+} // namespace llc::pp
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <slang-com-ptr.h>
+#include <slang-rhi.h>
+
+#include <llc/context.h>
+#include <llc/types.hpp>
+
+namespace llc::pp {
+
+struct StreamReduceOptions final {
+    /// Elements per upload slot, i.e. per chunk reduced on the device.
+    usize chunk_count = usize{1} << 22;
+    /// Upload slots in flight: 2 for double, 3 for triple buffering.
+    u32 ring_size = 3;
+    /// Per-chunk totals kept on the device before they are folded into a single one.
+    u32 max_partial_count = 1024;
+};
+
+/// Reduces a stream of host data that does not have to fit in device memory.
+///
+/// Pushed elements are copied into a ring of host-visible upload slots. Every full slot is copied
+/// to the device and reduced while the host fills the next one; the per-chunk totals stay on the
+/// device and are folded into one accumulator, so `finish()` does the only readback.
+/// Requires rhi::Feature::WaveOps, see `reduce_sum`.
+template <typename T>
+struct StreamingReducer final {
+    static std::optional<StreamingReducer> create(Context &context, const StreamReduceOptions &options = {});
+
+    /// Appends `source` to the stream. Blocks only while every upload slot is still in flight.
+    bool push(std::span<const T> source);
+
+    /// Reduces what is left, reads back the total and resets the stream for reuse.
+    /// Returns nullopt if a submission failed along the way.
+    std::optional<T> finish();
+
+    [[nodiscard]] usize pushed_count() const noexcept { return pushed_count_; }
+
+private:
+    struct Slot final {
+        Slang::ComPtr<rhi::IBuffer> staging;
+        Slang::ComPtr<rhi::IBuffer> chunk;
+        Slang::ComPtr<rhi::IBuffer> scratch;
+        /// fence value signalled once the slot's last submission has retired, 0 if never submitted
+        u64 fence_value = 0;
+    };
+
+    StreamingReducer() = default;
+
+    bool wait_for_slot(const Slot &slot);
+    bool flush();
+
+    Context *context_ = nullptr;
+    StreamReduceOptions options_;
+    std::vector<Slot> slots_;
+    Slang::ComPtr<rhi::IBuffer> partials_;
+    Slang::ComPtr<rhi::IBuffer> fold_scratch_;
+    Slang::ComPtr<rhi::IFence> fence_;
+    u64 last_fence_value_ = 0;
+    u32 current_slot_ = 0;
+    u32 partial_count_ = 0;
+    usize filled_count_ = 0;
+    usize pushed_count_ = 0;
+};
+
+enum class StreamFileAccess : u8 {
+    /// map the file and copy straight from the mapping into the upload slots
+    MAPPED,
+    /// read the file chunk by chunk into a host buffer
+    READ,
+};
+
+/// Sums a file holding a raw array of `T`; trailing bytes that do not form a whole element are
+/// ignored. Returns nullopt if the file cannot be read or the device part fails.
+template <typename T>
+std::optional<T> reduce_sum_file(
+    Context &context,
+    const std::filesystem::path &path,
+    const StreamReduceOptions &options = {},
+    StreamFileAccess access = StreamFileAccess::MAPPED);
+
+} // namespace llc::pp
@@ -0,0 +1,435 @@
+#include "resize.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <optional>
+#include <span>
+
+#include <llc/blob.h>
+#include <llc/math.h>
+#include <llc/memory_tracker.h>
+#include <llc/mip_generator.h>
+#include <llc/texture.h>
+#include <llc/view_cache.h>
+
+#include <llc/utils/embedded_module.h>
+#include <llc/utils/pipeline_cache.h>
+#include <llc/utils/small_string.h>
+
+LLC_DECLARE_EMBEDDED_MODULE(resize)
+
+namespace llc::pp {
+
+using namespace llc::types;
+
+namespace {
+
+/// `TILE_WIDTH` and `TILE_HEIGHT` in resize.slang
+constexpr u32 k_resize_tile = 16;
+/// the separable path writes every intermediate texel and reads it back, counted as this many taps
+constexpr u64 k_intermediate_cost = 2;
+
+/// parameters of `resize2D` in resize.slang, in the order of `k_resize_parameters`
+enum ResizeParameter : u32 {
+    RESIZE_SRC_ORIGIN,
+    RESIZE_SRC_SIZE,
+    RESIZE_DST_ORIGIN,
+    RESIZE_DST_SIZE,
+    RESIZE_FILTER,
+    RESIZE_SRGB,
+    RESIZE_SRC,
+    RESIZE_DST,
+    /// `resizeAxis` only
+    RESIZE_AXIS,
+};
+constexpr std::array<const char *, 8> k_resize_parameters{
+    "srcOrigin", "srcSize", "dstOrigin", "dstSize", "filterType", "srgb", "src", "dst"};
+constexpr std::array<const char *, 9> k_resize_axis_parameters{
+    "srcOrigin", "srcSize", "dstOrigin", "dstSize", "filterType", "srgb", "src", "dst", "axis"};
+
+/// Rectangles and formats of one resize, checked against both textures.
+struct ResizePlan final {
+    TextureRect src;
+    TextureRect dst;
+    rhi::Format storage_format = rhi::Format::Undefined;
+    /// the kernels write a linear copy of the destination region, encoded as sRGB
+    bool srgb = false;
+    bool separable = false;
+};
+
+/// One dispatch of `resize2D` or `resizeAxis`.
+struct ResizePass final {
+    rhi::ITextureView *src = nullptr;
+    u32x2 src_origin{};
+    u32x2 src_size{};
+    rhi::ITextureView *dst = nullptr;
+    u32x2 dst_origin{};
+    u32x2 dst_size{};
+};
+
+/// `rect` resolved against mip `mip` of a texture of `desc`, nullopt if it does not fit.
+std::optional<TextureRect> resolve_rect(const TextureRect &rect, const rhi::TextureDesc &desc, u32 mip) noexcept {
+    if (mip >= desc.mipCount) return std::nullopt;
+    const u32 width = std::max(1u, desc.size.width >> mip);
+    const u32 height = std::max(1u, desc.size.height >> mip);
+    if (rect.width == 0 || rect.height == 0) return TextureRect{.width = width, .height = height};
+    if (rect.x > width || rect.width > width - rect.x || rect.y > height || rect.height > height - rect.y) {
+        return std::nullopt;
+    }
+    return rect;
+}
+
+bool is_2d(const rhi::TextureDesc &desc) noexcept {
+    return desc.type == rhi::TextureType::Texture2D || desc.type == rhi::TextureType::Texture2DArray;
+}
+
+/// Source texels one destination texel reads on an axis resampling `src` texels to `dst`, as the
+/// footprint in resize.slang computes them.
+u64 tap_count(ResizeFilter filter, u32 src, u32 dst) noexcept {
+    const f64 scale = static_cast<f64>(src) / dst;
+    f64 radius = 0.5 * scale;
+    switch (filter) {
+        case ResizeFilter::BOX: break;
+        case ResizeFilter::BILINEAR: radius = std::max(scale, 1.0); break;
+        case ResizeFilter::BICUBIC: radius = 2.0 * std::max(scale, 1.0); break;
+        case ResizeFilter::LANCZOS: radius = 3.0 * std::max(scale, 1.0); break;
+    }
+    return std::min<u64>(src, static_cast<u64>(std::ceil(2.0 * radius)) + 1);
+}
+
+/// The single pass reads taps_x * taps_y texels per destination texel, the separable one taps_x
+/// per intermediate texel and taps_y per destination texel.
+bool use_separable(const ResizeDesc &desc, const TextureRect &src, const TextureRect &dst) noexcept {
+    switch (desc.passes) {
+        case ResizePasses::SINGLE: return false;
+        case ResizePasses::SEPARABLE: return true;
+        case ResizePasses::AUTO: break;
+    }
+    const u64 taps_x = tap_count(desc.filter, src.width, dst.width);
+    const u64 taps_y = tap_count(desc.filter, src.height, dst.height);
+    const u64 dst_texels = u64{dst.width} * dst.height;
+    const u64 intermediate_texels = u64{dst.width} * src.height;
+    return intermediate_texels * (taps_x + k_intermediate_cost) + dst_texels * taps_y < dst_texels * taps_x * taps_y;
+}
+
+SlangResult plan_resize(
+    rhi::ITexture *source,
+    rhi::ITexture *destination,
+    const ResizeDesc &desc,
+    ResizePlan &plan) {
+
+    if (!source || !destination) return SLANG_E_INVALID_ARG;
+    const auto &src_desc = source->getDesc();
+    const auto &dst_desc = destination->getDesc();
+    if (!is_2d(src_desc) || !is_2d(dst_desc)) return SLANG_E_NOT_IMPLEMENTED;
+    if (desc.src_layer >= std::max(src_desc.arrayLength, 1u) || desc.dst_layer >= std::max(dst_desc.arrayLength, 1u)) {
+        return SLANG_E_INVALID_ARG;
+    }
+    // the kernels cannot read the subresource they write
+    if (source == destination && desc.src_mip == desc.dst_mip && desc.src_layer == desc.dst_layer) {
+        return SLANG_E_INVALID_ARG;
+    }
+
+    const auto src_rect = resolve_rect(desc.src_rect, src_desc, desc.src_mip);
+    const auto dst_rect = resolve_rect(desc.dst_rect, dst_desc, desc.dst_mip);
+    if (!src_rect || !dst_rect) return SLANG_E_INVALID_ARG;
+
+    plan.storage_format = mip_storage_format(dst_desc.format);
+    if (!mip_format_name(plan.storage_format)) return SLANG_E_NOT_IMPLEMENTED;
+    plan.src = *src_rect;
+    plan.dst = *dst_rect;
+    plan.srgb = plan.storage_format != dst_desc.format;
+    plan.separable = use_separable(desc, plan.src, plan.dst);
+    return SLANG_OK;
+}
+
+/// `entry_point` of resize.slang specialized for writing `format`.
+Slang::ComPtr<rhi::IComputePipeline> create_resize_pipeline(
+    Context &context,
+    const char *entry_point_name,
+    rhi::Format format) {
+
+    auto module = load_embedded_module(context, LLC_EMBEDDED_MODULE_DESC(resize));
+    if (!module) return nullptr;
+
+    Slang::ComPtr<slang::IEntryPoint> entry_point;
+    if (SLANG_FAILED(module->findEntryPointByName(entry_point_name, entry_point.writeRef()))) return nullptr;
+
+    const auto specialization_expr = mip_format_specialization_expr(format);
+    if (specialization_expr.empty()) return nullptr;
+
+    slang::SpecializationArg specialization_arg = slang::SpecializationArg::fromExpr(specialization_expr.c_str());
+    Slang::ComPtr<slang::IBlob> diagnostics;
+    Slang::ComPtr<slang::IComponentType> specialized_entry_point;
+    if (SLANG_FAILED(entry_point->specialize(
+            &specialization_arg,
+            1,
+            specialized_entry_point.writeRef(),
+            diagnostics.writeRef()))) {
+        diagnose_if_needed(diagnostics.get());
+        return nullptr;
+    }
+    diagnose_if_needed(diagnostics.get());
+
+    slang::IComponentType *const components[] = {module.get(), specialized_entry_point.get()};
+    Slang::ComPtr<slang::IComponentType> composed;
+    diagnostics = nullptr;
+    if (SLANG_FAILED(context.slang_session()->createCompositeComponentType(
+            components,
+            static_cast<SlangInt>(std::size(components)),
+            composed.writeRef(),
+            diagnostics.writeRef()))) {
+        diagnose_if_needed(diagnostics.get());
+        return nullptr;
+    }
+
+    Slang::ComPtr<slang::IComponentType> linked_program;
+    diagnostics = nullptr;
+    if (SLANG_FAILED(composed->link(linked_program.writeRef(), diagnostics.writeRef()))) {
+        diagnose_if_needed(diagnostics.get());
+        return nullptr;
+    }
+    diagnose_if_needed(diagnostics.get());
+
+    auto *device = context.device();
+    auto program = device->createShaderProgram(linked_program);
+    if (!program) return nullptr;
+
+    rhi::ComputePipelineDesc desc{};
+    desc.program = program.get();
+    return device->createComputePipeline(desc);
+}
+
+/// Encodes one dispatch of `resize2D`, or of `resizeAxis` along `axis` if it is set.
+SlangResult encode_resize_pass(
+    Context &context,
+    rhi::ICommandEncoder *encoder,
+    rhi::Format format,
+    const ResizePass &args,
+    ResizeFilter filter,
+    bool srgb,
+    std::optional<u32> axis) {
+
+    /// generate pipeline key for cache
+    const char *entry_point_name = axis ? "resizeAxis" : "resize2D";
+    SmallString<48> pipeline_key{"resize_"};
+    pipeline_key.append({entry_point_name, "_", mip_format_name(format)});
+
+    auto pipeline = get_cached_pipeline_handle(pipeline_cache(context), pipeline_key,
+                                               [&context, entry_point_name, format]() {
+                                                   return create_resize_pipeline(context, entry_point_name, format);
+                                               });
+    if (!pipeline) return SLANG_FAIL;
+
+    const u32 filter_type = static_cast<u32>(filter);
+    const u32 srgb_flag = srgb ? 1 : 0;
+    auto *pass = encoder->beginComputePass();
+    auto *root_object = pass->bindPipeline(pipeline.pipeline.get());
+    const auto offsets = axis ? pipeline.offsets->resolve(root_object, k_resize_axis_parameters)
+                              : pipeline.offsets->resolve(root_object, k_resize_parameters);
+    if (offsets.empty() ||
+        SLANG_FAILED(root_object->setData(offsets[RESIZE_SRC_ORIGIN], &args.src_origin, sizeof(args.src_origin))) ||
+        SLANG_FAILED(root_object->setData(offsets[RESIZE_SRC_SIZE], &args.src_size, sizeof(args.src_size))) ||
+        SLANG_FAILED(root_object->setData(offsets[RESIZE_DST_ORIGIN], &args.dst_origin, sizeof(args.dst_origin))) ||
+        SLANG_FAILED(root_object->setData(offsets[RESIZE_DST_SIZE], &args.dst_size, sizeof(args.dst_size))) ||
+        SLANG_FAILED(root_object->setData(offsets[RESIZE_FILTER], &filter_type, sizeof(filter_type))) ||
+        SLANG_FAILED(root_object->setData(offsets[RESIZE_SRGB], &srgb_flag, sizeof(srgb_flag))) ||
+        SLANG_FAILED(root_object->setBinding(offsets[RESIZE_SRC], rhi::Binding(args.src))) ||
+        SLANG_FAILED(root_object->setBinding(offsets[RESIZE_DST], rhi::Binding(args.dst))) ||
+        (axis && SLANG_FAILED(root_object->setData(offsets[RESIZE_AXIS], &*axis, sizeof(*axis))))) {
+        pass->end();
+        return SLANG_FAIL;
+    }
+    pass->dispatchCompute(
+        divide_and_round_up(args.dst_size.x, k_resize_tile),
+        divide_and_round_up(args.dst_size.y, k_resize_tile),
+        1);
+    pass->end();
+    return SLANG_OK;
+}
+
+Slang::ComPtr<rhi::ITexture> create_scratch_texture(
+    Context &context,
+    u32 width,
+    u32 height,
+    rhi::Format format,
+    rhi::TextureUsage usage) {
+
+    rhi::TextureDesc desc{};
+    desc.type = rhi::TextureType::Texture2D;
+    desc.size.width = width;
+    desc.size.height = height;
+    desc.size.depth = 1;
+    desc.mipCount = 1;
+    desc.arrayLength = 1;
+    desc.format = format;
+    desc.usage = usage;
+    desc.defaultState = rhi::ResourceState::UnorderedAccess;
+    return create_tracked_texture(context, desc, MemoryCategory::SCRATCH);
+}
+
+} // namespace
+
+rhi::TextureUsage resize_destination_usage(rhi::Format format) noexcept {
+    if (!mip_format_name(mip_storage_format(format))) return rhi::TextureUsage::None;
+    if (mip_storage_format(format) != format) return rhi::TextureUsage::CopyDestination;
+    return rhi::TextureUsage::UnorderedAccess;
+}
+
+SlangResult create_resize_scratch(
+    Context &context,
+    rhi::ITexture *source,
+    rhi::ITexture *destination,
+    const ResizeDesc &desc,
+    ResizeScratch &scratch) {
+
+    ResizePlan plan;
+    SLANG_RETURN_ON_FAIL(plan_resize(source, destination, desc, plan));
+
+    scratch = {};
+    if (plan.separable) {
+        scratch.intermediate = create_scratch_texture(
+            context,
+            plan.dst.width,
+            plan.src.height,
+            rhi::Format::RGBA32Float,
+            rhi::TextureUsage::ShaderResource | rhi::TextureUsage::UnorderedAccess);
+        if (!scratch.intermediate) return SLANG_E_OUT_OF_MEMORY;
+    }
+    if (plan.srgb) {
+        scratch.storage = create_scratch_texture(
+            context,
+            plan.dst.width,
+            plan.dst.height,
+            plan.storage_format,
+            rhi::TextureUsage::UnorderedAccess | rhi::TextureUsage::CopySource);
+        if (!scratch.storage) return SLANG_E_OUT_OF_MEMORY;
+    }
+    return SLANG_OK;
+}
+
+SlangResult encode_resize_texture(
+    Context &context,
+    rhi::ICommandEncoder *encoder,
+    rhi::ITexture *source,
+    rhi::ITexture *destination,
+    const ResizeDesc &desc,
+    const ResizeScratch &scratch) {
+
+    assert(encoder);
+    ResizePlan plan;
+    SLANG_RETURN_ON_FAIL(plan_resize(source, destination, desc, plan));
+    if ((plan.separable && !scratch.intermediate) || (plan.srgb && !scratch.storage)) return SLANG_E_INVALID_ARG;
+
+    // scratch belongs to the caller and is often dropped right after, so its views are not cached
+    auto src_view = cached_texture_view(context, source, desc.src_mip, desc.src_layer);
+    auto dst_view = plan.srgb ? create_texture_view(context, scratch.storage.get())
+                              : cached_texture_view(context, destination, desc.dst_mip, desc.dst_layer);
+    if (!src_view || !dst_view) return SLANG_FAIL;
+
+    const u32x2 src_origin{plan.src.x, plan.src.y};
+    const u32x2 src_size{plan.src.width, plan.src.height};
+    const u32x2 dst_origin = plan.srgb ? u32x2{0, 0} : u32x2{plan.dst.x, plan.dst.y};
+    const u32x2 dst_size{plan.dst.width, plan.dst.height};
+
+    if (plan.separable) {
+        auto intermediate_view = create_texture_view(context, scratch.intermediate.get());
+        if (!intermediate_view) return SLANG_FAIL;
+        const u32x2 intermediate_size{dst_size.x, src_size.y};
+        SLANG_RETURN_ON_FAIL(encode_resize_pass(
+            context,
+            encoder,
+            rhi::Format::RGBA32Float,
+            {src_view.get(), src_origin, src_size, intermediate_view.get(), u32x2{0, 0}, intermediate_size},
+            desc.filter,
+            false,
+            0u));
+        SLANG_RETURN_ON_FAIL(encode_resize_pass(
+            context,
+            encoder,
+            plan.storage_format,
+            {intermediate_view.get(), u32x2{0, 0}, intermediate_size, dst_view.get(), dst_origin, dst_size},
+            desc.filter,
+            plan.srgb,
+            1u));
+    } else {
+        SLANG_RETURN_ON_FAIL(encode_resize_pass(
+            context,
+            encoder,
+            plan.storage_format,
+            {src_view.get(), src_origin, src_size, dst_view.get(), dst_origin, dst_size},
+            desc.filter,
+            plan.srgb,
+            std::nullopt));
+    }
+
+    if (plan.srgb) {
+        encoder->copyTexture(
+            destination,
+            rhi::SubresourceRange{desc.dst_layer, 1, desc.dst_mip, 1},
+            rhi::Offset3D{static_cast<i32>(plan.dst.x), static_cast<i32>(plan.dst.y), 0},
+            scratch.storage.get(),
+            rhi::SubresourceRange{0, 1, 0, 1},
+            {},
+            {plan.dst.width, plan.dst.height, 1});
+    }
+    return SLANG_OK;
+}
+
+SlangResult resize_texture(
+    Context &context,
+    rhi::ITexture *source,
+    rhi::ITexture *destination,
+    const ResizeDesc &desc) {
+
+    ResizeScratch scratch;
+    SLANG_RETURN_ON_FAIL(create_resize_scratch(context, source, destination, desc, scratch));
+
+    auto queue = context.queue();
+    auto encoder = queue->createCommandEncoder();
+    SLANG_RETURN_ON_FAIL(encode_resize_texture(context, encoder.get(), source, destination, desc, scratch));
+
+    auto command_buffer = encoder->finish();
+    queue->submit(command_buffer);
+    queue->waitOnHost();
+    collect_memory(context);
+    return SLANG_OK;
+}
+
+Slang::ComPtr<rhi::ITexture> resize_texture(
+    Context &context,
+    rhi::ITexture *source,
+    u32 width,
+    u32 height,
+    const ResizeDesc &desc,
+    rhi::Format format,
+    rhi::TextureUsage usage) {
+
+    if (!source || width == 0 || height == 0) return nullptr;
+    const auto target_format = format == rhi::Format::Undefined ? source->getDesc().format : format;
+    const auto destination_usage = resize_destination_usage(target_format);
+    if (destination_usage == rhi::TextureUsage::None) return nullptr;
+
+    auto texture = create_texture_2d(
+        context,
+        width,
+        height,
+        target_format,
+        usage | destination_usage,
+        rhi::ResourceState::ShaderResource);
+    if (!texture) return nullptr;
+
+    ResizeDesc target_desc = desc;
+    target_desc.dst_rect = {};
+    target_desc.dst_mip = 0;
+    target_desc.dst_layer = 0;
+    const auto result = resize_texture(context, source, texture.get(), target_desc);
+    // a new texture is rarely resized into again, its cached view would only wait for the next collection
+    view_cache(context).release(texture.get());
+    if (SLANG_FAILED(result)) return nullptr;
+    return texture;
+}
+
+} // namespace llc::pp
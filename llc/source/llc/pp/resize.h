@@ -0,0 +1,109 @@
+#pragma once
+
+#include <slang-com-ptr.h>
+#include <slang-rhi.h>
+
+#include <llc/context.h>
+#include <llc/types.hpp>
+
+namespace llc::pp {
+
+/// Filter of `resize_texture`. Every filter widens with the factor when shrinking, so any factor
+/// reads every source texel; when enlarging they interpolate at their own width.
+enum class ResizeFilter : u32 {
+    /// average of the source texels a destination texel covers, weighted by the area covered
+    BOX,
+    /// triangle over two texels on each side when enlarging, the usual linear interpolation
+    BILINEAR,
+    /// Catmull-Rom, four texels on each side; sharper than bilinear, overshoots slightly at edges
+    BICUBIC,
+    /// Lanczos-3, six texels on each side; the sharpest, rings around hard edges
+    LANCZOS,
+};
+
+/// Whether a resize runs as one pass over both axes or as a horizontal and a vertical pass.
+enum class ResizePasses : u8 {
+    /// the separable passes when they read fewer texels, as they do for the larger filters and
+    /// factors, at the cost of an RGBA32Float intermediate of destination width and source height
+    AUTO,
+    SINGLE,
+    SEPARABLE,
+};
+
+/// Texels [x, x + width) x [y, y + height) of a mip; an empty rectangle is the whole mip.
+struct TextureRect final {
+    u32 x = 0;
+    u32 y = 0;
+    u32 width = 0;
+    u32 height = 0;
+
+    friend bool operator==(const TextureRect &, const TextureRect &) = default;
+};
+
+struct ResizeDesc final {
+    ResizeFilter filter = ResizeFilter::BILINEAR;
+    ResizePasses passes = ResizePasses::AUTO;
+    /// the crop of the source that is resampled
+    TextureRect src_rect{};
+    /// the region of the destination that is written; the rest is left as it is
+    TextureRect dst_rect{};
+    u32 src_mip = 0;
+    u32 src_layer = 0;
+    u32 dst_mip = 0;
+    u32 dst_layer = 0;
+};
+
+/// Scratch of `encode_resize_texture`, which must stay alive until its commands complete.
+struct ResizeScratch final {
+    /// result of the horizontal pass of the separable path
+    Slang::ComPtr<rhi::ITexture> intermediate;
+    /// linear copy of the destination region for sRGB destinations, which are not storable
+    Slang::ComPtr<rhi::ITexture> storage;
+};
+
+/// Usage a destination of `format` needs, `None` if textures of the format cannot be resized into.
+rhi::TextureUsage resize_destination_usage(rhi::Format format) noexcept;
+
+/// Creates the scratch `encode_resize_texture` needs for these arguments into `scratch`, accounted
+/// as `MemoryCategory::SCRATCH`; fields it does not need are left null.
+SlangResult create_resize_scratch(
+    Context &context,
+    rhi::ITexture *source,
+    rhi::ITexture *destination,
+    const ResizeDesc &desc,
+    ResizeScratch &scratch);
+
+/// Encodes the resampling of `desc.src_rect` of `source` into `desc.dst_rect` of `destination`, at
+/// any factor on either axis. Sources of any format that reads as float are accepted, sRGB ones
+/// are filtered in linear space. `destination` takes the formats mips can be generated for, with
+/// the usage `resize_destination_usage` returns. Returns SLANG_E_INVALID_ARG for rectangles outside
+/// their mip and for missing scratch, SLANG_E_NOT_IMPLEMENTED for other destination formats.
+SlangResult encode_resize_texture(
+    Context &context,
+    rhi::ICommandEncoder *encoder,
+    rhi::ITexture *source,
+    rhi::ITexture *destination,
+    const ResizeDesc &desc = {},
+    const ResizeScratch &scratch = {});
+
+/// `encode_resize_texture` in a submission of its own, with scratch of its own, waiting for it to
+/// complete.
+SlangResult resize_texture(
+    Context &context,
+    rhi::ITexture *source,
+    rhi::ITexture *destination,
+    const ResizeDesc &desc = {});
+
+/// A new `width` x `height` texture of `desc.src_rect` of `source`, in the format of `source`
+/// unless `format` is given, in `ShaderResource` state; the destination fields of `desc` are
+/// ignored. nullptr on failure.
+Slang::ComPtr<rhi::ITexture> resize_texture(
+    Context &context,
+    rhi::ITexture *source,
+    u32 width,
+    u32 height,
+    const ResizeDesc &desc = {},
+    rhi::Format format = rhi::Format::Undefined,
+    rhi::TextureUsage usage = rhi::TextureUsage::ShaderResource | rhi::TextureUsage::CopySource);
+
+} // namespace llc::pp
@@ -0,0 +1,50 @@
+#include "span_allocator.h"
+
+#include <algorithm>
+
+#include <llc/buffer.h>
+
+namespace llc {
+
+std::optional<SpanAllocator> SpanAllocator::create(Context &context, const SpanAllocatorDesc &desc) {
+    if (desc.block_size == 0 || desc.max_block_count == 0) return std::nullopt;
+
+    SpanAllocator allocator(context, desc);
+    if (!allocator.add_block(desc.block_size)) return std::nullopt;
+    return allocator;
+}
+
+bool SpanAllocator::add_block(u64 size) {
+    if (blocks_.size() >= desc_.max_block_count) return false;
+
+    auto block = create_buffer(*context_, size, desc_.usage);
+    if (!block) return false;
+    blocks_.push_back(std::move(block));
+    tlsf_.add_region(size);
+    return true;
+}
+
+SpanAllocation SpanAllocator::allocate(u64 byte_size, u64 alignment) {
+    auto allocation = tlsf_.allocate(byte_size, alignment);
+    if (!allocation) {
+        // a fresh block is aligned to more than any sane request, so only the rounded size counts
+        const u64 granularity = tlsf_.granularity();
+        const u64 rounded = (std::max<u64>(byte_size, 1) + granularity - 1) / granularity * granularity;
+        if (!add_block(std::max(desc_.block_size, rounded))) return {};
+        allocation = tlsf_.allocate(byte_size, alignment);
+        if (!allocation) return {};
+    }
+
+    return SpanAllocation{
+        .buffer = blocks_[allocation->region].get(),
+        .offset = allocation->offset,
+        .size = allocation->size,
+        .node = allocation->node,
+    };
+}
+
+void SpanAllocator::free(const SpanAllocation &allocation) {
+    if (allocation) tlsf_.free(allocation.node);
+}
+
+} // namespace llc
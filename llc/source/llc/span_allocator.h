@@ -0,0 +1,86 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <slang-com-ptr.h>
+#include <slang-rhi.h>
+
+#include <llc/context.h>
+#include <llc/span.h>
+#include <llc/types.hpp>
+#include <llc/utils/tlsf.h>
+
+namespace llc {
+
+struct SpanAllocatorDesc final {
+    /// Size of the device buffers that are carved up; larger requests get a block of their own.
+    u64 block_size = u64{64} << 20;
+    /// Blocks the allocator may create before allocations fail.
+    u32 max_block_count = 16;
+    /// Minimum alignment and size step of every allocation.
+    u64 granularity = 16;
+    rhi::BufferUsage usage = rhi::BufferUsage::ShaderResource | rhi::BufferUsage::UnorderedAccess |
+                             rhi::BufferUsage::CopySource | rhi::BufferUsage::CopyDestination;
+};
+
+/// A byte range of one of the allocator's blocks; empty if the allocation failed.
+struct SpanAllocation final {
+    rhi::IBuffer *buffer = nullptr;
+    u64 offset = 0;
+    u64 size = 0;
+    u32 node = 0;
+
+    explicit operator bool() const noexcept { return buffer != nullptr; }
+    [[nodiscard]] u64 device_address() const noexcept { return buffer->getDeviceAddress() + offset; }
+};
+
+/// Covers the whole allocation, which may be rounded up past the requested size.
+template <standard_layout T>
+GpuSpan make_span(const SpanAllocation &allocation) {
+    assert(allocation);
+    return make_span<T>(allocation.buffer, allocation.offset, allocation.size / sizeof(T));
+}
+
+template <standard_layout T>
+GpuSpan make_span(const SpanAllocation &allocation, u64 element_count) {
+    assert(allocation && element_count * sizeof(T) <= allocation.size);
+    return make_span<T>(allocation.buffer, allocation.offset, element_count);
+}
+
+/// Sub-allocates many small persistent device ranges from a few large buffers, so small tensors do
+/// not each pay for a driver allocation and its alignment. Ranges are addressed by device address
+/// (`make_span`), so shaders reach all of them through `Span<T>` without extra bindings.
+/// Not thread-safe.
+struct SpanAllocator final {
+    static std::optional<SpanAllocator> create(Context &context, const SpanAllocatorDesc &desc = {});
+
+    /// `alignment` must be a power of two, at least the granularity is used.
+    SpanAllocation allocate(u64 byte_size, u64 alignment = 0);
+
+    template <standard_layout T>
+    SpanAllocation allocate(u64 element_count) {
+        return allocate(element_count * sizeof(T), alignof(T));
+    }
+
+    /// The range may be handed out again right away, so the device must be done with it.
+    void free(const SpanAllocation &allocation);
+
+    /// Utilization and fragmentation over all blocks.
+    [[nodiscard]] TlsfStats stats() const noexcept { return tlsf_.stats(); }
+    [[nodiscard]] std::span<const Slang::ComPtr<rhi::IBuffer>> blocks() const noexcept { return blocks_; }
+
+private:
+    SpanAllocator(Context &context, const SpanAllocatorDesc &desc)
+        : context_(&context), desc_(desc), tlsf_(desc.granularity) {}
+
+    bool add_block(u64 size);
+
+    Context *context_;
+    SpanAllocatorDesc desc_;
+    TlsfAllocator tlsf_;
+    std::vector<Slang::ComPtr<rhi::IBuffer>> blocks_;
+};
+
+} // namespace llc
@@ -1,6 +1,7 @@
 #include "texture.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <mutex>
 #include <string>
@@ -9,21 +10,105 @@
 #include <slang-rhi/shader-cursor.h>
 
 #include <llc/blob.h>
+#include <llc/buffer.h>
+#include <llc/math.h>
+#include <llc/memory_tracker.h>
+#include <llc/mip_generator.h>
 #include <llc/types.hpp>
 
 #include <llc/utils/config.h>
-#include <llc/utils/embedded_module.h>
-#include <llc/utils/pipeline_cache.h>
+#include <llc/utils/parallel.h>
 #include <llc/utils/small_vector.h>
-#include <llc/utils/small_string.h>
-
-extern "C" const llc::u8 _binary_generate_mips_slang_module_start[]; // NOLINT
-extern "C" const llc::u8 _binary_generate_mips_slang_module_end[];   // NOLINT
 
 namespace llc {
 
 namespace {
 
+/// placement alignment of texture copies from and to buffers, the strictest among the backends
+constexpr usize k_staging_alignment = 512;
+
+struct MipExtent final {
+    u32 width;
+    u32 height;
+};
+
+MipExtent mip_extent(const rhi::TextureDesc &desc, u32 mip_level) noexcept {
+    return {std::max(1u, desc.size.width >> mip_level), std::max(1u, desc.size.height >> mip_level)};
+}
+
+/// Texture of `layers.size()` layers or depth slices, uploaded in one submission.
+Slang::ComPtr<rhi::ITexture> create_layered_texture(
+    Context &context,
+    rhi::TextureType type,
+    std::span<const Image> layers,
+    rhi::Format format,
+    rhi::TextureUsage usage,
+    rhi::ResourceState default_state) {
+
+    if (layers.empty() || !layers[0]) return nullptr;
+    const auto width = layers[0].width;
+    const auto height = layers[0].height;
+    const auto target_format = format == rhi::Format::Undefined ? layers[0].format : format;
+    const auto layer_count = static_cast<u32>(layers.size());
+
+    // layers already in the target format are uploaded as they are
+    std::vector<Image> converted(layers.size());
+    std::atomic<bool> valid{true};
+    parallel_for_chunks(layers.size(), parallel_chunk_count(layers.size(), 1), [&](usize begin, usize end, u32) {
+        for (usize i = begin; i < end; ++i) {
+            const auto &layer = layers[i];
+            if (!layer || layer.width != width || layer.height != height) {
+                valid = false;
+            } else if (layer.format != target_format) {
+                converted[i] = convert_image(layer, target_format);
+                if (!converted[i]) valid = false;
+            }
+        }
+    });
+    if (!valid) return nullptr;
+
+    const bool volume = type == rhi::TextureType::Texture3D;
+    rhi::TextureDesc desc{};
+    desc.type = type;
+    desc.size.width = width;
+    desc.size.height = height;
+    desc.size.depth = volume ? layer_count : 1;
+    desc.mipCount = 1;
+    desc.arrayLength = volume ? 1 : layer_count;
+    desc.format = target_format;
+    desc.usage = usage;
+    desc.defaultState = default_state;
+
+    auto texture = create_tracked_texture(context, desc);
+    if (!texture) return nullptr;
+
+    auto queue = context.queue();
+    auto encoder = queue->createCommandEncoder();
+    for (u32 i = 0; i < layer_count; ++i) {
+        const auto &image = converted[i] ? converted[i] : layers[i];
+        const rhi::SubresourceData data{
+            .data = image.data(),
+            .rowPitch = image.row_pitch,
+            .slicePitch = image.size_bytes,
+        };
+        rhi::Offset3D offset{};
+        offset.z = volume ? i : 0;
+        if (SLANG_FAILED(encoder->uploadTextureData(
+                texture,
+                rhi::SubresourceRange{volume ? 0 : i, 1, 0, 1},
+                offset,
+                rhi::Extent3D{width, height, 1},
+                &data,
+                1))) {
+            return nullptr;
+        }
+    }
+    queue->submit(encoder->finish());
+    queue->waitOnHost();
+    collect_memory(context);
+    return texture;
+}
+
 } // namespace
 
 u32 compute_max_mip_count(u32 width, u32 height) noexcept {
@@ -37,64 +122,7 @@ u32 compute_max_mip_count(u32 width, u32 height) noexcept {
 }
 
 bool supports_auto_mip_generation(rhi::Format format) noexcept {
-    return format == rhi::Format::RGBA8Unorm || format == rhi::Format::RGBA32Float;
-}
-
-std::string mip_format_specialization_expr(rhi::Format format) {
-    switch (format) {
-        case rhi::Format::RGBA8Unorm:
-            return std::to_string(static_cast<i32>(SLANG_IMAGE_FORMAT_rgba8));
-        case rhi::Format::RGBA32Float:
-            return std::to_string(static_cast<i32>(SLANG_IMAGE_FORMAT_rgba32f));
-        default:
-            return {};
-    }
-}
-
-Slang::ComPtr<rhi::IComputePipeline> create_generate_mips_pipeline(Context &context, rhi::Format format) {
-    auto module = load_embedded_module(context, EmbeddedModuleDesc{
-                                                    .name = "generate_mips",
-                                                    .start = _binary_generate_mips_slang_module_start,
-                                                    .end = _binary_generate_mips_slang_module_end,
-                                                });
-    if (!module) return nullptr;
-
-    Slang::ComPtr<slang::IEntryPoint> entry_point;
-    if (SLANG_FAILED(module->findEntryPointByName("mainCompute", entry_point.writeRef()))) {
-        return nullptr;
-    }
-
-    const auto specialization_expr = mip_format_specialization_expr(format);
-    if (specialization_expr.empty()) return nullptr;
-
-    slang::SpecializationArg specialization_arg = slang::SpecializationArg::fromExpr(specialization_expr.c_str());
-    Slang::ComPtr<slang::IBlob> diagnostics;
-    Slang::ComPtr<slang::IComponentType> specialized_entry_point;
-    if (SLANG_FAILED(entry_point->specialize(
-            &specialization_arg,
-            1,
-            specialized_entry_point.writeRef(),
-            diagnostics.writeRef()))) {
-        diagnose_if_needed(diagnostics.get());
-        return nullptr;
-    }
-    diagnose_if_needed(diagnostics.get());
-
-    Slang::ComPtr<slang::IComponentType> linked_program;
-    diagnostics = nullptr;
-    if (SLANG_FAILED(specialized_entry_point->link(linked_program.writeRef(), diagnostics.writeRef()))) {
-        diagnose_if_needed(diagnostics.get());
-        return nullptr;
-    }
-    diagnose_if_needed(diagnostics.get());
-
-    auto *device = context.device();
-    auto program = device->createShaderProgram(linked_program);
-    if (!program) return nullptr;
-
-    rhi::ComputePipelineDesc desc{};
-    desc.program = program.get();
-    return device->createComputePipeline(desc);
+    return mip_format_name(format) != nullptr;
 }
 
 bool validate_mip_image_chain(std::span<const Image> mip_images, rhi::Format format) noexcept {
@@ -140,63 +168,41 @@ bool upload_mip_images(
     auto command_buffer = encoder->finish();
     queue->submit(command_buffer);
     queue->waitOnHost();
+    collect_memory(context);
     return true;
 }
 
-bool generate_texture_mips(Context &context, rhi::ITexture *texture) {
-    const auto &desc = texture->getDesc();
-    if (desc.mipCount <= 1) return true;
-
-    /// generate pipeline key for cache
-    SmallString<32> pipeline_key{"generate_mips_"};
-    switch (desc.format) {
-        case rhi::Format::RGBA8Unorm:
-            pipeline_key.append("rgba8");
-            break;
-        case rhi::Format::RGBA32Float:
-            pipeline_key.append("rgba32f");
-            break;
-        default:
-            return false;
-    }
+u32 texture_layer_count(const rhi::TextureDesc &desc, u32 mip_level) noexcept {
+    if (desc.type == rhi::TextureType::Texture3D) return std::max(1u, desc.size.depth >> mip_level);
+    return std::max(desc.arrayLength, 1u);
+}
 
-    auto pipeline = get_cached_pipeline(pipeline_cache(context), pipeline_key,
-                                        [&context, &desc]() {
-                                            return create_generate_mips_pipeline(context, desc.format);
-                                        });
-    if (!pipeline) return false;
+usize texture_texel_count(const rhi::TextureDesc &desc) noexcept {
+    return static_cast<usize>(desc.size.width) * desc.size.height * texture_layer_count(desc);
+}
+
+SlangResult encode_generate_mips(
+    Context &context,
+    rhi::ICommandEncoder *encoder,
+    rhi::ITexture *texture,
+    MipFilter filter) {
+    return mip_generator(context).encode(context, encoder, texture, filter);
+}
+
+SlangResult generate_mips(Context &context, rhi::ITexture *texture, MipFilter filter) {
+    const auto &desc = texture->getDesc();
+    if (desc.mipCount <= 1) return SLANG_OK;
+    if (!mip_format_name(desc.format)) return SLANG_E_NOT_IMPLEMENTED;
 
     auto queue = context.queue();
     auto encoder = queue->createCommandEncoder();
-    for (u32 mip = 1; mip < desc.mipCount; ++mip) {
-        const auto src_width = std::max(1u, desc.size.width >> (mip - 1));
-        const auto src_height = std::max(1u, desc.size.height >> (mip - 1));
-        const auto dst_width = std::max(1u, desc.size.width >> mip);
-        const auto dst_height = std::max(1u, desc.size.height >> mip);
-
-        auto src_view = create_texture_view(context, texture, mip - 1);
-        auto dst_view = create_texture_view(context, texture, mip);
-        auto *pass = encoder->beginComputePass();
-        {
-            auto root_object = pass->bindPipeline(pipeline.get());
-            auto cursor = rhi::ShaderCursor(root_object);
-            const u32x2 src_size{src_width, src_height};
-            const u32x2 dst_size{dst_width, dst_height};
-            if (SLANG_FAILED(cursor["srcSize"].setData(src_size)) ||
-                SLANG_FAILED(cursor["dstSize"].setData(dst_size)) ||
-                SLANG_FAILED(cursor["src"].setBinding(src_view)) ||
-                SLANG_FAILED(cursor["dst"].setBinding(dst_view))) {
-                return false;
-            }
-            pass->dispatchCompute((dst_width + 15) / 16, (dst_height + 15) / 16, 1);
-        }
-        pass->end();
-    }
+    SLANG_RETURN_ON_FAIL(encode_generate_mips(context, encoder.get(), texture, filter));
 
     auto command_buffer = encoder->finish();
     queue->submit(command_buffer);
     queue->waitOnHost();
-    return true;
+    collect_memory(context);
+    return SLANG_OK;
 }
 
 Slang::ComPtr<rhi::ITexture> create_texture_2d(
@@ -217,7 +223,7 @@ Slang::ComPtr<rhi::ITexture> create_texture_2d(
     desc.format = format;
     desc.usage = usage;
     desc.defaultState = default_state;
-    return context.device()->createTexture(desc);
+    return create_tracked_texture(context, desc);
 }
 
 Slang::ComPtr<rhi::ITexture> create_texture_2d(
@@ -231,10 +237,15 @@ Slang::ComPtr<rhi::ITexture> create_texture_2d(
     if (!image || mip_count == 0) return nullptr;
 
     const auto target_format = format == rhi::Format::Undefined ? image.format : format;
-    auto converted_image = convert_image(image, target_format);
-    if (!converted_image) return nullptr;
+    // images already in the target format, such as those `load_image` decodes, upload as they are
+    Image converted_image;
+    if (image.format != target_format) {
+        converted_image = convert_image(image, target_format);
+        if (!converted_image) return nullptr;
+    }
+    const auto &source = converted_image ? converted_image : image;
 
-    const auto max_mip_count = compute_max_mip_count(converted_image.width, converted_image.height);
+    const auto max_mip_count = compute_max_mip_count(source.width, source.height);
     if (mip_count > max_mip_count) return nullptr;
 
     const auto auto_generate_mips = mip_count > 1;
@@ -244,13 +255,13 @@ Slang::ComPtr<rhi::ITexture> create_texture_2d(
 
     auto texture_usage = usage;
     if (auto_generate_mips) {
-        texture_usage = texture_usage | rhi::TextureUsage::UnorderedAccess;
+        texture_usage = texture_usage | mip_generation_usage(target_format);
     }
 
     rhi::TextureDesc desc{};
     desc.type = rhi::TextureType::Texture2D;
-    desc.size.width = converted_image.width;
-    desc.size.height = converted_image.height;
+    desc.size.width = source.width;
+    desc.size.height = source.height;
     desc.size.depth = 1;
     desc.mipCount = mip_count;
     desc.arrayLength = 1;
@@ -258,12 +269,12 @@ Slang::ComPtr<rhi::ITexture> create_texture_2d(
     desc.usage = texture_usage;
     desc.defaultState = default_state;
 
-    auto texture = context.device()->createTexture(desc);
+    auto texture = create_tracked_texture(context, desc);
     if (!texture) return nullptr;
-    if (!upload_mip_images(context, texture.get(), std::span<const Image>(&converted_image, 1))) {
+    if (!upload_mip_images(context, texture.get(), std::span<const Image>(&source, 1))) {
         return nullptr;
     }
-    if (auto_generate_mips && !generate_texture_mips(context, texture.get())) {
+    if (auto_generate_mips && SLANG_FAILED(generate_mips(context, texture.get()))) {
         return nullptr;
     }
     return texture;
@@ -301,7 +312,7 @@ Slang::ComPtr<rhi::ITexture> create_texture_2d(
     desc.usage = usage;
     desc.defaultState = default_state;
 
-    auto texture = context.device()->createTexture(desc);
+    auto texture = create_tracked_texture(context, desc);
     if (!texture) return nullptr;
     if (!upload_mip_images(context, texture.get(), converted_span)) {
         return nullptr;
@@ -309,6 +320,140 @@ Slang::ComPtr<rhi::ITexture> create_texture_2d(
     return texture;
 }
 
+Slang::ComPtr<rhi::ITexture> create_texture_2d_array(
+    Context &context,
+    std::span<const Image> layers,
+    rhi::Format format,
+    rhi::TextureUsage usage,
+    rhi::ResourceState default_state) {
+    return create_layered_texture(context, rhi::TextureType::Texture2DArray, layers, format, usage, default_state);
+}
+
+Slang::ComPtr<rhi::ITexture> create_texture_3d(
+    Context &context,
+    std::span<const Image> slices,
+    rhi::Format format,
+    rhi::TextureUsage usage,
+    rhi::ResourceState default_state) {
+    return create_layered_texture(context, rhi::TextureType::Texture3D, slices, format, usage, default_state);
+}
+
+std::vector<Slang::ComPtr<rhi::ITexture>> create_textures_2d(Context &context, std::span<const TextureUpload> uploads) {
+    const usize count = uploads.size();
+    std::vector<Slang::ComPtr<rhi::ITexture>> textures(count);
+
+    // every texture is created up front, so the layout of the staging buffer is known before any
+    // image is converted
+    std::vector<usize> staging_offsets(count);
+    std::vector<usize> row_pitches(count);
+    usize staging_size = 0;
+    for (usize i = 0; i < count; ++i) {
+        const auto &upload = uploads[i];
+        if (!upload.image || !*upload.image || upload.mip_count == 0) continue;
+
+        const auto &image = *upload.image;
+        const auto target_format = upload.format == rhi::Format::Undefined ? image.format : upload.format;
+        if (upload.mip_count > compute_max_mip_count(image.width, image.height)) continue;
+        if (upload.mip_count > 1 && !supports_auto_mip_generation(target_format)) continue;
+
+        rhi::TextureDesc desc{};
+        desc.type = rhi::TextureType::Texture2D;
+        desc.size.width = image.width;
+        desc.size.height = image.height;
+        desc.size.depth = 1;
+        desc.mipCount = upload.mip_count;
+        desc.arrayLength = 1;
+        desc.format = target_format;
+        desc.usage = upload.mip_count > 1 ? upload.usage | mip_generation_usage(target_format) : upload.usage;
+        desc.defaultState = upload.default_state;
+
+        auto texture = create_tracked_texture(context, desc);
+        rhi::SubresourceLayout layout{};
+        if (!texture || SLANG_FAILED(texture->getSubresourceLayout(0, &layout))) continue;
+
+        staging_offsets[i] = divide_and_round_up(staging_size, k_staging_alignment) * k_staging_alignment;
+        row_pitches[i] = layout.rowPitch;
+        staging_size = staging_offsets[i] + layout.rowPitch * image.height;
+        textures[i] = std::move(texture);
+    }
+    if (staging_size == 0) return textures;
+
+    auto staging = create_buffer(
+        context,
+        staging_size,
+        rhi::BufferUsage::CopySource,
+        nullptr,
+        rhi::MemoryType::Upload,
+        rhi::ResourceState::CopySource);
+    void *mapped = nullptr;
+    auto *device = context.device();
+    if (!staging || SLANG_FAILED(device->mapBuffer(staging.get(), rhi::CpuAccessMode::Write, &mapped))) {
+        return std::vector<Slang::ComPtr<rhi::ITexture>>(count);
+    }
+
+    // images differ wildly in size, so threads take the next image rather than a fixed slice
+    std::atomic<usize> next{0};
+    parallel_for_chunks(count, parallel_chunk_count(count, 1), [&](usize, usize, u32) {
+        for (usize i = next++; i < count; i = next++) {
+            if (!textures[i]) continue;
+            const auto &image = *uploads[i].image;
+            const auto format = textures[i]->getDesc().format;
+            Image converted;
+            if (format != image.format) {
+                converted = convert_image(image, format);
+                if (!converted) {
+                    textures[i] = nullptr;
+                    continue;
+                }
+            }
+            const auto &source = converted ? converted : image;
+            const usize row_size = static_cast<usize>(source.width) * bytes_per_pixel(format);
+            auto *dst = static_cast<byte *>(mapped) + staging_offsets[i];
+            if (source.row_pitch == row_pitches[i]) {
+                std::memcpy(dst, source.data(), (source.height - 1) * source.row_pitch + row_size);
+                continue;
+            }
+            for (u32 y = 0; y < source.height; ++y) {
+                std::memcpy(dst + y * row_pitches[i], source.row_data(y), row_size);
+            }
+        }
+    });
+    device->unmapBuffer(staging.get());
+
+    auto queue = context.queue();
+    auto encoder = queue->createCommandEncoder();
+    for (usize i = 0; i < count; ++i) {
+        if (!textures[i]) continue;
+        const auto &desc = textures[i]->getDesc();
+        encoder->copyBufferToTexture(
+            textures[i].get(),
+            0,
+            0,
+            {},
+            staging.get(),
+            staging_offsets[i],
+            row_pitches[i] * desc.size.height,
+            row_pitches[i],
+            rhi::Extent3D{desc.size.width, desc.size.height, 1});
+    }
+    for (usize i = 0; i < count; ++i) {
+        if (!textures[i] || textures[i]->getDesc().mipCount <= 1) continue;
+        if (SLANG_FAILED(encode_generate_mips(context, encoder.get(), textures[i].get(), uploads[i].mip_filter))) {
+            textures[i] = nullptr;
+        }
+    }
+    queue->submit(encoder->finish());
+    queue->waitOnHost();
+    collect_memory(context);
+
+    // a batch is loaded once, its views would only crowd out those of chains regenerated per frame
+    auto &generator = mip_generator(context);
+    for (const auto &texture : textures) {
+        if (texture && texture->getDesc().mipCount > 1) generator.release(texture.get());
+    }
+    return textures;
+}
+
 Slang::ComPtr<rhi::ITextureView> create_texture_view(
     Context &context,
     rhi::ITexture *texture,
@@ -327,33 +472,180 @@ Slang::ComPtr<rhi::ITextureView> create_texture_view(
     return context.device()->createTextureView(texture, desc);
 }
 
-Image read_texture_to_image(
+usize texture_row_pitch(rhi::ITexture *texture, u32 mip_level) {
+    rhi::SubresourceLayout layout{};
+    if (SLANG_FAILED(texture->getSubresourceLayout(mip_level, &layout))) return 0;
+    return layout.rowPitch;
+}
+
+SlangResult read_texture_into(
     Context &context,
     rhi::ITexture *texture,
+    std::span<byte> dst,
+    usize row_pitch,
     u32 array_layer,
     u32 mip_level) {
 
-    Slang::ComPtr<ISlangBlob> blob;
+    const auto &desc = texture->getDesc();
+    const auto extent = mip_extent(desc, mip_level);
+    const usize row_bytes = static_cast<usize>(extent.width) * bytes_per_pixel(desc.format);
+    if (row_bytes == 0) return SLANG_E_NOT_IMPLEMENTED;
+    if (row_pitch < row_bytes || dst.size() < static_cast<usize>(extent.height - 1) * row_pitch + row_bytes) {
+        return SLANG_E_INVALID_ARG;
+    }
+
     rhi::SubresourceLayout layout{};
-    if (SLANG_FAILED(context.device()->readTexture(texture, array_layer, mip_level, blob.writeRef(), &layout))) {
+    SLANG_RETURN_ON_FAIL(texture->getSubresourceLayout(mip_level, &layout));
+    if (layout.rowPitch == row_pitch && dst.size() >= layout.sizeInBytes) {
+        return context.device()->readTexture(texture, array_layer, mip_level, layout, dst.data());
+    }
+
+    Slang::ComPtr<ISlangBlob> blob;
+    SLANG_RETURN_ON_FAIL(context.device()->readTexture(texture, array_layer, mip_level, blob.writeRef(), &layout));
+    const auto *src = static_cast<const byte *>(blob->getBufferPointer());
+    if (layout.rowPitch == row_pitch) {
+        std::memcpy(dst.data(), src, static_cast<usize>(extent.height - 1) * row_pitch + row_bytes);
+        return SLANG_OK;
+    }
+    for (u32 y = 0; y < extent.height; ++y) {
+        std::memcpy(dst.data() + static_cast<usize>(y) * row_pitch, src + static_cast<usize>(y) * layout.rowPitch, row_bytes);
+    }
+    return SLANG_OK;
+}
+
+SlangResult read_texture_into(
+    Context &context,
+    rhi::ITexture *texture,
+    Image &image,
+    u32 array_layer,
+    u32 mip_level) {
+
+    const auto &desc = texture->getDesc();
+    const auto extent = mip_extent(desc, mip_level);
+    const usize row_bytes = static_cast<usize>(extent.width) * bytes_per_pixel(desc.format);
+    if (row_bytes == 0) return SLANG_E_NOT_IMPLEMENTED;
+
+    if (!image || image.width != extent.width || image.height != extent.height || image.format != desc.format) {
+        const usize device_pitch = texture_row_pitch(texture, mip_level);
+        image = Image(extent.width, extent.height, desc.format, std::max(device_pitch, row_bytes));
+    }
+    return read_texture_into(
+        context,
+        texture,
+        std::span<byte>(image.data(), image.size_bytes),
+        image.row_pitch,
+        array_layer,
+        mip_level);
+}
+
+Image read_texture_to_image(
+    Context &context,
+    rhi::ITexture *texture,
+    u32 array_layer,
+    u32 mip_level) {
+
+    const auto &desc = texture->getDesc();
+    const usize pixel_stride = bytes_per_pixel(desc.format);
+    if (pixel_stride == 0) {
+        LLC_PANIC("Unsupported texture format for Image readback.");
+    }
+
+    // tightly packed, unlike the images `read_texture_into` allocates
+    const auto extent = mip_extent(desc, mip_level);
+    Image image(extent.width, extent.height, desc.format, static_cast<usize>(extent.width) * pixel_stride);
+    if (SLANG_FAILED(read_texture_into(context, texture, image, array_layer, mip_level))) {
         LLC_PANIC("Failed to read back texture data from device.");
     }
+    return image;
+}
+
+SlangResult read_texture_layers_into(
+    Context &context,
+    rhi::ITexture *texture,
+    std::span<byte> dst,
+    usize row_pitch,
+    u32 mip_level) {
+
+    const auto &desc = texture->getDesc();
+    const auto extent = mip_extent(desc, mip_level);
+    const u32 layer_count = texture_layer_count(desc, mip_level);
+    const usize row_size = static_cast<usize>(extent.width) * bytes_per_pixel(desc.format);
+    const usize layer_size = row_pitch * extent.height;
+    if (row_size == 0 || row_pitch < row_size || dst.size() < layer_size * layer_count) return SLANG_E_INVALID_ARG;
+
+    const bool volume = desc.type == rhi::TextureType::Texture3D;
+    if (!volume && layer_count == 1) return read_texture_into(context, texture, dst, row_pitch, 0, mip_level);
+
+    // every layer is copied into one readback buffer, so the layers cost a single wait
+    rhi::SubresourceLayout layout{};
+    SLANG_RETURN_ON_FAIL(texture->getSubresourceLayout(mip_level, &layout));
+    const usize device_layer_size =
+        divide_and_round_up(static_cast<usize>(layout.rowPitch) * extent.height, k_staging_alignment) * k_staging_alignment;
+    auto readback = create_buffer(
+        context,
+        device_layer_size * layer_count,
+        rhi::BufferUsage::CopyDestination,
+        nullptr,
+        rhi::MemoryType::ReadBack,
+        rhi::ResourceState::CopyDestination);
+    if (!readback) return SLANG_E_OUT_OF_MEMORY;
+
+    auto queue = context.queue();
+    auto encoder = queue->createCommandEncoder();
+    for (u32 layer = 0; layer < layer_count; ++layer) {
+        rhi::Offset3D offset{};
+        offset.z = volume ? layer : 0;
+        encoder->copyTextureToBuffer(
+            readback.get(),
+            layer * device_layer_size,
+            device_layer_size,
+            layout.rowPitch,
+            texture,
+            volume ? 0 : layer,
+            mip_level,
+            offset,
+            rhi::Extent3D{extent.width, extent.height, 1});
+    }
+    queue->submit(encoder->finish());
+    queue->waitOnHost();
+    collect_memory(context);
+
+    auto *device = context.device();
+    void *mapped = nullptr;
+    SLANG_RETURN_ON_FAIL(device->mapBuffer(readback.get(), rhi::CpuAccessMode::Read, &mapped));
+    const auto *src = static_cast<const byte *>(mapped);
+    for (u32 layer = 0; layer < layer_count; ++layer) {
+        for (u32 y = 0; y < extent.height; ++y) {
+            std::memcpy(
+                dst.data() + layer * layer_size + y * row_pitch,
+                src + layer * device_layer_size + y * layout.rowPitch,
+                row_size);
+        }
+    }
+    device->unmapBuffer(readback.get());
+    return SLANG_OK;
+}
 
+Image read_texture_layers_to_image(Context &context, rhi::ITexture *texture, u32 mip_level) {
     const auto &desc = texture->getDesc();
-    const u32 mip_width = desc.size.width >> mip_level;
-    const u32 mip_height = desc.size.height >> mip_level;
-    const u32 width = mip_width > 0 ? mip_width : 1u;
-    const u32 height = mip_height > 0 ? mip_height : 1u;
     const usize pixel_stride = bytes_per_pixel(desc.format);
     if (pixel_stride == 0) {
         LLC_PANIC("Unsupported texture format for Image readback.");
     }
 
-    Image image(width, height, desc.format, static_cast<usize>(width) * pixel_stride);
-    for (u32 y = 0; y < height; ++y) {
-        const auto *src =
-            static_cast<const byte *>(blob->getBufferPointer()) + static_cast<usize>(y) * layout.rowPitch;
-        std::memcpy(image.row_data(y), src, image.row_pitch);
+    const auto extent = mip_extent(desc, mip_level);
+    Image image(
+        extent.width,
+        extent.height * texture_layer_count(desc, mip_level),
+        desc.format,
+        static_cast<usize>(extent.width) * pixel_stride);
+    if (SLANG_FAILED(read_texture_layers_into(
+            context,
+            texture,
+            std::span<byte>(image.data(), image.size_bytes),
+            image.row_pitch,
+            mip_level))) {
+        LLC_PANIC("Failed to read back texture data from device.");
     }
     return image;
 }
@@ -1,17 +1,30 @@
 #pragma once
 
 #include <cassert>
+#include <optional>
 #include <span>
+#include <vector>
 
 #include <slang-com-ptr.h>
 #include <slang-rhi.h>
 
+#include <llc/autotune.h>
 #include <llc/context.h>
 #include <llc/image.h>
 #include <llc/types.hpp>
 
 namespace llc {
 
+/// Filter each mip is reduced from the one above it with.
+enum class MipFilter : u8 {
+    /// average of the texels each destination texel covers, weighted by the area covered
+    BOX,
+    /// sinc windowed by a Kaiser window over three destination texels, sharper than the box
+    KAISER,
+    /// Lanczos-3, the sharpest, may ring around hard edges
+    LANCZOS,
+};
+
 Slang::ComPtr<rhi::ITexture> create_texture_2d(
     Context &context,
     u32 width,
@@ -35,6 +48,46 @@ Slang::ComPtr<rhi::ITexture> create_texture_2d(
     rhi::TextureUsage usage = rhi::TextureUsage::ShaderResource | rhi::TextureUsage::CopyDestination,
     rhi::ResourceState default_state = rhi::ResourceState::ShaderResource);
 
+/// Texture array with one layer per image, all of the size of the first. Images in another format
+/// than `format` are converted on all hardware threads; every layer is uploaded in one submission.
+Slang::ComPtr<rhi::ITexture> create_texture_2d_array(
+    Context &context,
+    std::span<const Image> layers,
+    rhi::Format format = rhi::Format::Undefined,
+    rhi::TextureUsage usage = rhi::TextureUsage::ShaderResource | rhi::TextureUsage::CopyDestination,
+    rhi::ResourceState default_state = rhi::ResourceState::ShaderResource);
+
+/// `create_texture_2d_array` for a 3D texture, one depth slice per image.
+Slang::ComPtr<rhi::ITexture> create_texture_3d(
+    Context &context,
+    std::span<const Image> slices,
+    rhi::Format format = rhi::Format::Undefined,
+    rhi::TextureUsage usage = rhi::TextureUsage::ShaderResource | rhi::TextureUsage::CopyDestination,
+    rhi::ResourceState default_state = rhi::ResourceState::ShaderResource);
+
+/// Layers of an array texture, depth slices of a mip of a 3D texture.
+u32 texture_layer_count(const rhi::TextureDesc &desc, u32 mip_level = 0) noexcept;
+/// Texels of mip 0 over every layer or slice.
+usize texture_texel_count(const rhi::TextureDesc &desc) noexcept;
+
+/// One texture of `create_textures_2d`: the parameters `create_texture_2d` takes for an image.
+struct TextureUpload final {
+    const Image *image = nullptr;
+    /// mips of the texture, those below the image are generated
+    u32 mip_count = 1;
+    rhi::Format format = rhi::Format::Undefined;
+    rhi::TextureUsage usage = rhi::TextureUsage::ShaderResource | rhi::TextureUsage::CopyDestination;
+    rhi::ResourceState default_state = rhi::ResourceState::ShaderResource;
+    MipFilter mip_filter = MipFilter::BOX;
+};
+
+/// `create_texture_2d` for many images in one round trip instead of one per image: the images are
+/// converted on all hardware threads straight into a single staging buffer, and uploaded with their
+/// mips generated in a single submission. The result has one entry per upload; those whose image is
+/// empty, cannot be converted or cannot take its mip count are nullptr, all of them if the staging
+/// buffer cannot be made.
+std::vector<Slang::ComPtr<rhi::ITexture>> create_textures_2d(Context &context, std::span<const TextureUpload> uploads);
+
 struct TextureViewRange final {
     rhi::Format format = rhi::Format::Undefined;
     rhi::TextureAspect aspect = rhi::TextureAspect::All;
@@ -43,6 +96,8 @@ struct TextureViewRange final {
     u32 base_mip = 0;
     u32 mip_count = 1;
     rhi::ISampler *sampler = nullptr;
+
+    friend bool operator==(const TextureViewRange &, const TextureViewRange &) = default;
 };
 
 Slang::ComPtr<rhi::ITextureView> create_texture_view(
@@ -72,4 +127,69 @@ Image read_texture_to_image(
     u32 array_layer = 0,
     u32 mip_level = 0);
 
+/// Reads a subresource into caller-owned memory, e.g. a page-locked staging area, whose rows are
+/// `row_pitch` bytes apart. Rows are read in place when `row_pitch` matches the device layout
+/// (see `texture_row_pitch`), otherwise they are copied one by one from an intermediate blob.
+SlangResult read_texture_into(
+    Context &context,
+    rhi::ITexture *texture,
+    std::span<byte> dst,
+    usize row_pitch,
+    u32 array_layer = 0,
+    u32 mip_level = 0);
+
+/// Reads a subresource into `image`, reusing its allocation when size and format already match.
+/// A reallocated image takes the device row pitch, so reading every frame into the same image
+/// costs a single copy out of the readback memory.
+SlangResult read_texture_into(
+    Context &context,
+    rhi::ITexture *texture,
+    Image &image,
+    u32 array_layer = 0,
+    u32 mip_level = 0);
+
+/// Reads every layer, or depth slice, of a mip into caller-owned memory in a single submission:
+/// layer `i` starts at `i * row_pitch * height` bytes of `dst`.
+SlangResult read_texture_layers_into(
+    Context &context,
+    rhi::ITexture *texture,
+    std::span<byte> dst,
+    usize row_pitch,
+    u32 mip_level = 0);
+
+/// `read_texture_layers_into` an image whose layers are stacked vertically, `height` rows each.
+Image read_texture_layers_to_image(Context &context, rhi::ITexture *texture, u32 mip_level = 0);
+
+/// Row pitch of the device readback layout of a mip, 0 if the layout is unavailable.
+usize texture_row_pitch(rhi::ITexture *texture, u32 mip_level = 0);
+
+/// Mips of a full chain down to 1x1 from a `width` x `height` base.
+u32 compute_max_mip_count(u32 width, u32 height) noexcept;
+
+/// Encodes the generation of every mip below mip 0, for each layer, into `encoder`. Box-filtered
+/// chains with power-of-two sides take a single dispatch per layer up to 4096 texels on a side
+/// (see `MipGenerator`), other sizes and filters one pass per level. sRGB textures are averaged in
+/// linear space. `texture` needs the usage `mip_generation_usage` returns for its format.
+SlangResult encode_generate_mips(
+    Context &context,
+    rhi::ICommandEncoder *encoder,
+    rhi::ITexture *texture,
+    MipFilter filter = MipFilter::BOX);
+
+/// `encode_generate_mips` in a submission of its own, waiting for it to complete.
+SlangResult generate_mips(Context &context, rhi::ITexture *texture, MipFilter filter = MipFilter::BOX);
+
+/// Usage a texture of `format` needs for `encode_generate_mips`, `None` if mips cannot be
+/// generated for the format. Formats without storage support, sRGB, are generated in a copy.
+rhi::TextureUsage mip_generation_usage(rhi::Format format) noexcept;
+
+/// Benchmarks tile sizes of the per-level mip kernel for `format` on a `width` x `height` chain and
+/// stores the fastest in the context's tuning profile, which that kernel is specialized with.
+std::optional<LaunchConfig> tune_generate_mips(
+    Context &context,
+    rhi::Format format,
+    u32 width = 2048,
+    u32 height = 2048,
+    const TuneOptions &options = {});
+
 } // namespace llc
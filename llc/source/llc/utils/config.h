@@ -89,3 +89,23 @@
         std::fputs("PANIC: " message "\n", stderr); \
         std::abort();                               \
     } while (false)
+
+// Host SIMD feature macros for the CPU-side kernels. AVX2/F16C are opt-in at build time
+// (`xmake f --avx2=y`), NEON is baseline on arm64. MSVC has no __F16C__, but /arch:AVX2 implies it.
+#if defined(__AVX2__)
+#define LLC_SIMD_AVX2 1
+#else
+#define LLC_SIMD_AVX2 0
+#endif
+
+#if defined(__F16C__) || (LLC_COMPILER_MSVC && LLC_SIMD_AVX2)
+#define LLC_SIMD_F16C 1
+#else
+#define LLC_SIMD_F16C 0
+#endif
+
+#if defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#define LLC_SIMD_NEON 1
+#else
+#define LLC_SIMD_NEON 0
+#endif
@@ -1,8 +1,10 @@
 #include "embedded_module.h"
 
+#include <cstring>
 #include <span>
 #include <llc/scalar_types.hpp>
 #include <llc/blob.h>
+#include <llc/utils/module_registry.h>
 
 namespace llc {
 
@@ -10,7 +12,17 @@ Slang::ComPtr<slang::IModule> load_embedded_module(
     slang::ISession *session,
     EmbeddedModuleDesc const &desc) {
 
-    auto blob = Slang::ComPtr<FileBlob>(new FileBlob(std::span<const byte>(
+    // a module imported or loaded before is already in the session, loading it again would only
+    // deserialize the same IR
+    for (SlangInt i = 0; i < session->getLoadedModuleCount(); ++i) {
+        auto *loaded = session->getLoadedModule(i);
+        if (loaded && loaded->getName() && std::strcmp(loaded->getName(), desc.name) == 0) {
+            return Slang::ComPtr<slang::IModule>(loaded);
+        }
+    }
+
+    // the embedded data lives as long as the program, so the blob only has to point at it
+    auto blob = Slang::ComPtr<ViewBlob>(new ViewBlob(std::span<const byte>(
         reinterpret_cast<const byte *>(desc.start),
         reinterpret_cast<const byte *>(desc.end))));
 
@@ -24,7 +36,13 @@ Slang::ComPtr<slang::IModule> load_embedded_module(
 Slang::ComPtr<slang::IModule> load_embedded_module(
     Context &context,
     EmbeddedModuleDesc const &desc) {
-    return load_embedded_module(context.slang_session(), desc);
+
+    auto &registry = module_registry(context);
+    if (auto module = find_registered_module(registry, desc.name)) return module;
+
+    auto module = load_embedded_module(context.slang_session(), desc);
+    if (module) register_module(registry, desc.name, module.get());
+    return module;
 }
 
 } // namespace llc
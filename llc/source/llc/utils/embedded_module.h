@@ -12,11 +12,27 @@ struct EmbeddedModuleDesc final {
     const u8 *end;
 };
 
-/// Loads a precompiled Slang IR module from embedded binary data into the given Slang session.
+/// Declares the symbols the `slang` build rule emits for `<name>.slang` (added with `slang_embed = true`).
+/// Use at global scope.
+#define LLC_DECLARE_EMBEDDED_MODULE(name)                                        \
+    extern "C" const llc::u8 _binary_##name##_slang_module_start[]; /* NOLINT */ \
+    extern "C" const llc::u8 _binary_##name##_slang_module_end[];   /* NOLINT */
+
+/// Describes a module declared with `LLC_DECLARE_EMBEDDED_MODULE`; usable in constant expressions.
+#define LLC_EMBEDDED_MODULE_DESC(module_name)                                    \
+    ::llc::EmbeddedModuleDesc {                                                  \
+        .name = #module_name,                                                    \
+        .start = _binary_##module_name##_slang_module_start,                     \
+        .end = _binary_##module_name##_slang_module_end,                         \
+    }
+
+/// Loads a precompiled Slang IR module from embedded binary data into the given Slang session,
+/// without copying the data. Returns the already loaded module if the session has one of that name.
 Slang::ComPtr<slang::IModule> load_embedded_module(slang::ISession *session, EmbeddedModuleDesc const &desc);
 
 /// Loads a precompiled Slang IR module from embedded binary data into the device's Slang session.
-/// The module is registered by name so subsequent `import` statements can resolve it.
+/// The module is registered by name so subsequent `import` statements can resolve it, and later
+/// calls return it from the context's module registry.
 Slang::ComPtr<slang::IModule> load_embedded_module(Context &context, EmbeddedModuleDesc const &desc);
 
 } // namespace llc
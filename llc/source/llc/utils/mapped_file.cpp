@@ -0,0 +1,143 @@
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace llc {
+
+std::optional<MappedFile> MappedFile::open(const std::filesystem::path &path, MapAccess access) {
+    MappedFile file;
+
+#if defined(_WIN32)
+    const DWORD flags = access == MapAccess::RANDOM ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN;
+    HANDLE handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return std::nullopt;
+
+    LARGE_INTEGER file_size{};
+    if (!GetFileSizeEx(handle, &file_size)) {
+        CloseHandle(handle);
+        return std::nullopt;
+    }
+    if (file_size.QuadPart == 0) {
+        CloseHandle(handle);
+        return file;
+    }
+
+    // the mapping object keeps the file open, the file handle itself is no longer needed
+    HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(handle);
+    if (!mapping) return std::nullopt;
+
+    const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        return std::nullopt;
+    }
+    file.mapping_ = mapping;
+    file.data_ = static_cast<const byte *>(view);
+    file.size_ = static_cast<usize>(file_size.QuadPart);
+    if (access == MapAccess::WILL_NEED) file.prefetch(0, file.size_);
+
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return std::nullopt;
+
+    struct stat stats{};
+    if (::fstat(fd, &stats) != 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+    if (stats.st_size == 0) {
+        ::close(fd);
+        return file;
+    }
+
+    // the mapping holds its own reference to the file, so the descriptor can go right away
+    void *view = ::mmap(nullptr, static_cast<usize>(stats.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) return std::nullopt;
+
+    file.data_ = static_cast<const byte *>(view);
+    file.size_ = static_cast<usize>(stats.st_size);
+
+    // advice only tunes paging, a failure leaves a perfectly usable mapping
+    switch (access) {
+        case MapAccess::SEQUENTIAL:
+            (void) ::posix_madvise(view, file.size_, POSIX_MADV_SEQUENTIAL);
+            break;
+        case MapAccess::RANDOM:
+            (void) ::posix_madvise(view, file.size_, POSIX_MADV_RANDOM);
+            break;
+        case MapAccess::WILL_NEED:
+            file.prefetch(0, file.size_);
+            break;
+    }
+#endif
+
+    return file;
+}
+
+void MappedFile::prefetch(usize offset, usize size) const noexcept {
+    if (offset >= size_ || size == 0) return;
+    size = std::min(size, size_ - offset);
+
+#if defined(_WIN32)
+    WIN32_MEMORY_RANGE_ENTRY range{const_cast<byte *>(data_ + offset), size};
+    (void) PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    // madvise wants a page aligned start
+    static const auto page_size = static_cast<usize>(::sysconf(_SC_PAGESIZE));
+    const usize aligned_offset = offset / page_size * page_size;
+    (void) ::posix_madvise(const_cast<byte *>(data_ + aligned_offset), size + (offset - aligned_offset),
+                           POSIX_MADV_WILLNEED);
+#endif
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0))
+#if defined(_WIN32)
+      ,
+      mapping_(std::exchange(other.mapping_, nullptr))
+#endif
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        reset();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+#if defined(_WIN32)
+        mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    reset();
+}
+
+void MappedFile::reset() noexcept {
+#if defined(_WIN32)
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    mapping_ = nullptr;
+#else
+    if (data_) ::munmap(const_cast<byte *>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+} // namespace llc
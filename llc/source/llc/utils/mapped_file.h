@@ -0,0 +1,51 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <span>
+
+#include <llc/scalar_types.hpp>
+
+namespace llc {
+
+/// Access pattern hint passed to the kernel for a mapping (madvise / PrefetchVirtualMemory).
+enum class MapAccess : u8 {
+    /// read front to back: aggressive readahead, pages behind the reader can be dropped early
+    SEQUENTIAL,
+    /// scattered reads: no readahead beyond the touched page
+    RANDOM,
+    /// all of it is needed soon: start reading the whole file in right away
+    WILL_NEED,
+};
+
+/// Read-only memory mapping of a whole file. Pages are loaded on first touch, so mapping a file
+/// larger than RAM is fine as long as it is consumed sequentially.
+struct MappedFile final {
+    /// returns nullopt if the file cannot be opened or mapped; an empty file maps to an empty span
+    static std::optional<MappedFile> open(const std::filesystem::path &path, MapAccess access = MapAccess::SEQUENTIAL);
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    [[nodiscard]] const byte *data() const noexcept { return data_; }
+    [[nodiscard]] usize size() const noexcept { return size_; }
+    [[nodiscard]] std::span<const byte> bytes() const noexcept { return {data_, size_}; }
+
+    /// Starts reading `[offset, offset + size)` in ahead of use; the range is clamped to the file.
+    void prefetch(usize offset, usize size) const noexcept;
+
+private:
+    MappedFile() = default;
+    void reset() noexcept;
+
+    const byte *data_ = nullptr;
+    usize size_ = 0;
+#if defined(_WIN32)
+    void *mapping_ = nullptr;
+#endif
+};
+
+} // namespace llc
@@ -0,0 +1,24 @@
+#include "module_registry.h"
+
+namespace llc {
+
+Slang::ComPtr<slang::IModule> find_registered_module(ModuleRegistry &registry, std::string_view key) {
+    std::scoped_lock lock(registry.mutex);
+    for (const auto &entry : registry.entries) {
+        if (entry.key == key) return entry.module;
+    }
+    return nullptr;
+}
+
+void register_module(ModuleRegistry &registry, std::string_view key, slang::IModule *module) {
+    std::scoped_lock lock(registry.mutex);
+    for (auto &entry : registry.entries) {
+        if (entry.key == key) {
+            entry.module = module;
+            return;
+        }
+    }
+    registry.entries.push_back({std::string(key), Slang::ComPtr<slang::IModule>(module)});
+}
+
+} // namespace llc
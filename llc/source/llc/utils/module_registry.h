@@ -0,0 +1,36 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <slang-com-ptr.h>
+#include <slang.h>
+
+namespace llc {
+
+struct RegisteredModule final {
+    std::string key;
+    Slang::ComPtr<slang::IModule> module;
+};
+
+/// Modules already loaded into a Context's Slang session, so building another pipeline from the
+/// same module skips all module I/O. A session keeps every module it loaded and hands the same one
+/// back for the same path, so entries are never invalidated: edited shader files take a new Context.
+struct ModuleRegistry final {
+    std::mutex mutex;
+    std::vector<RegisteredModule> entries;
+
+    void clear() noexcept {
+        std::scoped_lock lock(mutex);
+        entries.clear();
+    }
+};
+
+/// Returns the module registered under `key`, nullptr if there is none.
+Slang::ComPtr<slang::IModule> find_registered_module(ModuleRegistry &registry, std::string_view key);
+
+void register_module(ModuleRegistry &registry, std::string_view key, slang::IModule *module);
+
+} // namespace llc
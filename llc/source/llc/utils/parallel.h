@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+#include <llc/scalar_types.hpp>
+#include <llc/utils/small_vector.h>
+
+namespace llc {
+
+/// Number of hardware threads, never zero.
+inline u32 hardware_thread_count() noexcept {
+    const auto count = std::thread::hardware_concurrency();
+    return count > 0 ? count : 1u;
+}
+
+/// How many contiguous chunks `count` items should be split into, so that every chunk
+/// holds at least `min_chunk` items and at most `max_threads` (0 = all hardware threads) run.
+inline u32 parallel_chunk_count(usize count, usize min_chunk, u32 max_threads = 0) noexcept {
+    const u32 thread_limit = max_threads > 0 ? max_threads : hardware_thread_count();
+    const usize by_size = min_chunk > 0 ? count / min_chunk : count;
+    return static_cast<u32>(std::clamp<usize>(by_size, 1, thread_limit));
+}
+
+/// Runs `fn(begin, end, chunk_index)` over `chunk_count` contiguous slices of [0, count).
+/// The calling thread processes the first chunk, so a single chunk never spawns a thread.
+template <typename Fn>
+void parallel_for_chunks(usize count, u32 chunk_count, Fn &&fn) {
+    if (chunk_count <= 1) {
+        fn(usize{0}, count, u32{0});
+        return;
+    }
+
+    // the first `count % chunk_count` chunks take one extra item
+    const usize base = count / chunk_count;
+    const usize remainder = count % chunk_count;
+    const auto chunk_begin = [=](u32 index) {
+        return base * index + std::min<usize>(index, remainder);
+    };
+
+    SmallVector<std::jthread, 16> workers;
+    workers.reserve(chunk_count - 1);
+    for (u32 index = 1; index < chunk_count; ++index) {
+        workers.emplace_back([&fn, begin = chunk_begin(index), end = chunk_begin(index + 1), index] {
+            fn(begin, end, index);
+        });
+    }
+    fn(usize{0}, chunk_begin(1), u32{0});
+}
+
+} // namespace llc
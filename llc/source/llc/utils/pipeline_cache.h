@@ -1,19 +1,61 @@
 #pragma once
 
+#include <array>
+#include <memory>
 #include <mutex>
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
 #include <slang-rhi.h>
+#include <slang-rhi/shader-cursor.h>
 #include <llc/scalar_types.hpp>
+#include <llc/utils/small_vector.h>
 
 namespace llc {
 
+/// Shader parameter offsets of one pipeline, resolved by name once and reused by every dispatch,
+/// so binding does not walk reflection for each parameter of each dispatch.
+struct ShaderOffsets final {
+    /// Resolves `paths` (dotted for struct fields, e.g. "source.texture") through the root object
+    /// of the first dispatch; later calls return the cached offsets in the same order.
+    /// Returns an empty span if a path does not name a parameter.
+    template <usize N>
+    std::span<const rhi::ShaderOffset> resolve(rhi::IShaderObject *root, const std::array<const char *, N> &paths) {
+        std::call_once(resolved_, [&]() {
+            const rhi::ShaderCursor cursor(root);
+            offsets_.resize(N);
+            for (usize i = 0; i < N; ++i) {
+                const auto field = cursor.getPath(paths[i]);
+                if (!field.isValid()) return;
+                offsets_[i] = field.m_offset;
+            }
+            valid_ = true;
+        });
+        return valid_ ? std::span<const rhi::ShaderOffset>(offsets_.data(), offsets_.size())
+                      : std::span<const rhi::ShaderOffset>{};
+    }
+
+private:
+    std::once_flag resolved_;
+    SmallVector<rhi::ShaderOffset, 8> offsets_;
+    bool valid_ = false;
+};
+
 struct CachedPipeline final {
     std::string key;
     Slang::ComPtr<rhi::IComputePipeline> pipeline;
+    std::shared_ptr<ShaderOffsets> offsets;
+};
+
+/// A cached pipeline together with its parameter offsets.
+struct PipelineHandle final {
+    Slang::ComPtr<rhi::IComputePipeline> pipeline;
+    std::shared_ptr<ShaderOffsets> offsets;
+
+    explicit operator bool() const noexcept { return pipeline != nullptr; }
 };
 
 struct PipelineCache final {
@@ -29,27 +71,32 @@ struct PipelineCache final {
 /// Thread-safe pipeline lookup with f64-checked locking.
 /// `create_fn()` is called outside the lock if no cache hit.
 template <typename CreateFn>
-Slang::ComPtr<rhi::IComputePipeline> get_cached_pipeline(PipelineCache &cache, std::string_view key, CreateFn create_fn) {
+PipelineHandle get_cached_pipeline_handle(PipelineCache &cache, std::string_view key, CreateFn create_fn) {
     {
         std::scoped_lock lock(cache.mutex);
         for (const auto &cached : cache.entries) {
             if (cached.key == key) {
-                return cached.pipeline;
+                return {cached.pipeline, cached.offsets};
             }
         }
     }
 
     auto pipeline = create_fn();
-    if (!pipeline) return nullptr;
+    if (!pipeline) return {};
 
     std::scoped_lock lock(cache.mutex);
     for (const auto &cached : cache.entries) {
         if (cached.key == key) {
-            return cached.pipeline;
+            return {cached.pipeline, cached.offsets};
         }
     }
-    cache.entries.push_back({std::string(key), pipeline});
-    return pipeline;
+    cache.entries.push_back({std::string(key), pipeline, std::make_shared<ShaderOffsets>()});
+    return {cache.entries.back().pipeline, cache.entries.back().offsets};
+}
+
+template <typename CreateFn>
+Slang::ComPtr<rhi::IComputePipeline> get_cached_pipeline(PipelineCache &cache, std::string_view key, CreateFn create_fn) {
+    return get_cached_pipeline_handle(cache, key, std::move(create_fn)).pipeline;
 }
 
 } // namespace llc
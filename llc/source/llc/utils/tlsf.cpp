@@ -0,0 +1,215 @@
+#include "tlsf.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace llc {
+
+namespace {
+
+struct BinIndex final {
+    u32 fl;
+    u32 sl;
+};
+
+/// First level is the power of two of `units`, second level splits it linearly;
+/// sizes below the second level count share first level 0.
+template <u32 SlLog2>
+BinIndex bin_of(u64 units) noexcept {
+    constexpr u64 k_sl_count = u64{1} << SlLog2;
+    if (units < k_sl_count) return {0, static_cast<u32>(units)};
+    const u32 msb = static_cast<u32>(std::bit_width(units)) - 1;
+    return {
+        msb - SlLog2 + 1,
+        static_cast<u32>((units >> (msb - SlLog2)) ^ k_sl_count),
+    };
+}
+
+} // namespace
+
+TlsfAllocator::TlsfAllocator(u64 granularity) : granularity_(std::max<u64>(std::bit_ceil(granularity), 1)) {
+    for (auto &heads : free_heads_) heads.fill(k_null);
+}
+
+u32 TlsfAllocator::new_node() {
+    if (!unused_nodes_.empty()) {
+        const u32 node = unused_nodes_.back();
+        unused_nodes_.pop_back();
+        nodes_[node] = Node{.live = true};
+        return node;
+    }
+    nodes_.push_back(Node{.live = true});
+    return static_cast<u32>(nodes_.size() - 1);
+}
+
+void TlsfAllocator::release_node(u32 node) {
+    nodes_[node].live = false;
+    unused_nodes_.push_back(node);
+}
+
+void TlsfAllocator::insert_free(u32 node) {
+    auto &current = nodes_[node];
+    const auto [fl, sl] = bin_of<k_sl_log2>(current.size / granularity_);
+    current.free = true;
+    current.prev_free = k_null;
+    current.next_free = free_heads_[fl][sl];
+    if (current.next_free != k_null) nodes_[current.next_free].prev_free = node;
+    free_heads_[fl][sl] = node;
+    fl_bitmap_ |= u64{1} << fl;
+    sl_bitmaps_[fl] |= 1u << sl;
+}
+
+void TlsfAllocator::remove_free(u32 node) {
+    auto &current = nodes_[node];
+    const auto [fl, sl] = bin_of<k_sl_log2>(current.size / granularity_);
+    if (current.prev_free != k_null) nodes_[current.prev_free].next_free = current.next_free;
+    if (current.next_free != k_null) nodes_[current.next_free].prev_free = current.prev_free;
+    if (free_heads_[fl][sl] == node) {
+        free_heads_[fl][sl] = current.next_free;
+        if (current.next_free == k_null) {
+            sl_bitmaps_[fl] &= ~(1u << sl);
+            if (sl_bitmaps_[fl] == 0) fl_bitmap_ &= ~(u64{1} << fl);
+        }
+    }
+    current.free = false;
+    current.prev_free = k_null;
+    current.next_free = k_null;
+}
+
+void TlsfAllocator::split(u32 node, u64 size) {
+    const u32 rest = new_node();
+    auto &current = nodes_[node];
+    auto &remainder = nodes_[rest];
+    remainder.offset = current.offset + size;
+    remainder.size = current.size - size;
+    remainder.region = current.region;
+    remainder.prev_phys = node;
+    remainder.next_phys = current.next_phys;
+    if (current.next_phys != k_null) nodes_[current.next_phys].prev_phys = rest;
+    current.next_phys = rest;
+    current.size = size;
+    insert_free(rest);
+}
+
+u32 TlsfAllocator::merge(u32 node) {
+    // absorbs `next` into `first`, both physically adjacent
+    const auto absorb = [this](u32 first, u32 next) {
+        auto &head = nodes_[first];
+        const auto &tail = nodes_[next];
+        head.size += tail.size;
+        head.next_phys = tail.next_phys;
+        if (tail.next_phys != k_null) nodes_[tail.next_phys].prev_phys = first;
+        release_node(next);
+    };
+
+    const u32 prev = nodes_[node].prev_phys;
+    if (prev != k_null && nodes_[prev].free) {
+        remove_free(prev);
+        absorb(prev, node);
+        node = prev;
+    }
+    const u32 next = nodes_[node].next_phys;
+    if (next != k_null && nodes_[next].free) {
+        remove_free(next);
+        absorb(node, next);
+    }
+    return node;
+}
+
+u32 TlsfAllocator::find_free(u64 size) const noexcept {
+    // round the request up to the next bin boundary, so any range in the bin found is large enough
+    u64 units = size / granularity_;
+    if (units >= k_sl_count) {
+        const u32 msb = static_cast<u32>(std::bit_width(units)) - 1;
+        const u64 round = (u64{1} << (msb - k_sl_log2)) - 1;
+        if (units > ~u64{0} - round) return k_null;
+        units += round;
+    }
+
+    auto [fl, sl] = bin_of<k_sl_log2>(units);
+    if (fl >= k_fl_count) return k_null;
+
+    u32 sl_map = sl < k_sl_count ? sl_bitmaps_[fl] & (~0u << sl) : 0;
+    if (sl_map == 0) {
+        const u64 fl_map = fl + 1 < 64 ? fl_bitmap_ & (~u64{0} << (fl + 1)) : 0;
+        if (fl_map == 0) return k_null;
+        fl = static_cast<u32>(std::countr_zero(fl_map));
+        sl_map = sl_bitmaps_[fl];
+    }
+    sl = static_cast<u32>(std::countr_zero(sl_map));
+    return free_heads_[fl][sl];
+}
+
+u32 TlsfAllocator::add_region(u64 size) {
+    const u32 region = static_cast<u32>(region_sizes_.size());
+    const u64 usable = size / granularity_ * granularity_;
+    region_sizes_.push_back(usable);
+    if (usable == 0) return region;
+
+    const u32 node = new_node();
+    nodes_[node].size = usable;
+    nodes_[node].region = region;
+    insert_free(node);
+    return region;
+}
+
+std::optional<TlsfAllocation> TlsfAllocator::allocate(u64 size, u64 alignment) {
+    const u64 align = std::max(alignment, granularity_);
+    assert(std::has_single_bit(align));
+
+    const u64 unit_count = std::max<u64>((size + granularity_ - 1) / granularity_, 1);
+    const u64 byte_size = unit_count * granularity_;
+    // ranges start at a multiple of the granularity, so at most `align - granularity` is skipped
+    const u32 found = find_free(byte_size + (align - granularity_));
+    if (found == k_null) return std::nullopt;
+
+    u32 node = found;
+    remove_free(node);
+
+    const u64 offset = nodes_[node].offset;
+    const u64 padding = ((offset + align - 1) & ~(align - 1)) - offset;
+    if (padding > 0) {
+        // the padding stays behind as a free range of its own
+        split(node, padding);
+        const u32 aligned = nodes_[node].next_phys;
+        remove_free(aligned);
+        insert_free(node);
+        node = aligned;
+    }
+    if (nodes_[node].size > byte_size) split(node, byte_size);
+
+    used_bytes_ += byte_size;
+    ++allocation_count_;
+    const auto &allocated = nodes_[node];
+    return TlsfAllocation{
+        .region = allocated.region,
+        .node = node,
+        .offset = allocated.offset,
+        .size = allocated.size,
+    };
+}
+
+void TlsfAllocator::free(u32 node) {
+    if (node >= nodes_.size() || !nodes_[node].live || nodes_[node].free) return;
+
+    used_bytes_ -= nodes_[node].size;
+    --allocation_count_;
+    insert_free(merge(node));
+}
+
+TlsfStats TlsfAllocator::stats() const noexcept {
+    TlsfStats stats{
+        .used_bytes = used_bytes_,
+        .allocation_count = allocation_count_,
+    };
+    for (const u64 size : region_sizes_) stats.capacity += size;
+    for (const auto &node : nodes_) {
+        if (!node.live || !node.free) continue;
+        ++stats.free_range_count;
+        stats.largest_free_range = std::max(stats.largest_free_range, node.size);
+    }
+    return stats;
+}
+
+} // namespace llc
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <optional>
+#include <vector>
+
+#include <llc/scalar_types.hpp>
+
+namespace llc {
+
+/// A range handed out by `TlsfAllocator`; `node` identifies it for `free`.
+struct TlsfAllocation final {
+    u32 region = 0;
+    u32 node = 0;
+    u64 offset = 0;
+    u64 size = 0;
+};
+
+struct TlsfStats final {
+    u64 capacity = 0;
+    u64 used_bytes = 0;
+    u64 largest_free_range = 0;
+    u32 allocation_count = 0;
+    u32 free_range_count = 0;
+
+    [[nodiscard]] u64 free_bytes() const noexcept { return capacity - used_bytes; }
+    /// used / capacity, 0 when nothing is reserved
+    [[nodiscard]] f64 utilization() const noexcept {
+        return capacity == 0 ? 0.0 : static_cast<f64>(used_bytes) / static_cast<f64>(capacity);
+    }
+    /// 1 - largest free range / free bytes: 0 when all free space is one range
+    [[nodiscard]] f64 fragmentation() const noexcept {
+        const u64 free = free_bytes();
+        return free == 0 ? 0.0 : 1.0 - static_cast<f64>(largest_free_range) / static_cast<f64>(free);
+    }
+};
+
+/// Two-level segregated fit allocator over abstract address ranges ("regions"), O(1) allocate
+/// and free. It never touches the memory it manages, so it can carve device buffers as well.
+///
+/// Offsets and sizes are multiples of `granularity`; neighbouring free ranges of a region are
+/// merged on free.
+struct TlsfAllocator final {
+    explicit TlsfAllocator(u64 granularity = 16);
+
+    /// Adds a region of `size` bytes (rounded down to the granularity); returns its index.
+    u32 add_region(u64 size);
+
+    /// Returns nullopt if no free range of any region can hold `size` bytes at `alignment`.
+    /// `alignment` must be a power of two; smaller than the granularity means the granularity.
+    std::optional<TlsfAllocation> allocate(u64 size, u64 alignment = 0);
+
+    /// Returns the range to the free lists. Each allocation must be freed once, its node is reused.
+    void free(u32 node);
+
+    [[nodiscard]] TlsfStats stats() const noexcept;
+    [[nodiscard]] u64 granularity() const noexcept { return granularity_; }
+    [[nodiscard]] u32 region_count() const noexcept { return static_cast<u32>(region_sizes_.size()); }
+
+private:
+    static constexpr u32 k_sl_log2 = 4;
+    static constexpr u32 k_sl_count = 1u << k_sl_log2;
+    static constexpr u32 k_fl_count = 64 - k_sl_log2 + 1;
+    static constexpr u32 k_null = ~0u;
+
+    struct Node final {
+        u64 offset = 0;
+        u64 size = 0;
+        u32 region = 0;
+        /// physical neighbours within the region
+        u32 prev_phys = k_null;
+        u32 next_phys = k_null;
+        /// free list links, only meaningful while free
+        u32 prev_free = k_null;
+        u32 next_free = k_null;
+        bool free = false;
+        bool live = false;
+    };
+
+    u32 new_node();
+    void release_node(u32 node);
+    void insert_free(u32 node);
+    void remove_free(u32 node);
+    /// splits `node` so that it keeps its first `size` bytes, the rest becomes a free node
+    void split(u32 node, u64 size);
+    u32 merge(u32 node);
+    u32 find_free(u64 size) const noexcept;
+
+    u64 granularity_;
+    std::vector<Node> nodes_;
+    std::vector<u32> unused_nodes_;
+    std::vector<u64> region_sizes_;
+    u64 fl_bitmap_ = 0;
+    std::array<u32, k_fl_count> sl_bitmaps_{};
+    std::array<std::array<u32, k_sl_count>, k_fl_count> free_heads_;
+    u64 used_bytes_ = 0;
+    u32 allocation_count_ = 0;
+};
+
+} // namespace llc
@@ -0,0 +1,135 @@
+#include "view_cache.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include <llc/memory_tracker.h>
+
+namespace llc {
+
+namespace {
+
+bool same_sampler(const rhi::SamplerDesc &a, const rhi::SamplerDesc &b) noexcept {
+    return a.minFilter == b.minFilter && a.magFilter == b.magFilter && a.mipFilter == b.mipFilter &&
+           a.reductionOp == b.reductionOp && a.addressU == b.addressU && a.addressV == b.addressV &&
+           a.addressW == b.addressW && a.mipLODBias == b.mipLODBias && a.maxAnisotropy == b.maxAnisotropy &&
+           a.comparisonFunc == b.comparisonFunc && std::ranges::equal(a.borderColor, b.borderColor) &&
+           a.minLOD == b.minLOD && a.maxLOD == b.maxLOD;
+}
+
+} // namespace
+
+Slang::ComPtr<rhi::ITextureView> ViewCache::texture_view(
+    Context &context,
+    rhi::ITexture *texture,
+    const TextureViewRange &range) {
+
+    std::scoped_lock lock(mutex_);
+    if (++lookups_since_collect_ >= k_collect_interval) collect_slice_locked();
+
+    auto [it, inserted] = textures_.try_emplace(texture);
+    auto &entry = it->second;
+    if (inserted) {
+        entry.texture = Slang::ComPtr<rhi::ITexture>(texture);
+        tracker_->hold(texture);
+    } else {
+        for (const auto &[cached_range, view] : entry.views) {
+            if (cached_range == range) return view;
+        }
+    }
+
+    auto view = create_texture_view(context, texture, range);
+    if (!view) {
+        if (entry.views.empty()) {
+            tracker_->unhold(texture);
+            textures_.erase(it);
+        }
+        return nullptr;
+    }
+    entry.views.emplace_back(range, view);
+    // a miss is when views of released textures would otherwise pile up
+    collect_slice_locked();
+    return view;
+}
+
+Slang::ComPtr<rhi::ISampler> ViewCache::sampler(Context &context, const rhi::SamplerDesc &desc) {
+    std::scoped_lock lock(mutex_);
+    for (const auto &[cached_desc, sampler] : samplers_) {
+        if (same_sampler(cached_desc, desc)) return sampler;
+    }
+
+    Slang::ComPtr<rhi::ISampler> sampler;
+    if (SLANG_FAILED(context.device()->createSampler(desc, sampler.writeRef()))) return nullptr;
+    auto &cached = samplers_.emplace_back(desc, sampler);
+    cached.first.label = nullptr;
+    return sampler;
+}
+
+void ViewCache::release(rhi::ITexture *texture) {
+    std::scoped_lock lock(mutex_);
+    const auto it = textures_.find(texture);
+    if (it == textures_.end()) return;
+    tracker_->unhold(texture);
+    textures_.erase(it);
+}
+
+void ViewCache::collect() {
+    std::scoped_lock lock(mutex_);
+    collect_locked();
+}
+
+void ViewCache::release_if_unused_locked(rhi::ITexture *texture) {
+    if (!tracker_->unused(texture)) return;
+    tracker_->unhold(texture);
+    textures_.erase(texture);
+}
+
+void ViewCache::collect_locked() {
+    lookups_since_collect_ = 0;
+    for (auto it = textures_.begin(); it != textures_.end();) {
+        const auto next = std::next(it);
+        release_if_unused_locked(it->first);
+        it = next;
+    }
+}
+
+void ViewCache::collect_slice_locked() {
+    lookups_since_collect_ = 0;
+    const usize bucket_count = textures_.bucket_count();
+    for (usize checked = 0; checked < k_collect_slice && !textures_.empty(); ++checked) {
+        if (collect_bucket_ >= bucket_count) collect_bucket_ = 0;
+        // erasing an entry leaves the iterators to the others valid
+        for (auto it = textures_.begin(collect_bucket_); it != textures_.end(collect_bucket_);) {
+            const auto current = it++;
+            release_if_unused_locked(current->first);
+        }
+        ++collect_bucket_;
+    }
+}
+
+void ViewCache::clear() {
+    std::scoped_lock lock(mutex_);
+    for (const auto &[texture, entry] : textures_) tracker_->unhold(texture);
+    textures_.clear();
+    samplers_.clear();
+    lookups_since_collect_ = 0;
+}
+
+usize ViewCache::cached_texture_count() const {
+    std::scoped_lock lock(mutex_);
+    return textures_.size();
+}
+
+usize ViewCache::cached_view_count() const {
+    std::scoped_lock lock(mutex_);
+    usize count = 0;
+    for (const auto &[texture, entry] : textures_) count += entry.views.size();
+    return count;
+}
+
+usize ViewCache::cached_sampler_count() const {
+    std::scoped_lock lock(mutex_);
+    return samplers_.size();
+}
+
+} // namespace llc
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <slang-com-ptr.h>
+#include <slang-rhi.h>
+
+#include <llc/context.h>
+#include <llc/texture.h>
+#include <llc/types.hpp>
+
+namespace llc {
+
+/// Texture views keyed by texture and `TextureViewRange`, and samplers keyed by description,
+/// owned by the context so that dispatches in a loop create neither.
+///
+/// Views keep their texture alive. slang-rhi has no destruction callbacks, so the cache drops the
+/// views of a texture once only it, the memory tracker and the other caches reference it (see
+/// `MemoryTracker::hold`). Every miss and every `k_collect_interval` lookups check the entries in
+/// the next `k_collect_slice` buckets, `collect` checks all of them. Samplers live as long as the
+/// context.
+struct ViewCache final {
+    static constexpr u32 k_collect_interval = 256;
+    static constexpr usize k_collect_slice = 32;
+
+    /// `tracker` accounts the references the cache holds, it must outlive the cache.
+    explicit ViewCache(MemoryTracker &tracker) noexcept : tracker_(&tracker) {}
+
+    /// `create_texture_view(context, texture, range)`, created on the first request only.
+    Slang::ComPtr<rhi::ITextureView> texture_view(
+        Context &context,
+        rhi::ITexture *texture,
+        const TextureViewRange &range = {});
+    /// `device->createSampler(desc)`, created on the first request only; `desc.label` is ignored.
+    Slang::ComPtr<rhi::ISampler> sampler(Context &context, const rhi::SamplerDesc &desc = {});
+
+    /// Drops the views of `texture` right away.
+    void release(rhi::ITexture *texture);
+    /// Drops the views of every texture the cache alone keeps alive.
+    void collect();
+    void clear();
+
+    [[nodiscard]] usize cached_texture_count() const;
+    [[nodiscard]] usize cached_view_count() const;
+    [[nodiscard]] usize cached_sampler_count() const;
+
+private:
+    struct TextureViews final {
+        /// the one reference to the texture the entry reports to the tracker; views keep theirs
+        /// internally, where reference counts do not see it
+        Slang::ComPtr<rhi::ITexture> texture;
+        std::vector<std::pair<TextureViewRange, Slang::ComPtr<rhi::ITextureView>>> views;
+    };
+
+    /// Drops the entry of `texture` if it is `MemoryTracker::unused`.
+    void release_if_unused_locked(rhi::ITexture *texture);
+    void collect_locked();
+    void collect_slice_locked();
+
+    MemoryTracker *tracker_;
+    mutable std::mutex mutex_;
+    std::unordered_map<rhi::ITexture *, TextureViews> textures_;
+    std::vector<std::pair<rhi::SamplerDesc, Slang::ComPtr<rhi::ISampler>>> samplers_;
+    u32 lookups_since_collect_ = 0;
+    /// next bucket of `textures_` `collect_slice_locked` checks
+    usize collect_bucket_ = 0;
+};
+
+/// `create_texture_view` through the context's `ViewCache`.
+inline Slang::ComPtr<rhi::ITextureView> cached_texture_view(
+    Context &context,
+    rhi::ITexture *texture,
+    const TextureViewRange &range = {}) {
+    return view_cache(context).texture_view(context, texture, range);
+}
+
+inline Slang::ComPtr<rhi::ITextureView> cached_texture_view(
+    Context &context,
+    rhi::ITexture *texture,
+    u32 mip_level,
+    u32 array_layer = 0) {
+    return cached_texture_view(
+        context,
+        texture,
+        TextureViewRange{
+            .base_layer = array_layer,
+            .layer_count = 1,
+            .base_mip = mip_level,
+            .mip_count = 1,
+        });
+}
+
+/// A sampler of `desc` through the context's `ViewCache`.
+inline Slang::ComPtr<rhi::ISampler> cached_sampler(Context &context, const rhi::SamplerDesc &desc = {}) {
+    return view_cache(context).sampler(context, desc);
+}
+
+} // namespace llc
@@ -10,3 +10,7 @@ target("llc")
     add_packages("mdspan", {public = true})
     add_packages("glm", {public = true})
     add_rules("slang", {include_dirs = {"shader"}})
+    if has_config("avx2") and is_arch("x86_64", "x64") then
+        add_vectorexts("avx2")
+        add_cxflags("-mf16c", {tools = {"clang", "gcc"}})
+    end
@@ -1,9 +1,15 @@
+#include <llc/context_group.h>
+#include <llc/kernel.h>
+#include <llc/mirrored_buffer.h>
 #include <llc/utils/functional.h>
+#include <llc/utils/tlsf.h>
 
+#include <cmath>
 #include <memory>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace {
 
@@ -137,6 +143,258 @@ void test_const_and_bound_function_moves() {
     require(const_bound_destination() == 23, "const bound Function target was corrupted by move");
 }
 
+void test_dispatch_group_count() {
+    llc::Kernel kernel;
+    kernel.thread_group_size_ = {64, 4, 1};
+    require(kernel.group_count({1000, 9, 3}) == llc::u32x3(16, 3, 3), "group count does not round up per dimension");
+    require(kernel.group_count({64, 4, 1}) == llc::u32x3(1, 1, 1), "exact multiples take an extra group");
+    // rounding up in u32 would wrap to zero groups
+    require(kernel.group_count({0xFFFFFFFFu, 1, 1}).x == 1u << 26, "group count wraps near 2^32 threads");
+
+    kernel.max_group_count_ = {16, 2, 1};
+    require(kernel.fits_dispatch_limits({16, 2, 1}), "group count at the device limit does not fit");
+    require(!kernel.fits_dispatch_limits({17, 1, 1}), "group count above the device limit fits");
+}
+
+void test_split_dispatch_covers_every_thread_once() {
+    llc::Kernel kernel;
+    kernel.thread_group_size_ = {64, 1, 1};
+    kernel.max_group_count_ = {10, 2, 65535};
+
+    // 26 x 3 groups, split into x chunks of 10, 10 and 6 groups and y chunks of 2 and 1
+    const llc::u32x3 threads{64 * 25 + 5, 3, 1};
+    std::vector<int> covered(threads.x * threads.y, 0);
+    int chunk_count = 0;
+    const auto result = kernel.for_each_dispatch_chunk(
+        threads,
+        [&](const llc::DispatchRegion &region, const llc::u32x3 &group_count) {
+            ++chunk_count;
+            require(kernel.fits_dispatch_limits(group_count), "split dispatch exceeds the device limit");
+            for (llc::u32 i = 0; i < 3; ++i) {
+                require(region.thread_count[i] <= group_count[i] * kernel.thread_group_size_[i],
+                        "region covers more threads than its groups launch");
+            }
+            for (llc::u32 y = 0; y < region.thread_count.y; ++y) {
+                for (llc::u32 x = 0; x < region.thread_count.x; ++x) {
+                    ++covered[(region.thread_offset.y + y) * threads.x + region.thread_offset.x + x];
+                }
+            }
+            return SLANG_OK;
+        });
+    require(SLANG_SUCCEEDED(result), "splitting a dispatch failed");
+    require(chunk_count == 6, "oversized dispatch was not split into the expected chunks");
+    for (const int count : covered) require(count == 1, "split dispatch does not cover every thread exactly once");
+
+    // the first failing chunk ends the walk
+    chunk_count = 0;
+    const auto failed = kernel.for_each_dispatch_chunk(threads, [&](const llc::DispatchRegion &, const llc::u32x3 &) {
+        return ++chunk_count == 2 ? SLANG_FAIL : SLANG_OK;
+    });
+    require(failed == SLANG_FAIL && chunk_count == 2, "split dispatch continued after a failing chunk");
+
+    chunk_count = 0;
+    (void) kernel.for_each_dispatch_chunk({0, 1, 1}, [&](const llc::DispatchRegion &, const llc::u32x3 &) {
+        ++chunk_count;
+        return SLANG_OK;
+    });
+    require(chunk_count == 0, "empty dispatch produced a chunk");
+}
+
+void test_dirty_ranges_merge_on_add() {
+    llc::DirtyRanges dirty;
+    dirty.add({40, 50});
+    dirty.add({0, 10});
+    dirty.add({20, 30});
+    dirty.add({5, 5}); // empty ranges are ignored
+    require(dirty.ranges().size() == 3 && dirty.ranges().front() == llc::ByteRange{0, 10}, "ranges are not kept sorted");
+
+    dirty.add({10, 20}); // touches both neighbours
+    require(dirty.ranges().size() == 2 && dirty.ranges().front() == llc::ByteRange{0, 30}, "touching ranges were not merged");
+    dirty.add({25, 45}); // overlaps both
+    require(dirty.ranges().size() == 1 && dirty.ranges().front() == llc::ByteRange{0, 50}, "overlapping ranges were not merged");
+    dirty.add({60, 70});
+    require(dirty.byte_count() == 60, "byte count is not the sum of the ranges");
+}
+
+void test_upload_ranges_coalesce_within_merge_gap() {
+    llc::DirtyRanges dirty;
+    dirty.add({0, 16});
+    dirty.add({100, 116}); // 84 bytes after the first
+    dirty.add({400, 416}); // 284 bytes after the second
+    const llc::MirrorOptions options{.merge_gap = 256, .full_upload_ratio = 1.0f};
+
+    const auto uploads = llc::upload_ranges(dirty, 4096, options);
+    require(uploads.size() == 2, "ranges within the merge gap were not coalesced");
+    require(uploads[0] == llc::ByteRange{0, 116} && uploads[1] == llc::ByteRange{400, 416}, "coalesced upload has the wrong bounds");
+
+    const auto separate = llc::upload_ranges(dirty, 4096, {.merge_gap = 0, .full_upload_ratio = 1.0f});
+    require(separate.size() == 3, "a merge gap of 0 still coalesced ranges");
+    require(llc::upload_ranges(llc::DirtyRanges{}, 4096, options).empty(), "nothing dirty produced an upload");
+}
+
+void test_upload_ranges_whole_buffer_past_ratio() {
+    llc::DirtyRanges dirty;
+    dirty.add({0, 100});
+    dirty.add({500, 600});
+    const llc::MirrorOptions options{.merge_gap = 0, .full_upload_ratio = 0.25f};
+
+    require(llc::upload_ranges(dirty, 1000, options).size() == 2, "uploaded the whole buffer below the ratio");
+    dirty.add({800, 850});
+    const auto uploads = llc::upload_ranges(dirty, 1000, options);
+    require(uploads.size() == 1 && uploads[0] == llc::ByteRange{0, 1000}, "did not upload the whole buffer at the ratio");
+}
+
+bool covers(const llc::SmallVector<llc::IndexRange, 8> &ranges, llc::usize count) {
+    llc::usize begin = 0;
+    for (const auto &range : ranges) {
+        if (range.begin != begin || range.end < range.begin) return false;
+        begin = range.end;
+    }
+    return begin == count;
+}
+
+void test_partition_splits_equally_until_measured() {
+    const std::vector<llc::f64> unmeasured(3, 0.0);
+    const auto ranges = llc::partition(10, unmeasured);
+    require(ranges.size() == 3 && covers(ranges, 10), "partition does not cover the range in order");
+    require(ranges[0].size() == 3 && ranges[1].size() == 3 && ranges[2].size() == 4, "unmeasured parts are not equal");
+
+    // one missing measurement keeps the split equal
+    const std::vector<llc::f64> partial = {0.0, 3.0};
+    const auto equal = llc::partition(100, partial);
+    require(equal[0].size() == 50 && equal[1].size() == 50, "partially measured rates weighted the split");
+    require(llc::partition(0, unmeasured).size() == 3 && covers(llc::partition(0, unmeasured), 0), "empty count gave non-empty ranges");
+}
+
+void test_partition_weights_by_rate() {
+    const std::vector<llc::f64> rates = {1.0, 3.0};
+    const auto ranges = llc::partition(100, rates);
+    require(covers(ranges, 100) && ranges[0] == llc::IndexRange{0, 25}, "split is not proportional to the rates");
+
+    const std::vector<llc::f64> skewed = {2.0, 1.0, 1.0};
+    const auto three = llc::partition(1000, skewed);
+    require(covers(three, 1000) && three[0].size() == 500 && three[1].size() == 250, "split of three parts is not proportional");
+}
+
+void test_partition_rounds_to_alignment() {
+    const std::vector<llc::f64> unmeasured(3, 0.0);
+    const auto ranges = llc::partition(100, unmeasured, 16);
+    require(covers(ranges, 100), "aligned partition does not cover the range");
+    require(ranges[0].end == 32 && ranges[1].end == 64, "boundaries are not rounded down to the alignment");
+
+    // shares smaller than the alignment round to nothing, the last part takes the rest
+    const auto small = llc::partition(10, unmeasured, 8);
+    require(covers(small, 10) && small[0].empty() && small[1].empty() && small[2].size() == 10, "small shares were not left empty");
+    require(llc::partition(10, unmeasured, 0)[2].size() == 4, "an alignment of 0 is not treated as 1");
+}
+
+bool near(llc::f64 a, llc::f64 b) { return std::abs(a - b) <= 1e-9; }
+
+void test_tlsf_allocate_and_free() {
+    llc::TlsfAllocator tlsf(16);
+    tlsf.add_region(1024);
+
+    const auto small = tlsf.allocate(1);
+    require(small && small->region == 0 && small->offset == 0 && small->size == 16, "allocation is not rounded to the granularity");
+    const auto odd = tlsf.allocate(100);
+    require(odd && odd->offset == 16 && odd->size == 112, "allocation does not follow the previous one");
+
+    auto stats = tlsf.stats();
+    require(stats.capacity == 1024 && stats.used_bytes == 128 && stats.allocation_count == 2, "stats miss allocations");
+    require(near(stats.utilization(), 128.0 / 1024.0), "utilization is not used over capacity");
+
+    tlsf.free(small->node);
+    tlsf.free(odd->node);
+    tlsf.free(odd->node); // a second free of the same node is ignored
+    stats = tlsf.stats();
+    require(stats.used_bytes == 0 && stats.allocation_count == 0, "freed allocations are still accounted");
+    require(stats.free_range_count == 1 && stats.largest_free_range == 1024, "freed ranges were not merged back");
+    require(near(stats.fragmentation(), 0.0), "a single free range is reported as fragmented");
+    require(!tlsf.allocate(1025), "allocation larger than the region succeeded");
+}
+
+void test_tlsf_coalesces_neighbours() {
+    llc::TlsfAllocator tlsf(16);
+    tlsf.add_region(1024);
+    const auto a = tlsf.allocate(256);
+    const auto b = tlsf.allocate(256);
+    const auto c = tlsf.allocate(256);
+    require(a && b && c && a->offset == 0 && b->offset == 256 && c->offset == 512, "allocations are not packed");
+
+    // [0, 256) and [512, 1024) are free, the latter merged with the untouched tail
+    tlsf.free(a->node);
+    tlsf.free(c->node);
+    auto stats = tlsf.stats();
+    require(stats.free_range_count == 2 && stats.largest_free_range == 512, "free range was not merged with its successor");
+    require(near(stats.fragmentation(), 1.0 - 512.0 / 768.0), "fragmentation is not 1 - largest free / free");
+    require(!tlsf.allocate(768), "allocation spanning a live range succeeded");
+
+    // freeing the middle merges with both neighbours
+    tlsf.free(b->node);
+    stats = tlsf.stats();
+    require(stats.free_range_count == 1 && stats.largest_free_range == 1024, "free range was not merged with both neighbours");
+    const auto whole = tlsf.allocate(1024);
+    require(whole && whole->offset == 0, "merged region cannot be allocated whole");
+}
+
+void test_tlsf_alignment_padding_is_reused() {
+    llc::TlsfAllocator tlsf(16);
+    tlsf.add_region(4096);
+    const auto first = tlsf.allocate(16);
+    const auto aligned = tlsf.allocate(64, 256);
+    require(first && aligned && aligned->offset == 256 && aligned->size == 64, "allocation is not aligned");
+    require(tlsf.stats().used_bytes == 80, "alignment padding is accounted as used");
+
+    // the padding [16, 256) stays free and takes the next request that fits
+    require(tlsf.stats().free_range_count == 2, "alignment padding was not kept as a free range");
+    const auto padded = tlsf.allocate(200);
+    require(padded && padded->offset == 16, "alignment padding is not reused");
+    const auto page = tlsf.allocate(64, 1024);
+    require(page && page->offset == 1024, "allocation does not honour a large alignment");
+}
+
+void test_tlsf_reuses_freed_ranges() {
+    llc::TlsfAllocator tlsf(16);
+    tlsf.add_region(1 << 20);
+    std::vector<llc::TlsfAllocation> allocations;
+    for (int i = 0; i < 1000; ++i) allocations.push_back(*tlsf.allocate(48));
+    const auto high_water = tlsf.stats();
+
+    // freeing every other range and allocating the same sizes again fills the holes
+    for (llc::usize i = 0; i < allocations.size(); i += 2) tlsf.free(allocations[i].node);
+    for (llc::usize i = 0; i < allocations.size(); i += 2) {
+        const auto again = tlsf.allocate(48);
+        require(again && again->offset < high_water.used_bytes, "freed range was not reused");
+        allocations[i] = *again;
+    }
+    const auto stats = tlsf.stats();
+    require(stats.used_bytes == high_water.used_bytes && stats.free_range_count == high_water.free_range_count,
+            "reallocating freed ranges grew the allocator");
+    for (const auto &allocation : allocations) tlsf.free(allocation.node);
+    require(tlsf.stats().free_range_count == 1 && tlsf.stats().used_bytes == 0, "ranges were not merged after freeing all");
+}
+
+void test_tlsf_grows_into_another_region() {
+    // SpanAllocator adds a block as a region when an allocation fails, the same steps as here
+    llc::TlsfAllocator tlsf(16);
+    tlsf.add_region(256);
+    const auto full = tlsf.allocate(256);
+    require(full && !tlsf.allocate(16), "full region still accepted an allocation");
+
+    require(tlsf.add_region(1024) == 1 && tlsf.region_count() == 2, "second region has the wrong index");
+    const auto grown = tlsf.allocate(16);
+    require(grown && grown->region == 1 && grown->offset == 0, "allocation did not go to the new region");
+
+    // regions never merge, even after everything is freed
+    tlsf.free(full->node);
+    tlsf.free(grown->node);
+    const auto stats = tlsf.stats();
+    require(stats.capacity == 1280 && stats.free_range_count == 2 && stats.largest_free_range == 1024,
+            "regions were merged");
+    require(near(stats.fragmentation(), 1.0 - 1024.0 / 1280.0) && near(stats.utilization(), 0.0), "stats over regions are wrong");
+    require(!tlsf.allocate(1280), "allocation spanning two regions succeeded");
+}
+
 } // namespace
 
 int main() {
@@ -144,5 +402,18 @@ int main() {
     test_nontrivial_target_uses_stable_storage();
     test_throwing_move_target_uses_stable_storage();
     test_const_and_bound_function_moves();
+    test_dispatch_group_count();
+    test_split_dispatch_covers_every_thread_once();
+    test_dirty_ranges_merge_on_add();
+    test_upload_ranges_coalesce_within_merge_gap();
+    test_upload_ranges_whole_buffer_past_ratio();
+    test_partition_splits_equally_until_measured();
+    test_partition_weights_by_rate();
+    test_partition_rounds_to_alignment();
+    test_tlsf_allocate_and_free();
+    test_tlsf_coalesces_neighbours();
+    test_tlsf_alignment_padding_is_reused();
+    test_tlsf_reuses_freed_ranges();
+    test_tlsf_grows_into_another_region();
     return 0;
 }
@@ -3,4 +3,5 @@ target("test-functional")
     set_group("test")
     add_files("main.cpp")
     add_deps("llc")
+    add_packages("slang-rhi")
     add_tests("default")
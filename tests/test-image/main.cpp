@@ -1,7 +1,14 @@
 #include <llc/image.h>
 
+#include <algorithm>
+#include <bit>
+#include <cmath>
 #include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <limits>
 #include <stdexcept>
+#include <string_view>
 
 namespace {
 
@@ -54,10 +61,201 @@ void test_linear_to_srgb_rgba8() {
     require(channel(converted, 0, 0, 3) == 93, "alpha was gamma converted");
 }
 
+/// The scalar formulas `convert_image` must reproduce bit for bit.
+float reference_srgb_to_linear(float value) {
+    if (value <= 0.04045f) return value / 12.92f;
+    return std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+llc::u8 reference_float_to_unorm8(float value) {
+    value = std::isfinite(value) ? std::clamp(value, 0.0f, 1.0f) : 0.0f;
+    return static_cast<llc::u8>(value * 255.0f + 0.5f);
+}
+
+llc::u8 reference_linear_to_srgb8(float value) {
+    value = std::isfinite(value) ? std::clamp(value, 0.0f, 1.0f) : 0.0f;
+    return reference_float_to_unorm8(value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f);
+}
+
+void test_srgb8_decode_matches_scalar() {
+    llc::Image source(256, 1, rhi::Format::RGBA8UnormSrgb, 256 * 4);
+    for (llc::u32 x = 0; x < 256; ++x) {
+        for (llc::usize c = 0; c < 4; ++c) source.row_data(0)[x * 4 + c] = static_cast<llc::byte>(x);
+    }
+
+    auto converted = llc::convert_image(source, rhi::Format::RGBA32Float);
+
+    require(converted.format == rhi::Format::RGBA32Float, "sRGB decode returned the wrong format");
+    const auto *values = reinterpret_cast<const float *>(converted.data());
+    for (llc::u32 x = 0; x < 256; ++x) {
+        const float unorm = static_cast<float>(x) / 255.0f;
+        require(values[x * 4] == reference_srgb_to_linear(unorm), "sRGB decode differs from the scalar formula");
+        require(values[x * 4 + 3] == unorm, "alpha was gamma decoded");
+    }
+}
+
+void test_srgb8_encode_matches_scalar() {
+    // enough rows for several threads, every 64th float of [0, 1] plus values outside it
+    constexpr llc::u32 k_width = 1024;
+    constexpr llc::u32 k_height = 1024;
+    llc::Image source(k_width, k_height, rhi::Format::RGBA32Float, k_width * 4 * sizeof(float));
+    auto *values = reinterpret_cast<float *>(source.data());
+    const llc::usize count = llc::usize{k_width} * k_height * 4;
+    const float specials[] = {
+        -0.0f, -1.0f, 1.5f, 1e30f,
+        std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::denorm_min(),
+    };
+    const llc::u32 one = std::bit_cast<llc::u32>(1.0f);
+    for (llc::usize i = 0; i < count; ++i) {
+        const auto bits = static_cast<llc::u32>(std::min<llc::usize>(i * 64, one));
+        values[i] = i % 97 < std::size(specials) ? specials[i % 97] : std::bit_cast<float>(bits);
+    }
+
+    auto converted = llc::convert_image(source, rhi::Format::RGBA8UnormSrgb);
+
+    require(converted.format == rhi::Format::RGBA8UnormSrgb, "sRGB encode returned the wrong format");
+    for (llc::usize i = 0; i < count; ++i) {
+        const auto expected = i % 4 == 3 ? reference_float_to_unorm8(values[i]) : reference_linear_to_srgb8(values[i]);
+        require(std::to_integer<llc::u8>(converted.data()[i]) == expected, "sRGB encode differs from the scalar formula");
+    }
+}
+
+void test_half_and_unorm16() {
+    const float values[] = {0.5f, -2.0f, 1024.0f, 1.0f, 1.0f / 3.0f, 70000.0f, 0.0f, 0.75f};
+    llc::Image source(2, 1, rhi::Format::RGBA32Float, sizeof(values));
+    std::memcpy(source.data(), values, sizeof(values));
+
+    auto half = llc::convert_image(source, rhi::Format::RGBA16Float);
+    require(half.format == rhi::Format::RGBA16Float && half.row_pitch == 16, "RGBA16Float has the wrong layout");
+    const auto *halves = reinterpret_cast<const llc::f16 *>(half.data());
+    for (llc::usize i = 0; i < std::size(values); ++i) {
+        require(halves[i].bits() == llc::f16(values[i]).bits(), "half conversion differs from llc::f16");
+    }
+
+    auto widened = llc::convert_image(half, rhi::Format::RGBA32Float);
+    const auto *floats = reinterpret_cast<const float *>(widened.data());
+    for (llc::usize i = 0; i < std::size(values); ++i) {
+        require(floats[i] == static_cast<float>(halves[i]), "half widening changed a value");
+    }
+
+    auto unorm = llc::convert_image(source, rhi::Format::RGBA16Unorm);
+    require(unorm.format == rhi::Format::RGBA16Unorm && unorm.row_pitch == 16, "RGBA16Unorm has the wrong layout");
+    const auto *words = reinterpret_cast<const llc::u16 *>(unorm.data());
+    require(words[0] == 32768 && words[1] == 0 && words[2] == 65535 && words[4] == 21845, "unorm16 quantized wrongly");
+
+    // one half channel spread to gray with opaque alpha
+    llc::Image gray(1, 1, rhi::Format::R16Float, 2);
+    *reinterpret_cast<llc::f16 *>(gray.data()) = llc::f16(0.5f);
+    auto expanded = llc::convert_image(gray, rhi::Format::RGBA8Unorm);
+    require(expanded.format == rhi::Format::RGBA8Unorm, "R16Float did not expand to RGBA8");
+    require(channel(expanded, 0, 0, 0) == 128 && channel(expanded, 0, 0, 2) == 128, "gray was not replicated");
+    require(channel(expanded, 0, 0, 3) == 255, "expanded alpha is not opaque");
+
+    require(!llc::convert_image(half, rhi::Format::R16Float), "dropping channels must not convert");
+}
+
+void test_load_image_round_trip() {
+    llc::Image source(3, 2, rhi::Format::RGBA8Unorm, 12);
+    for (llc::usize i = 0; i < source.size_bytes; ++i) {
+        source.data()[i] = static_cast<llc::byte>(i * 37 + 11);
+    }
+    const auto path = std::filesystem::temp_directory_path() / "llc-test-image-round-trip.png";
+    require(llc::write_image_png(path, source), "failed to write the PNG");
+
+    auto loaded = llc::load_image(path);
+    require(loaded.width == 3 && loaded.height == 2, "loaded image has the wrong size");
+    require(loaded.format == rhi::Format::RGBA8Unorm, "8-bit PNG did not decode to RGBA8Unorm");
+    require(loaded.row_pitch % llc::k_image_row_alignment == 0, "loaded rows are not aligned");
+    for (llc::u32 y = 0; y < source.height; ++y) {
+        require(std::memcmp(loaded.row_data(y), source.row_data(y), 12) == 0, "PNG round trip changed pixels");
+    }
+
+    auto srgb = llc::load_image(path, rhi::Format::RGBA8UnormSrgb);
+    require(srgb.format == rhi::Format::RGBA8UnormSrgb, "sRGB was not applied");
+    require(std::memcmp(srgb.row_data(1), source.row_data(1), 12) == 0, "sRGB relabelling changed pixels");
+
+    auto floats = llc::load_image(path, rhi::Format::RGBA32Float);
+    require(floats.format == rhi::Format::RGBA32Float, "PNG did not convert to RGBA32Float");
+    require(*reinterpret_cast<const float *>(floats.row_data(1)) == channel(source, 0, 1, 0) / 255.0f,
+            "PNG converted to float wrongly");
+    std::filesystem::remove(path);
+
+    require(!llc::load_image(path), "a missing file must load empty");
+}
+
+void test_png_pieces_round_trip() {
+    // big enough for several deflate pieces
+    llc::Image source(300, 400, rhi::Format::RGBA16Unorm, 300 * 8);
+    for (llc::u32 y = 0; y < source.height; ++y) {
+        auto *row = reinterpret_cast<llc::u16 *>(source.row_data(y));
+        for (llc::u32 i = 0; i < source.width * 4; ++i) {
+            row[i] = static_cast<llc::u16>((i * 2654435761u) >> (y % 7 == 0 ? 16 : 24)) + static_cast<llc::u16>(y * 31);
+        }
+    }
+
+    const auto png = llc::encode_png(source);
+    auto wide = llc::decode_image(png);
+    require(wide.format == rhi::Format::RGBA16Unorm, "16-bit PNG did not decode to RGBA16Unorm");
+    for (llc::u32 y = 0; y < source.height; ++y) {
+        require(std::memcmp(wide.row_data(y), source.row_data(y), source.width * 8) == 0, "16-bit PNG changed pixels");
+    }
+
+    auto narrow = llc::convert_image(source, rhi::Format::RGBA8Unorm);
+    auto decoded = llc::decode_image(llc::encode_png(narrow));
+    for (llc::u32 y = 0; y < source.height; ++y) {
+        require(std::memcmp(decoded.row_data(y), narrow.row_data(y), source.width * 4) == 0, "8-bit PNG changed pixels");
+    }
+}
+
+void test_srgb_request_quantizes_16_bit_png() {
+    // 16-bit PNGs are sRGB-encoded like 8-bit ones, so asking for sRGB must not encode them again
+    llc::Image source(4, 1, rhi::Format::RGBA16Unorm, 4 * 8);
+    auto *words = reinterpret_cast<llc::u16 *>(source.data());
+    for (llc::u32 i = 0; i < 16; ++i) words[i] = static_cast<llc::u16>(i * 4369);
+    words[0] = 0x8080; // mid grey, 188 if it were encoded again
+
+    const auto srgb = llc::decode_image(llc::encode_png(source), rhi::Format::RGBA8UnormSrgb);
+    require(srgb.format == rhi::Format::RGBA8UnormSrgb, "16-bit PNG asked for as sRGB has the wrong format");
+    const auto quantized = llc::convert_image(source, rhi::Format::RGBA8Unorm);
+    require(std::memcmp(srgb.data(), quantized.data(), 16) == 0, "16-bit PNG asked for as sRGB was encoded again");
+    require(channel(srgb, 0, 0, 0) == 128, "mid grey of a 16-bit PNG changed");
+}
+
+void test_qoi_and_pfm() {
+    llc::Image flat(64, 2, rhi::Format::RGBA8Unorm, 256);
+    std::memset(flat.data(), 7, flat.size_bytes);
+    const auto qoi = llc::encode_qoi(flat);
+    require(qoi.size() > 22 && std::memcmp(qoi.data(), "qoif", 4) == 0, "QOI header is missing");
+    // one RGBA op, then runs of at most 62 pixels
+    require(qoi.size() == 14 + 5 + 3 + 8, "flat QOI is not run-length encoded");
+    require(std::to_integer<int>(qoi.back()) == 1 && std::to_integer<int>(qoi[qoi.size() - 2]) == 0, "QOI end marker is missing");
+
+    const float values[] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f};
+    llc::Image floats(1, 2, rhi::Format::RGBA32Float, 16);
+    std::memcpy(floats.data(), values, sizeof(values));
+    const auto pfm = llc::encode_pfm(floats);
+    const std::string_view header = "PF\n1 2\n-1.0\n";
+    require(pfm.size() == header.size() + 6 * sizeof(float), "PFM has the wrong size");
+    require(std::memcmp(pfm.data(), header.data(), header.size()) == 0, "PFM header is wrong");
+    float rows[6];
+    std::memcpy(rows, pfm.data() + header.size(), sizeof(rows));
+    require(rows[0] == 5.0f && rows[2] == 7.0f && rows[3] == 1.0f && rows[5] == 3.0f, "PFM rows are not bottom up RGB");
+}
+
 } // namespace
 
 int main() {
     test_srgb_to_linear_rgba8();
     test_linear_to_srgb_rgba8();
+    test_srgb8_decode_matches_scalar();
+    test_srgb8_encode_matches_scalar();
+    test_half_and_unorm16();
+    test_load_image_round_trip();
+    test_png_pieces_round_trip();
+    test_srgb_request_quantizes_16_bit_png();
+    test_qoi_and_pfm();
     return 0;
 }
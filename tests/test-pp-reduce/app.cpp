@@ -1,5 +1,7 @@
 #include "app.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iterator>
 #include <vector>
 
@@ -7,9 +9,18 @@
 #include <fmt/core.h>
 
 #include <llc/buffer.h>
+#include <llc/context_group.h>
 #include <llc/image.h>
+#include <llc/memory_tracker.h>
+#include <llc/mip_generator.h>
 #include <llc/pp/reduce.h>
+#include <llc/pp/reduce_cooperative.h>
+#include <llc/pp/reduce_group.h>
+#include <llc/pp/reduce_host.h>
+#include <llc/pp/reduce_stream.h>
+#include <llc/pp/resize.h>
 #include <llc/texture.h>
+#include <llc/view_cache.h>
 
 namespace llc {
 
@@ -24,6 +35,9 @@ constexpr u32 k_texture_width = 512;
 constexpr u32 k_texture_height = 256;
 constexpr f64 k_tolerance = 0.001; // 0.1% relative error
 
+/// Keeps small inputs on the device so the GPU kernels are exercised regardless of size.
+constexpr pp::ReduceDispatch k_device_only{.host_max_count_device_resident = 0};
+
 /// Returns relative error |gpu - cpu| / |cpu|, or absolute error if cpu is near zero.
 f64 relative_error(f64 gpu, f64 cpu) {
     const f64 abs_err = std::abs(gpu - cpu);
@@ -88,7 +102,7 @@ i32 App::run(i32 argc, const char *argv[]) {
     device_desc.requiredFeatures = required_features;
     device_desc.requiredFeatureCount = std::size(required_features);
 
-    auto context = Context::create(ContextDesc{.device = device_desc});
+    auto context = Context::create(ContextDesc{.device = device_desc, .track_memory = true});
     if (!context) {
         fmt::println("Failed to create RHI device.");
         return -1;
@@ -106,8 +120,39 @@ i32 App::run(i32 argc, const char *argv[]) {
             cpu_sum += static_cast<f64>(data[i]);
         }
         auto buffer = create_buffer<f32>(context_, k_buffer_usage, data);
-        auto gpu = pp::reduce_sum<f32>(context_, buffer.get(), k_element_count);
+        auto gpu = pp::reduce_sum<f32>(context_, buffer.get(), k_element_count, k_device_only);
+        auto host = pp::host_reduce_sum<f32>(data);
         check_scalar("f32", static_cast<f64>(gpu), cpu_sum, failures);
+        check_scalar("f32 host", static_cast<f64>(host), cpu_sum, failures);
+
+        // host-resident input below the threshold is reduced on the host, from the threshold on it is uploaded
+        constexpr pp::ReduceDispatch k_upload_whole{.device_min_count_host_resident = k_element_count};
+        constexpr usize k_small_count = 1000;
+        auto span_small = pp::reduce_sum<f32>(context_, std::span<const f32>(data).first(k_small_count), k_upload_whole);
+        auto span_large = pp::reduce_sum<f32>(context_, std::span<const f32>(data), k_upload_whole);
+        check_scalar("f32 span host", static_cast<f64>(span_small), k_small_count * (k_small_count + 1) / 2.0, failures);
+        check_scalar("f32 span upload", static_cast<f64>(span_large), cpu_sum, failures);
+
+        // run twice, so the second call uses a split adapted from measured throughput
+        pp::CooperativeReducer reducer;
+        (void) reducer.reduce_sum<f32>(context_, data);
+        auto cooperative = reducer.reduce_sum<f32>(context_, data);
+        check_scalar("f32 cooperative", static_cast<f64>(cooperative), cpu_sum, failures);
+
+        // small chunks and few partials, so the ring wraps and the partials get folded
+        auto streaming = pp::StreamingReducer<f32>::create(
+            context_, pp::StreamReduceOptions{.chunk_count = k_element_count / 7 + 1, .ring_size = 2, .max_partial_count = 3});
+        std::optional<f32> streamed;
+        if (streaming && streaming->push(std::span<const f32>(data).first(k_element_count / 2)) &&
+            streaming->push(std::span<const f32>(data).subspan(k_element_count / 2))) {
+            streamed = streaming->finish();
+        }
+        check_scalar("f32 streaming", static_cast<f64>(streamed.value_or(0.0f)), cpu_sum, failures);
+
+        // tuning needs timestamp queries; the reduction has to stay correct with whichever launch wins
+        (void) pp::tune_reduce_sum<f32>(context_, usize{1} << 20, TuneOptions{.warmup_count = 1, .repeat_count = 2});
+        auto tuned = pp::reduce_sum<f32>(context_, buffer.get(), k_element_count, k_device_only);
+        check_scalar("f32 tuned", static_cast<f64>(tuned), cpu_sum, failures);
     }
 
     // f16
@@ -119,8 +164,10 @@ i32 App::run(i32 argc, const char *argv[]) {
             cpu_sum += static_cast<f64>(static_cast<f32>(data[i]));
         }
         auto buffer = create_buffer<f16>(context_, k_buffer_usage, data);
-        auto gpu = pp::reduce_sum<f16>(context_, buffer.get(), k_f16_element_count);
+        auto gpu = pp::reduce_sum<f16>(context_, buffer.get(), k_f16_element_count, k_device_only);
+        auto host = pp::host_reduce_sum<f16>(data);
         check_scalar("f16", static_cast<f64>(static_cast<f32>(gpu)), cpu_sum, failures);
+        check_scalar("f16 host", static_cast<f64>(static_cast<f32>(host)), cpu_sum, failures);
     }
 
     // f32x2
@@ -133,8 +180,10 @@ i32 App::run(i32 argc, const char *argv[]) {
             cpu_sum += f64x2(data[i]);
         }
         auto buffer = create_buffer<f32x2>(context_, k_buffer_usage, data);
-        auto gpu = pp::reduce_sum<f32x2>(context_, buffer.get(), k_element_count);
+        auto gpu = pp::reduce_sum<f32x2>(context_, buffer.get(), k_element_count, k_device_only);
+        auto host = pp::host_reduce_sum<f32x2>(data);
         check_vec2("f32x2", f64x2(gpu), cpu_sum, failures);
+        check_vec2("f32x2 host", f64x2(host), cpu_sum, failures);
     }
 
     // f32x3
@@ -147,8 +196,10 @@ i32 App::run(i32 argc, const char *argv[]) {
             cpu_sum += f64x3(data[i]);
         }
         auto buffer = create_buffer<f32x3>(context_, k_buffer_usage, data);
-        auto gpu = pp::reduce_sum<f32x3>(context_, buffer.get(), k_element_count);
+        auto gpu = pp::reduce_sum<f32x3>(context_, buffer.get(), k_element_count, k_device_only);
+        auto host = pp::host_reduce_sum<f32x3>(data);
         check_vec3("f32x3", f64x3(gpu), cpu_sum, failures);
+        check_vec3("f32x3 host", f64x3(host), cpu_sum, failures);
     }
 
     // f32x4
@@ -161,8 +212,10 @@ i32 App::run(i32 argc, const char *argv[]) {
             cpu_sum += f64x4(data[i]);
         }
         auto buffer = create_buffer<f32x4>(context_, k_buffer_usage, data);
-        auto gpu = pp::reduce_sum<f32x4>(context_, buffer.get(), k_element_count);
+        auto gpu = pp::reduce_sum<f32x4>(context_, buffer.get(), k_element_count, k_device_only);
+        auto host = pp::host_reduce_sum<f32x4>(data);
         check_vec4("f32x4", f64x4(gpu), cpu_sum, failures);
+        check_vec4("f32x4 host", f64x4(host), cpu_sum, failures);
     }
 
     // f16x2
@@ -175,8 +228,10 @@ i32 App::run(i32 argc, const char *argv[]) {
             cpu_sum += f64x2(f32x2(data[i]));
         }
         auto buffer = create_buffer<f16x2>(context_, k_buffer_usage, data);
-        auto gpu = pp::reduce_sum<f16x2>(context_, buffer.get(), k_f16_element_count);
+        auto gpu = pp::reduce_sum<f16x2>(context_, buffer.get(), k_f16_element_count, k_device_only);
+        auto host = pp::host_reduce_sum<f16x2>(data);
         check_vec2("f16x2", f64x2(f32x2(gpu)), cpu_sum, failures);
+        check_vec2("f16x2 host", f64x2(f32x2(host)), cpu_sum, failures);
     }
 
     // f16x3
@@ -190,8 +245,10 @@ i32 App::run(i32 argc, const char *argv[]) {
             cpu_sum += f64x3(f32x3(data.back()));
         }
         auto buffer = create_buffer<f16x3>(context_, k_buffer_usage, data);
-        auto gpu = pp::reduce_sum<f16x3>(context_, buffer.get(), k_f16_element_count);
+        auto gpu = pp::reduce_sum<f16x3>(context_, buffer.get(), k_f16_element_count, k_device_only);
+        auto host = pp::host_reduce_sum<f16x3>(data);
         check_vec3("f16x3", f64x3(f32x3(gpu)), cpu_sum, failures);
+        check_vec3("f16x3 host", f64x3(f32x3(host)), cpu_sum, failures);
     }
 
     // f16x4
@@ -204,8 +261,31 @@ i32 App::run(i32 argc, const char *argv[]) {
             cpu_sum += f64x4(f32x4(data[i]));
         }
         auto buffer = create_buffer<f16x4>(context_, k_buffer_usage, data);
-        auto gpu = pp::reduce_sum<f16x4>(context_, buffer.get(), k_f16_element_count);
+        auto gpu = pp::reduce_sum<f16x4>(context_, buffer.get(), k_f16_element_count, k_device_only);
+        auto host = pp::host_reduce_sum<f16x4>(data);
         check_vec4("f16x4", f64x4(f32x4(gpu)), cpu_sum, failures);
+        check_vec4("f16x4 host", f64x4(f32x4(host)), cpu_sum, failures);
+    }
+
+    // a group of two CPU devices splits host-resident input between them: the merged sum matches
+    // the single-device one, before and after the split is weighted by the measured throughput
+    {
+        constexpr u32 k_group_element_count = 1 << 20;
+        std::vector<f32> data(k_group_element_count);
+        for (usize i = 0; i < k_group_element_count; ++i) data[i] = static_cast<f32>(i % 97);
+        const auto single = pp::reduce_sum<f32>(context_, std::span<const f32>(data));
+
+        rhi::DeviceDesc cpu_desc;
+        cpu_desc.deviceType = rhi::DeviceType::CPU;
+        auto group = ContextGroup::create(ContextDesc{.device = cpu_desc}, 2);
+        const bool created = group && group->size() == 2;
+        const auto first = created ? pp::reduce_sum<f32>(*group, std::span<const f32>(data)) : 0.0f;
+        const bool measured = created && group->bytes_per_second(0) > 0.0 && group->bytes_per_second(1) > 0.0;
+        const auto second = created ? pp::reduce_sum<f32>(*group, std::span<const f32>(data)) : 0.0f;
+        const bool ok = created && measured && relative_error(first, single) <= k_tolerance &&
+                        relative_error(second, single) <= k_tolerance;
+        fmt::println("f32 group: single={} group={} weighted={} [{}]", single, first, second, ok ? "PASS" : "FAIL");
+        if (!ok) ++failures;
     }
 
     // texture f32
@@ -223,8 +303,20 @@ i32 App::run(i32 argc, const char *argv[]) {
         }
 
         auto texture = create_texture_2d(context_, image);
-        auto gpu = pp::reduce_texture_sum<f32>(context_, texture.get());
+        auto gpu = pp::reduce_texture_sum<f32>(context_, texture.get(), k_device_only);
+        auto host = pp::host_reduce_image_sum<f32>(image);
         check_scalar("texture f32", static_cast<f64>(gpu), cpu_sum, failures);
+        check_scalar("texture f32 host", static_cast<f64>(host), cpu_sum, failures);
+
+        // the second read lands in the allocation of the first
+        Image readback;
+        const bool first_ok = SLANG_SUCCEEDED(read_texture_into(context_, texture.get(), readback));
+        const auto *pixels = readback.data();
+        const bool ok = first_ok && SLANG_SUCCEEDED(read_texture_into(context_, texture.get(), readback)) &&
+                        readback.data() == pixels &&
+                        pp::host_reduce_image_sum<f32>(readback) == host;
+        fmt::println("texture readback into image: row_pitch={} [{}]", readback.row_pitch, ok ? "PASS" : "FAIL");
+        if (!ok) ++failures;
     }
 
     // texture f32x4
@@ -243,11 +335,323 @@ i32 App::run(i32 argc, const char *argv[]) {
         }
 
         auto texture = create_texture_2d(context_, image);
-        auto gpu = pp::reduce_texture_sum<f32x4>(context_, texture.get());
+        auto gpu = pp::reduce_texture_sum<f32x4>(context_, texture.get(), k_device_only);
+        auto host = pp::host_reduce_image_sum<f32x4>(image);
         check_vec4("texture f32x4", f64x4(gpu), cpu_sum, failures);
+        check_vec4("texture f32x4 host", f64x4(host), cpu_sum, failures);
+
+        // the whole chain in one dispatch; both sides are powers of two, so the last level is the mean
+        auto mipped = create_texture_2d(
+            context_,
+            image,
+            10,
+            rhi::Format::Undefined,
+            rhi::TextureUsage::ShaderResource | rhi::TextureUsage::CopyDestination | rhi::TextureUsage::CopySource);
+        const auto last_mip = mipped ? read_texture_to_image(context_, mipped.get(), 0, 9) : Image{};
+        const auto mean = cpu_sum / static_cast<f64>(k_texture_width * k_texture_height);
+        check_vec4("texture f32x4 mips", last_mip ? f64x4(last_mip.view<f32x4>()[0, 0]) : f64x4(0), mean, failures);
+        mipped = nullptr;
+        mip_generator(context_).clear();
+    }
+
+    // half-float storage: converted on upload, reduced and filtered in f32 like RGBA32Float
+    {
+        Image image(k_texture_width, k_texture_height, rhi::Format::RGBA32Float, k_texture_width * sizeof(f32x4));
+        auto view = image.view<f32x4>();
+        f64x4 cpu_sum = {0, 0, 0, 0};
+        for (u32 y = 0; y < k_texture_height; ++y) {
+            for (u32 x = 0; x < k_texture_width; ++x) {
+                // small integers and halves, which f16 holds exactly
+                const auto base = static_cast<f32>((x + y * 3) % 129);
+                const auto value = f32x4(base, base * 0.5f, -base, 1.0f);
+                view[y, x] = value;
+                cpu_sum += f64x4(value);
+            }
+        }
+
+        const auto usage = rhi::TextureUsage::ShaderResource | rhi::TextureUsage::CopyDestination | rhi::TextureUsage::CopySource;
+        auto texture = create_texture_2d(context_, image, 10, rhi::Format::RGBA16Float, usage);
+        auto gpu = pp::reduce_texture_sum<f32x4>(context_, texture.get(), k_device_only);
+        auto host = pp::reduce_texture_sum<f32x4>(context_, texture.get(), {.host_max_count_device_resident = usize{1} << 20});
+        check_vec4("texture rgba16f", f64x4(gpu), cpu_sum, failures);
+        check_vec4("texture rgba16f host", f64x4(host), cpu_sum, failures);
+
+        const auto last_mip = texture ? convert_image(read_texture_to_image(context_, texture.get(), 0, 9), rhi::Format::RGBA32Float) : Image{};
+        const auto mean = cpu_sum / static_cast<f64>(k_texture_width * k_texture_height);
+        check_vec4("texture rgba16f mips", last_mip ? f64x4(last_mip.view<f32x4>()[0, 0]) : f64x4(0), mean, failures);
+        texture = nullptr;
+        mip_generator(context_).clear();
+    }
+
+    // odd sides take the per-level kernel, whose box weighs each texel by the area covered, so
+    // every level keeps the mean
+    {
+        constexpr u32 k_odd_width = 37;
+        constexpr u32 k_odd_height = 23;
+        Image image(k_odd_width, k_odd_height, rhi::Format::R32Float, k_odd_width * sizeof(f32));
+        auto view = image.view<f32>();
+        f64 cpu_sum = 0;
+        for (u32 y = 0; y < k_odd_height; ++y) {
+            for (u32 x = 0; x < k_odd_width; ++x) {
+                view[y, x] = static_cast<f32>((x * 7 + y * 13) % 31);
+                cpu_sum += view[y, x];
+            }
+        }
+
+        const u32 mip_count = compute_max_mip_count(k_odd_width, k_odd_height);
+        auto mipped = create_texture_2d(
+            context_,
+            image,
+            mip_count,
+            rhi::Format::Undefined,
+            rhi::TextureUsage::ShaderResource | rhi::TextureUsage::CopyDestination | rhi::TextureUsage::CopySource);
+        const auto last_mip = mipped ? read_texture_to_image(context_, mipped.get(), 0, mip_count - 1) : Image{};
+        check_scalar(
+            "texture r32f odd mips",
+            last_mip ? last_mip.view<f32>()[0, 0] : 0.0,
+            cpu_sum / static_cast<f64>(k_odd_width * k_odd_height),
+            failures);
+        mipped = nullptr;
+        mip_generator(context_).clear();
+
+        // the same chain among other textures of one batch, next to an entry that cannot be created
+        const auto readable = rhi::TextureUsage::ShaderResource | rhi::TextureUsage::CopyDestination |
+                              rhi::TextureUsage::CopySource;
+        const TextureUpload uploads[] = {
+            {.image = &image, .mip_count = mip_count, .usage = readable},
+            {.image = &image, .format = rhi::Format::RGBA32Float, .usage = readable},
+            {.image = nullptr},
+        };
+        auto batch = create_textures_2d(context_, uploads);
+        const bool created = batch.size() == 3 && batch[0] && batch[1] && !batch[2];
+        const auto batch_mip = created ? read_texture_to_image(context_, batch[0].get(), 0, mip_count - 1) : Image{};
+        const auto batch_base = created ? read_texture_to_image(context_, batch[1].get()) : Image{};
+        const bool ok = batch_mip && batch_base &&
+                        relative_error(batch_mip.view<f32>()[0, 0], cpu_sum / (k_odd_width * k_odd_height)) <= k_tolerance &&
+                        relative_error(pp::host_reduce_image_sum<f32x4>(batch_base).x, cpu_sum) <= k_tolerance;
+        fmt::println("texture batch upload: count={} [{}]", batch.size(), ok ? "PASS" : "FAIL");
+        if (!ok) ++failures;
+        batch.clear();
+    }
+
+    // a stack of layers, reduced by one dispatch over all of them and read back in one submission
+    {
+        constexpr u32 k_layer_count = 5;
+        std::vector<Image> layers;
+        f64 cpu_sum = 0.0;
+        for (u32 layer = 0; layer < k_layer_count; ++layer) {
+            auto &image = layers.emplace_back(k_texture_width, k_texture_height, rhi::Format::R32Float, k_texture_width * sizeof(f32));
+            auto view = image.view<f32>();
+            for (u32 y = 0; y < k_texture_height; ++y) {
+                for (u32 x = 0; x < k_texture_width; ++x) {
+                    view[y, x] = static_cast<f32>((x + y * 3 + layer * 11) % 101);
+                    cpu_sum += view[y, x];
+                }
+            }
+        }
+
+        const auto usage = rhi::TextureUsage::ShaderResource | rhi::TextureUsage::CopyDestination |
+                           rhi::TextureUsage::CopySource;
+        auto array = create_texture_2d_array(context_, layers, rhi::Format::Undefined, usage);
+        auto volume = create_texture_3d(context_, layers, rhi::Format::Undefined, usage);
+        const auto gpu_array = array ? pp::reduce_texture_sum<f32>(context_, array.get(), k_device_only) : 0.0f;
+        const auto gpu_volume = volume ? pp::reduce_texture_sum<f32>(context_, volume.get(), k_device_only) : 0.0f;
+        check_scalar("texture array f32", static_cast<f64>(gpu_array), cpu_sum, failures);
+        check_scalar("texture 3d f32", static_cast<f64>(gpu_volume), cpu_sum, failures);
+
+        // the readback of the last layer has to match the image it was uploaded from
+        const auto stacked = array ? read_texture_layers_to_image(context_, array.get()) : Image{};
+        const bool ok = stacked && stacked.height == k_texture_height * k_layer_count &&
+                        std::memcmp(
+                            stacked.row_data(k_texture_height * (k_layer_count - 1)),
+                            layers.back().data(),
+                            layers.back().size_bytes) == 0 &&
+                        relative_error(pp::host_reduce_image_sum<f32>(stacked), cpu_sum) <= k_tolerance;
+        fmt::println("texture array readback: height={} [{}]", stacked.height, ok ? "PASS" : "FAIL");
+        if (!ok) ++failures;
+    }
+
+    // resampling: the box keeps the mean at odd factors in both pass layouts, a crop at scale one
+    // copies its texels, an enlarged constant stays constant and leaves the rest of the target alone
+    {
+        constexpr u32 k_odd_width = 37;
+        constexpr u32 k_odd_height = 23;
+        Image image(k_odd_width, k_odd_height, rhi::Format::R32Float, k_odd_width * sizeof(f32));
+        auto view = image.view<f32>();
+        f64 cpu_sum = 0;
+        for (u32 y = 0; y < k_odd_height; ++y) {
+            for (u32 x = 0; x < k_odd_width; ++x) {
+                view[y, x] = static_cast<f32>((x * 7 + y * 13) % 31);
+                cpu_sum += view[y, x];
+            }
+        }
+        const auto usage = rhi::TextureUsage::ShaderResource | rhi::TextureUsage::CopyDestination |
+                           rhi::TextureUsage::CopySource;
+        auto source = create_texture_2d(context_, image, 1, rhi::Format::Undefined, usage);
+
+        const auto resized_mean = [&](pp::ResizePasses passes) {
+            if (!source) return 0.0;
+            auto resized = pp::resize_texture(context_, source.get(), 10, 7, {.filter = pp::ResizeFilter::BOX, .passes = passes});
+            const auto result = resized ? read_texture_to_image(context_, resized.get()) : Image{};
+            return result ? pp::host_reduce_image_sum<f32>(result) / (10.0 * 7.0) : 0.0;
+        };
+        const auto mean = cpu_sum / (k_odd_width * k_odd_height);
+        const auto single = resized_mean(pp::ResizePasses::SINGLE);
+        const auto separable = resized_mean(pp::ResizePasses::SEPARABLE);
+        bool ok = relative_error(single, mean) <= k_tolerance && relative_error(separable, mean) <= k_tolerance;
+        fmt::println("resize box 37x23 -> 10x7: single={:.4f} separable={:.4f} expected={:.4f} [{}]", single, separable, mean, ok ? "PASS" : "FAIL");
+        if (!ok) ++failures;
+
+        // the textures it creates leave no views behind in the cache
+        constexpr pp::TextureRect k_crop{.x = 5, .y = 3, .width = 16, .height = 8};
+        const auto cached_before = view_cache(context_).cached_texture_count();
+        auto cropped = source ? pp::resize_texture(context_, source.get(), k_crop.width, k_crop.height, {.src_rect = k_crop})
+                              : Slang::ComPtr<rhi::ITexture>{};
+        const auto crop = cropped ? read_texture_to_image(context_, cropped.get()) : Image{};
+        ok = crop && view_cache(context_).cached_texture_count() <= cached_before;
+        for (u32 y = 0; ok && y < k_crop.height; ++y) {
+            for (u32 x = 0; x < k_crop.width; ++x) ok = ok && crop.view<f32>()[y, x] == view[k_crop.y + y, k_crop.x + x];
+        }
+        fmt::println("resize bilinear crop 16x8: [{}]", ok ? "PASS" : "FAIL");
+        if (!ok) ++failures;
+
+        Image constant(8, 8, rhi::Format::R32Float, 8 * sizeof(f32));
+        Image blank(64, 64, rhi::Format::R32Float, 64 * sizeof(f32));
+        for (u32 y = 0; y < 8; ++y) {
+            for (u32 x = 0; x < 8; ++x) constant.view<f32>()[y, x] = 0.75f;
+        }
+        for (u32 y = 0; y < 64; ++y) {
+            for (u32 x = 0; x < 64; ++x) blank.view<f32>()[y, x] = 0.0f;
+        }
+        auto small = create_texture_2d(context_, constant, 1, rhi::Format::Undefined, usage);
+        auto target = create_texture_2d(
+            context_, blank, 1, rhi::Format::Undefined, usage | pp::resize_destination_usage(rhi::Format::R32Float));
+        constexpr pp::TextureRect k_region{.x = 16, .y = 24, .width = 16, .height = 16};
+        const bool resized = small && target &&
+                             SLANG_SUCCEEDED(pp::resize_texture(
+                                 context_,
+                                 small.get(),
+                                 target.get(),
+                                 {.filter = pp::ResizeFilter::LANCZOS, .dst_rect = k_region}));
+        const auto enlarged = resized ? read_texture_to_image(context_, target.get()) : Image{};
+        ok = static_cast<bool>(enlarged);
+        for (u32 y = 0; ok && y < 64; ++y) {
+            for (u32 x = 0; x < 64; ++x) {
+                const bool inside = x >= k_region.x && x < k_region.x + k_region.width && y >= k_region.y &&
+                                    y < k_region.y + k_region.height;
+                ok = ok && std::abs(enlarged.view<f32>()[y, x] - (inside ? 0.75f : 0.0f)) <= 1e-5f;
+            }
+        }
+        fmt::println("resize lanczos 8x8 -> 16x16 into region: [{}]", ok ? "PASS" : "FAIL");
+        if (!ok) ++failures;
+    }
+
+    // views and samplers are created once; a texture the caller holds keeps its views through the
+    // collections other misses run, dropping it drops them at the next collection although the
+    // memory tracker references it as well
+    {
+        const auto live_before = memory_snapshot(context_)[MemoryCategory::TEXTURE].live_count;
+        auto texture = create_texture_2d(
+            context_, 64, 64, rhi::Format::RGBA32Float, rhi::TextureUsage::ShaderResource, rhi::ResourceState::ShaderResource);
+        auto &cache = view_cache(context_);
+        auto first = cached_texture_view(context_, texture.get(), 0);
+        auto second = cached_texture_view(context_, texture.get(), 0);
+        auto whole = cached_texture_view(context_, texture.get());
+        const auto sampler = cached_sampler(context_);
+        const bool reused = first && first == second && whole && first == whole &&
+                            sampler && sampler == cached_sampler(context_) && cache.cached_view_count() == 1;
+
+        auto other = create_texture_2d(
+            context_, 32, 32, rhi::Format::RGBA32Float, rhi::TextureUsage::ShaderResource, rhi::ResourceState::ShaderResource);
+        const bool other_cached = other && cached_texture_view(context_, other.get());
+        cache.collect();
+        const bool kept = other_cached && cache.cached_texture_count() == 2 &&
+                          cached_texture_view(context_, texture.get(), 0) == first &&
+                          memory_snapshot(context_)[MemoryCategory::TEXTURE].live_count == live_before + 2;
+
+        texture = nullptr;
+        other = nullptr;
+        first = nullptr;
+        second = nullptr;
+        whole = nullptr;
+        cache.collect();
+        const auto live_after = memory_snapshot(context_)[MemoryCategory::TEXTURE].live_count;
+        const bool ok = reused && kept && cache.cached_texture_count() == 0 && cache.cached_sampler_count() == 1 &&
+                        live_after == live_before;
+        fmt::println("view cache: views={} samplers={} [{}]", cache.cached_view_count(), cache.cached_sampler_count(), ok ? "PASS" : "FAIL");
+        if (!ok) ++failures;
+    }
+
+    // regenerated chains keep their views and the linear storage of sRGB textures through collections
+    // while the texture is held; once it is dropped, the next collection releases both
+    {
+        Image image(64, 64, rhi::Format::RGBA8UnormSrgb, 64 * 4);
+        const auto usage = rhi::TextureUsage::ShaderResource | rhi::TextureUsage::CopyDestination |
+                           mip_generation_usage(rhi::Format::RGBA8UnormSrgb);
+        auto texture = create_texture_2d(context_, image, 7, rhi::Format::Undefined, usage);
+        // after the first generation, so the buffers of the kernel are accounted already
+        const auto before = memory_snapshot(context_);
+        auto &generator = mip_generator(context_);
+        const bool cached = texture && SLANG_SUCCEEDED(generate_mips(context_, texture.get())) &&
+                            generator.cached_texture_count() == 1;
+        generator.collect();
+        const auto held = memory_snapshot(context_);
+        const bool kept = generator.cached_texture_count() == 1 &&
+                          held[MemoryCategory::TEXTURE].live_count == before[MemoryCategory::TEXTURE].live_count &&
+                          held[MemoryCategory::SCRATCH].live_count == before[MemoryCategory::SCRATCH].live_count + 1;
+
+        texture = nullptr;
+        generator.collect();
+        const auto after = memory_snapshot(context_);
+        const bool ok = cached && kept && generator.cached_texture_count() == 0 &&
+                        after[MemoryCategory::TEXTURE].live_count + 1 == before[MemoryCategory::TEXTURE].live_count &&
+                        after[MemoryCategory::SCRATCH].live_count == before[MemoryCategory::SCRATCH].live_count;
+        fmt::println("mip generator collect: [{}]", ok ? "PASS" : "FAIL");
+        if (!ok) ++failures;
+        generator.clear();
+    }
+
+    // every buffer and texture above is out of scope, the scratch of the large reduction was accounted
+    {
+        const auto snapshot = memory_snapshot(context_);
+        const bool ok = snapshot.total.current_bytes == 0 && snapshot.total.live_count == 0 &&
+                        snapshot[MemoryCategory::SCRATCH].peak_bytes >= pp::reduce_sum_scratch_size<f32>(k_element_count) &&
+                        snapshot[MemoryCategory::TEXTURE].peak_bytes > 0;
+        fmt::println(
+            "memory accounting: current={} peak={} [{}]",
+            snapshot.total.current_bytes,
+            snapshot.total.peak_bytes,
+            ok ? "PASS" : "FAIL");
+        if (!ok) ++failures;
+    }
+
+    // buffers dropped one after another are collected by the sweep of later allocations: the peak
+    // stays far below their sum and the current usage drops back once they are gone
+    {
+        constexpr u32 k_buffer_count = 4096;
+        constexpr u64 k_buffer_size = 1024;
+        const auto before = memory_snapshot(context_)[MemoryCategory::BUFFER];
+        bool created = true;
+        u64 during = 0;
+        for (u32 i = 0; i < k_buffer_count; ++i) {
+            auto buffer = create_buffer(context_, k_buffer_size, k_buffer_usage);
+            created = created && buffer;
+            if (i == k_buffer_count / 2) during = memory_snapshot(context_)[MemoryCategory::BUFFER].current_bytes;
+        }
+        const auto after = memory_snapshot(context_)[MemoryCategory::BUFFER];
+        const u64 bound = before.current_bytes + 2 * MemoryTracker::k_collect_slice * k_buffer_size;
+        const bool ok = created && during == before.current_bytes + k_buffer_size &&
+                        after.current_bytes == before.current_bytes && after.live_count == before.live_count &&
+                        after.peak_bytes <= std::max(before.peak_bytes, bound);
+        fmt::println(
+            "memory released incrementally: current={} peak={} [{}]",
+            after.current_bytes,
+            after.peak_bytes,
+            ok ? "PASS" : "FAIL");
+        if (!ok) ++failures;
     }
 
-    constexpr i32 k_test_count = 10;
+    constexpr i32 k_test_count = 43;
     fmt::println("\n{}/{} tests passed", k_test_count - failures, k_test_count);
     return failures > 0 ? 1 : 0;
 }
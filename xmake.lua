@@ -14,6 +14,12 @@ elseif is_os("linux") then
     set_toolchains("clang")
 end
 
+option("avx2")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Build host-side kernels with AVX2 and F16C (x86_64 only)")
+option_end()
+
 add_repositories("loia https://github.com/Locietta/xmake-repo")
 
 add_moduledirs("xmake/modules")